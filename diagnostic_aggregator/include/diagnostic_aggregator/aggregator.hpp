@@ -39,16 +39,29 @@
 #ifndef DIAGNOSTIC_AGGREGATOR__AGGREGATOR_HPP_
 #define DIAGNOSTIC_AGGREGATOR__AGGREGATOR_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "diagnostic_aggregator/analyzer.hpp"
 #include "diagnostic_aggregator/analyzer_group.hpp"
+#include "diagnostic_aggregator/federated_analyzer.hpp"
+#include "diagnostic_aggregator/flight_recorder.hpp"
+#include "diagnostic_aggregator/hardware_index.hpp"
+#include "diagnostic_aggregator/ingest_queue.hpp"
+#include "diagnostic_aggregator/metrics_exporter.hpp"
 #include "diagnostic_aggregator/other_analyzer.hpp"
+#include "diagnostic_aggregator/snapshot_writer.hpp"
+#include "diagnostic_aggregator/status_history.hpp"
 #include "diagnostic_aggregator/status_item.hpp"
+#include "diagnostic_aggregator/subtree_publisher.hpp"
 #include "diagnostic_aggregator/visibility_control.hpp"
 
 #include "diagnostic_msgs/msg/diagnostic_array.hpp"
@@ -56,6 +69,10 @@
 #include "diagnostic_msgs/msg/key_value.hpp"
 #include "diagnostic_msgs/srv/add_diagnostics.hpp"
 
+#include "diagnostic_aggregator_msgs/srv/get_hardware_status.hpp"
+#include "diagnostic_aggregator_msgs/srv/get_history.hpp"
+#include "diagnostic_aggregator_msgs/srv/subscribe_subtree.hpp"
+
 #include "rclcpp/rclcpp.hpp"
 
 namespace diagnostic_aggregator
@@ -91,31 +108,125 @@ analyzers:
   sensors:
     type: GenericAnalyzer
     path: Tilt Hokuyo
+    pub_rate: 10.0
     find_and_remove_prefix: tilt_hokuyo_node
   motors:
     type: PR2MotorsAnalyzer
   joints:
     type: PR2JointsAnalyzer
+flight_recorder:
+  file: /var/log/ros/diagnostics.rec
+snapshot:
+  name: /diagnostics_agg
+metrics:
+  port: 9469
+overload:
+  queue_size: 100000
+history:
+  max_transitions: 128
+hardware_rollup:
+  path: Devices
+  timeout: 5.0
+federation:
+  children: [robot1, robot2]
 \endverbatim
  * Each analyzer is created according to the "type" parameter in its namespace.
  * Any other parameters in the namespace can by used to specify the analyzer. If
  * any analyzer is not properly specified, or returns false on initialization,
  * the aggregator will report the error and publish it in the aggregated output.
+ *
+ * An analyzer or group with a "pub_rate" parameter is reported at that rate
+ * instead of the global "pub_rate". The aggregator then ticks at the highest
+ * rate, and each tick publishes only the subtrees that are due. The toplevel
+ * state is still computed from the whole tree, see AnalyzerGroup::reportDue().
+ *
+ * If "flight_recorder.file" is set, every change of the aggregated output is
+ * recorded to that file, see FlightRecorder.
+ *
+ * If "snapshot.name" is set, the whole tree is exported to the shared memory
+ * of that name after every publication, see SnapshotWriter and SnapshotReader.
+ *
+ * If "metrics.port" is set, the tree and the counters of the aggregator are
+ * served as OpenMetrics text on http://<metrics.address>:<port>/metrics, see
+ * MetricsExporter.
+ *
+ * If "overload.queue_size" is set, the subscription only queues the incoming
+ * arrays, and a thread of the aggregator analyzes them. Under load, the queue
+ * coalesces statuses of the same name and then prioritizes non-OK statuses,
+ * see IngestQueue. Its mode and counters are published on /diagnostics as
+ * "<node name>: Ingest".
+ *
+ * The level transitions of the aggregated output are kept in memory, at most
+ * "history.max_transitions" per status, and can be queried with the
+ * ~/get_history service, see StatusHistory.
+ *
+ * The incoming statuses are indexed by hardware_id. The latest statuses of a
+ * device can be looked up with the ~/get_hardware_status service. If
+ * "hardware_rollup.path" is set, the output contains a status per device
+ * below that path, see HardwareIndex. Statuses that weren't updated
+ * for "hardware_rollup.timeout" seconds count as STALE in it.
+ *
+ * Each name in "federation.children" is a child aggregator, for example one
+ * per robot. Its output on /<name>/diagnostics_agg is reported below
+ * <base_path>/<name> as it is, without being matched again, see
+ * FederatedAnalyzer.
+ *
+ * Clients that only need a subtree can request it on a dedicated topic with
+ * the ~/subscribe_subtree service, see SubtreePublisher. The services and
+ * the subtree topics are below the node name, so that several aggregators
+ * don't collide.
+ *
+ * Recordings can be replayed into an Aggregator in-process: construct it with
+ * a clock whose time is set by the caller, pass the recorded arrays to
+ * diagCallback() and call publishData() at every tick of getPublishPeriod().
+ * Staleness and the publication rates then follow the recorded time, see
+ * replay_diagnostics.cpp.
  */
+
+/*!
+ *\brief Time the Aggregator spent in each phase since enablePhaseTimes().
+ */
+struct PhaseTimes
+{
+  std::chrono::nanoseconds ingest{0};   /**< creating and indexing incoming items */
+  std::chrono::nanoseconds match{0};    /**< matching items and passing them to analyzers */
+  std::chrono::nanoseconds report{0};   /**< reporting the due analyzers */
+  std::chrono::nanoseconds publish{0};  /**< publishing, recording and exporting the output */
+  std::uint64_t arrays = 0;
+  std::uint64_t statuses = 0;
+  std::uint64_t publications = 0;
+};
+
+/*!
+ *\brief Latency of the immediate reports of the critical mode, from the
+ * reception of the degraded status to the publication of the toplevel state.
+ */
+struct CriticalLatency
+{
+  std::uint64_t reports = 0;
+  std::uint64_t late = 0;  /**< reports that took longer than critical_deadline */
+  std::chrono::nanoseconds max{0};
+  std::chrono::nanoseconds total{0};
+};
+
 class Aggregator
 {
 public:
   /*!
    *\brief Constructor initializes with main prefix (ex: '/Robot')
+   *
+   *\param clock : Clock of the incoming items and the analyzers, e.g. a
+   * simulated one to replay recordings. The clock of the node if null, the
+   * analyzers then keep their own.
    */
   DIAGNOSTIC_AGGREGATOR_PUBLIC
-  Aggregator();
+  explicit Aggregator(rclcpp::Clock::SharedPtr clock = nullptr);
 
   DIAGNOSTIC_AGGREGATOR_PUBLIC
   virtual ~Aggregator();
 
   /*!
-   *\brief Processes, publishes data. Should be called at pub_rate.
+   *\brief Processes, publishes the due analyzers. Should be called every scheduler tick.
    */
   DIAGNOSTIC_AGGREGATOR_PUBLIC
   void publishData();
@@ -123,6 +234,36 @@ public:
   DIAGNOSTIC_AGGREGATOR_PUBLIC
   rclcpp::Node::SharedPtr get_node() const;
 
+  /*!
+   *\brief Callback for incoming "/diagnostics", also used to replay recordings
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void diagCallback(const diagnostic_msgs::msg::DiagnosticArray::SharedPtr diag_msg);
+
+  /*!
+   *\brief Period in seconds at which publishData() is due
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  double getPublishPeriod() const {return publish_period_;}
+
+  /*!
+   *\brief Starts or stops measuring the phases, the times are reset when started
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void enablePhaseTimes(bool enable);
+
+  /*!
+   *\brief Time spent in each phase since enablePhaseTimes()
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  PhaseTimes getPhaseTimes();
+
+  /*!
+   *\brief Latency of the immediate reports since construction
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  CriticalLatency getCriticalLatency();
+
 private:
   rclcpp::Node::SharedPtr n_;
 
@@ -131,6 +272,12 @@ private:
 
   /// AddDiagnostics, /diagnostics_agg/add_diagnostics
   rclcpp::Service<diagnostic_msgs::srv::AddDiagnostics>::SharedPtr add_srv_;
+  /// GetHardwareStatus, ~/get_hardware_status
+  rclcpp::Service<diagnostic_aggregator_msgs::srv::GetHardwareStatus>::SharedPtr hardware_srv_;
+  /// GetHistory, ~/get_history
+  rclcpp::Service<diagnostic_aggregator_msgs::srv::GetHistory>::SharedPtr history_srv_;
+  /// SubscribeSubtree, ~/subscribe_subtree
+  rclcpp::Service<diagnostic_aggregator_msgs::srv::SubscribeSubtree>::SharedPtr subtree_srv_;
   /// DiagnosticArray, /diagnostics
   rclcpp::Subscription<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr diag_sub_;
   /// ParameterEvent, /parameter_events
@@ -140,14 +287,19 @@ private:
   /// DiagnosticStatus, /diagnostics_toplevel_state
   rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticStatus>::SharedPtr toplevel_state_pub_;
   std::mutex mutex_;
+  /// Serializes publishDue(), which the ingest thread calls for immediate reports.
+  std::mutex publish_mutex_;
   double pub_rate_;
   int history_depth_;
   rclcpp::Clock::SharedPtr clock_;
+  /// Clock of the incoming items and the analyzers, their own if null.
+  rclcpp::Clock::SharedPtr analyzer_clock_;
 
   /*!
-   *\brief Callback for incoming "/diagnostics"
+   *\brief Processes, publishes the analyzers due at tick_, or all of them if force is set
    */
-  void diagCallback(const diagnostic_msgs::msg::DiagnosticArray::SharedPtr diag_msg);
+  void publishDue(bool force);
+  void createPublishTimer();
 
   std::unique_ptr<AnalyzerGroup> analyzer_group_;
   std::unique_ptr<OtherAnalyzer> other_analyzer_;
@@ -159,6 +311,14 @@ private:
    */
   bool critical_;
 
+  /// Immediate reports taking longer than this many seconds are logged.
+  double critical_deadline_;
+  /// Guarded by mutex_.
+  CriticalLatency critical_latency_;
+
+  /// Last level received for each status name, guarded by mutex_.
+  std::unordered_map<std::string, std::uint8_t> ingest_levels_;
+
   /*!
    *\brief Store the last top level value to publish the critical error only once.
    */
@@ -167,6 +327,133 @@ private:
   /// Records all ROS warnings. No warnings are repeated.
   std::set<std::string> ros_warnings_;
 
+  /// Records the transitions of the aggregated output, if enabled.
+  std::unique_ptr<FlightRecorder> flight_recorder_;
+  std::string flight_recorder_file_;
+  int64_t flight_recorder_segment_size_;
+  int64_t flight_recorder_segment_count_;
+
+  /// Exports the aggregated tree to shared memory, if enabled.
+  std::unique_ptr<SnapshotWriter> snapshot_writer_;
+  std::string snapshot_name_;
+  int64_t snapshot_capacity_;
+
+  /// Serves the aggregated tree as OpenMetrics text, if enabled.
+  std::unique_ptr<MetricsExporter> metrics_exporter_;
+  std::string metrics_address_;
+  int64_t metrics_port_;
+
+  /// Level transitions of the aggregated output, if enabled.
+  std::unique_ptr<StatusHistory> history_;
+  int64_t history_max_transitions_;
+
+  /// Incoming items by hardware_id, guarded by mutex_.
+  HardwareIndex hardware_index_;
+  /// Path of the per-device rollup below base_path_, disabled if empty.
+  std::string hardware_rollup_path_;
+
+  /// Child aggregators by name, guarded by mutex_.
+  std::map<std::string, std::shared_ptr<FederatedAnalyzer>> federated_;
+  /// DiagnosticArray, /<child>/diagnostics_agg
+  std::vector<rclcpp::Subscription<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr>
+  federation_subs_;
+
+  /*!
+   *\brief Callback for the "/<child>/diagnostics_agg" of a child aggregator
+   */
+  void federationCallback(
+    const std::shared_ptr<FederatedAnalyzer> & child,
+    const diagnostic_msgs::msg::DiagnosticArray::SharedPtr msg);
+
+  /// Publishes the subscribed subtrees of the aggregated output.
+  std::unique_ptr<SubtreePublisher> subtree_publisher_;
+
+  /// Period of the scheduler in seconds, the shortest period of the analyzer tree.
+  double publish_period_;
+  /// Scheduler ticks since the analyzers were initialized, guarded by mutex_.
+  uint64_t tick_;
+  /// Period of the other analyzer and the hardware rollup, in ticks.
+  uint64_t other_ticks_;
+  /// Last output of the other analyzer, guarded by mutex_.
+  std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> other_output_;
+  /// Last output of the hardware rollup, guarded by mutex_.
+  std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> hardware_output_;
+
+  /// Time spent in each phase if measure_phases_ is set, guarded by mutex_.
+  bool measure_phases_;
+  PhaseTimes phase_times_;
+
+  /// Queue of the incoming arrays and the thread analyzing them, if enabled.
+  std::unique_ptr<IngestQueue> ingest_queue_;
+  std::thread ingest_thread_;
+  int64_t overload_queue_size_;
+  IngestQueue::Thresholds overload_coalesce_;
+  IngestQueue::Thresholds overload_shed_;
+  /// Statuses dropped by the queue at the last report of the ingest status.
+  std::atomic<uint64_t> overload_dropped_;
+  /// DiagnosticArray, /diagnostics
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr ingest_status_pub_;
+
+  /*!
+   *\brief Analyzes the statuses of the given number of arrays
+   *
+   * The statuses that are not OK or that changed their level are analyzed
+   * first, so that an immediate report doesn't wait for the others. The
+   * other statuses followed by an urgent one of the same name are dropped.
+   *\param received : Time the oldest array was received
+   *\param start : Time the analysis started, for the phase times
+   */
+  void analyzeStatuses(
+    std::vector<const diagnostic_msgs::msg::DiagnosticStatus *> statuses,
+    std::size_t arrays, std::chrono::steady_clock::time_point received,
+    std::chrono::steady_clock::time_point start);
+
+  /*!
+   *\brief Passes the statuses to the analyzers, mutex_ must be locked
+   *
+   *\return True if an immediate report is due
+   */
+  bool analyzeItems(
+    std::vector<const diagnostic_msgs::msg::DiagnosticStatus *>::const_iterator first,
+    std::vector<const diagnostic_msgs::msg::DiagnosticStatus *>::const_iterator last,
+    std::chrono::steady_clock::time_point & start);
+
+  /*!
+   *\brief True if the status is not OK or changed its level, mutex_ must be locked
+   */
+  bool isUrgent(const diagnostic_msgs::msg::DiagnosticStatus & status);
+
+  /*!
+   *\brief Analyzes the arrays of the ingest queue until it is stopped
+   */
+  void ingestLoop();
+
+  /*!
+   *\brief Publishes the mode and the counters of the ingest queue
+   */
+  void publishIngestStatus();
+
+  /*!
+   *\brief Callback for the "~/subscribe_subtree" service
+   */
+  void subscribeSubtree(
+    const std::shared_ptr<diagnostic_aggregator_msgs::srv::SubscribeSubtree::Request> request,
+    std::shared_ptr<diagnostic_aggregator_msgs::srv::SubscribeSubtree::Response> response);
+
+  /*!
+   *\brief Callback for the "~/get_hardware_status" service
+   */
+  void getHardwareStatus(
+    const std::shared_ptr<diagnostic_aggregator_msgs::srv::GetHardwareStatus::Request> request,
+    std::shared_ptr<diagnostic_aggregator_msgs::srv::GetHardwareStatus::Response> response);
+
+  /*!
+   *\brief Callback for the "~/get_history" service
+   */
+  void getHistory(
+    const std::shared_ptr<diagnostic_aggregator_msgs::srv::GetHistory::Request> request,
+    std::shared_ptr<diagnostic_aggregator_msgs::srv::GetHistory::Response> response);
+
   /*
    *!\brief Checks for new parameters to trigger reinitialization of the AnalyzerGroup and OtherAnalyzer
    */
@@ -99,6 +99,15 @@ public:
 
   virtual ~Analyzer() {}
 
+  /*!
+   *\brief Sets the clock that staleness is measured with, before init().
+   *
+   * The aggregator passes its clock if it runs on a simulated clock. The
+   * items it passes to analyze() are then stamped with the same clock.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void setClock(rclcpp::Clock::SharedPtr clock) {clock_ = clock;}
+
   /*!
    *\brief Analyzer is initialized with base path and namespace.
    *
@@ -40,6 +40,7 @@
 #define DIAGNOSTIC_AGGREGATOR__ANALYZER_GROUP_HPP_
 
 #include <algorithm>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -107,6 +108,10 @@ namespace diagnostic_aggregator
  * "Sensors/Tilt Hokuyo" and "Sensors/IMU". The state of any other items, like
  * "Sensors/IMU/Connection" won't matter to the AnalyzerGroup.
  *
+ * Every sub-analyzer can have a "pub_rate" parameter next to its "type". It is
+ * then reported at that rate instead of the rate of its group, see reportDue().
+ * A "pub_rate" of a group is the default rate of the analyzers below it.
+ *
  * The Aggregator uses the AnalyzerGroup internally to load and update analyzers.
  *
  */
@@ -135,6 +140,14 @@ public:
   DIAGNOSTIC_AGGREGATOR_PUBLIC
   virtual bool addAnalyzer(std::shared_ptr<Analyzer> & analyzer);
 
+  /**!
+   *\brief Add an analyzer that is reported at its own rate
+   *
+   *\param pub_rate Publication rate in Hz, 0 to report it at the rate of this group
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool addAnalyzer(std::shared_ptr<Analyzer> & analyzer, double pub_rate);
+
   /**!
    *\brief Remove an analyzer from this analyzerGroup
    */
@@ -166,6 +179,45 @@ public:
   DIAGNOSTIC_AGGREGATOR_PUBLIC
   virtual std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> report();
 
+  /*!
+   *\brief Sets the period of this group and resolves those of the sub-analyzers
+   *
+   * Sub-analyzers without a pub_rate of their own get the period of this group.
+   *\return The shortest period of the tree below this group, in seconds
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  double setPeriod(double period);
+
+  /*!
+   *\brief Rounds the periods of the tree to a number of ticks of the aggregator
+   *
+   * Every period is reported at the nearest multiple of tick, at least every tick.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void setTick(double tick);
+
+  /*!
+   *\brief Reports the sub-analyzers that are due at a tick of the aggregator
+   *
+   * The statuses of the due sub-analyzers, followed by the header of the group,
+   * are appended to due. The other sub-analyzers aren't asked to report, their
+   * last output is kept and still counts for the header. All sub-analyzers are
+   * due at tick 0, or if force is set.
+   *\return True if any sub-analyzer was due
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool reportDue(
+    uint64_t tick, bool force,
+    std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> & due);
+
+  /*!
+   *\brief The whole output of the last report() or reportDue(), cached statuses included
+   */
+  const std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> & getOutput() const
+  {
+    return output_;
+  }
+
   virtual std::string getPath() const {return path_;}
 
   virtual std::string getName() const {return nice_name_;}
@@ -189,6 +241,32 @@ private:
 
   std::vector<std::shared_ptr<Analyzer>> analyzers_;
 
+  /*!
+   *\brief Schedule of the sub-analyzers, in the order of analyzers_
+   *
+   * rates_ holds the configured pub_rate (0 for the period of this group),
+   * periods_ the resolved period in seconds and ticks_ in ticks of the aggregator.
+   * Sub-analyzers that are groups are also in groups_, they schedule their own
+   * sub-analyzers. cached_ holds the last output of every sub-analyzer.
+   */
+  std::vector<double> rates_;
+  std::vector<double> periods_;
+  std::vector<uint64_t> ticks_;
+  std::vector<AnalyzerGroup *> groups_;
+  std::vector<std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>>> cached_;
+  double period_;
+
+  /*!
+   *\brief Output of the group, rebuilt from cached_ after every report
+   */
+  std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> output_;
+
+  /*!
+   *\brief Builds output_ from the cached outputs of the sub-analyzers, adds the header
+   *\return Index of the first status in output_ that the group reports itself
+   */
+  size_t collectOutput();
+
   /*
    *\brief The map of names to matchings is stored internally.
    */
@@ -0,0 +1,256 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__ARCHIVE_FORMAT_HPP_
+#define DIAGNOSTIC_AGGREGATOR__ARCHIVE_FORMAT_HPP_
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/flight_recorder_format.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief On-disk layout of a diagnostics archive.
+ *
+ * The file starts with a FileHeader, followed by blocks and ends with the
+ * index of the blocks and a Footer. Every block is a BlockHeader followed by
+ * the zlib-compressed messages recorded in that block. The encoder state is
+ * reset at the start of every block, so a block can be decoded without
+ * reading any other block.
+\verbatim
+message := varint topic | zigzag stamp delta | zigzag header stamp | varint frame_id
+           | varint status_count | status[status_count]
+status  := varint name | u8 flags | [u8 level] | [varint message] | [varint hardware_id]
+           | [varint value_count | varint key[value_count]] | value[value_count]
+value   := u8 Value_Same | u8 Value_Decimal u8 scale zigzag delta | u8 Value_Text varint text
+\endverbatim
+ * Strings are dictionary-encoded: a reference below the size of its
+ * dictionary is the index of a string seen before in the block, a reference
+ * equal to the size is followed by a new string that is appended to the
+ * dictionary. Names, keys, texts (messages, hardware ids and frame ids) and
+ * values have a dictionary each.
+ *
+ * The fields of a status are encoded against the previous status of the same
+ * name and topic in the block: only the changed fields follow the flags, the
+ * keys are only repeated if they changed, and decimal values are stored as
+ * the difference of their mantissa to the previous value.
+ *
+ * All integers are little endian, varints are the ones of the flight recorder.
+ */
+namespace archive
+{
+constexpr char kFileMagic[8] = {'D', 'I', 'A', 'G', 'A', 'R', 'C', '1'};
+constexpr char kFooterMagic[8] = {'D', 'I', 'A', 'G', 'I', 'D', 'X', '1'};
+constexpr std::uint32_t kBlockMagic = 0x4b4c4244;  // "DBLK"
+constexpr std::uint32_t kVersion = 1;
+
+/*!
+ *\brief Compression of the payload of a block
+ */
+enum Compression : std::uint8_t
+{
+  Compression_None = 0,
+  Compression_Zlib = 1
+};
+
+/*!
+ *\brief Flags of a status, telling which fields follow.
+ */
+enum StatusFlags : std::uint8_t
+{
+  Status_Level = 1 << 0,
+  Status_Message = 1 << 1,
+  Status_HardwareId = 1 << 2,
+  Status_Keys = 1 << 3
+};
+
+/*!
+ *\brief Encodings of a value
+ */
+enum ValueType : std::uint8_t
+{
+  Value_Same = 0,     /**< same as the previous value */
+  Value_Decimal = 1,  /**< u8 scale, zigzag mantissa delta */
+  Value_Text = 2      /**< varint value reference */
+};
+
+/// Text reference of a status that has not been encoded in the block yet
+constexpr std::uint64_t kNoText = std::numeric_limits<std::uint64_t>::max();
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t reserved;
+  std::uint8_t padding[16];
+};
+static_assert(sizeof(FileHeader) == 32, "FileHeader must be 32 bytes");
+
+struct BlockHeader
+{
+  std::uint32_t magic;
+  std::uint8_t compression;
+  std::uint8_t reserved[3];
+  std::uint32_t raw_size;       /**< bytes of the decompressed payload */
+  std::uint32_t stored_size;    /**< bytes of the payload in the file */
+  std::uint32_t message_count;
+  std::uint32_t crc;            /**< crc32 of the stored payload */
+  std::int64_t first_stamp;     /**< stamp of the first message, in ns */
+  std::int64_t last_stamp;      /**< stamp of the last message, in ns */
+  std::uint8_t padding[8];
+};
+static_assert(sizeof(BlockHeader) == 48, "BlockHeader must be 48 bytes");
+
+struct IndexEntry
+{
+  std::uint64_t offset;         /**< of the BlockHeader in the file */
+  std::int64_t first_stamp;
+  std::int64_t last_stamp;
+  std::uint64_t message_count;
+};
+static_assert(sizeof(IndexEntry) == 32, "IndexEntry must be 32 bytes");
+
+struct Footer
+{
+  std::uint64_t index_offset;
+  std::uint64_t block_count;
+  char magic[8];
+  std::uint8_t padding[8];
+};
+static_assert(sizeof(Footer) == 32, "Footer must be 32 bytes");
+
+/*!
+ *\brief Last value of a key, the base of the next delta
+ */
+struct ValueState
+{
+  std::string text;
+  bool decimal = false;
+  std::uint8_t scale = 0;
+  std::int64_t mantissa = 0;
+};
+
+/*!
+ *\brief Last status of a name and topic, kept in sync by writer and reader
+ */
+struct StatusState
+{
+  std::uint8_t level = 0;
+  std::uint64_t message = kNoText;
+  std::uint64_t hardware_id = kNoText;
+  std::vector<std::uint64_t> keys;
+  std::vector<ValueState> values;
+};
+
+inline std::uint64_t zigzag(std::int64_t value)
+{
+  return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t unzigzag(std::uint64_t value)
+{
+  return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+/*!
+ *\brief Splits a decimal like "-12.50" into mantissa -1250 and scale 2.
+ *
+ *\return False if the text isn't a decimal that formatDecimal() reproduces exactly.
+ */
+inline bool parseDecimal(const std::string & text, std::int64_t & mantissa, std::uint8_t & scale)
+{
+  std::size_t pos = 0;
+  bool negative = false;
+  if (pos < text.size() && text[pos] == '-') {
+    negative = true;
+    ++pos;
+  }
+  std::size_t digits = 0;
+  std::size_t integer_digits = 0;
+  bool point = false;
+  std::uint64_t value = 0;
+  scale = 0;
+  for (; pos < text.size(); ++pos) {
+    char c = text[pos];
+    if (c == '.' && !point) {
+      point = true;
+      continue;
+    }
+    if (c < '0' || c > '9' || ++digits > 18) {
+      return false;
+    }
+    value = value * 10 + (c - '0');
+    if (point) {
+      ++scale;
+    } else {
+      // No leading zeros, they would be lost
+      if (integer_digits == 1 && text[pos - 1] == '0') {
+        return false;
+      }
+      ++integer_digits;
+    }
+  }
+  // Needs digits on both sides of a point, and no "-0"
+  if (integer_digits == 0 || (point && scale == 0) || (negative && value == 0)) {
+    return false;
+  }
+  mantissa = negative ? -static_cast<std::int64_t>(value) : static_cast<std::int64_t>(value);
+  return true;
+}
+
+inline std::string formatDecimal(std::int64_t mantissa, std::uint8_t scale)
+{
+  std::uint64_t value = mantissa < 0 ?
+    0 - static_cast<std::uint64_t>(mantissa) : static_cast<std::uint64_t>(mantissa);
+  std::string digits = std::to_string(value);
+  if (digits.size() <= scale) {
+    digits.insert(0, scale + 1 - digits.size(), '0');
+  }
+  if (scale > 0) {
+    digits.insert(digits.size() - scale, 1, '.');
+  }
+  if (mantissa < 0) {
+    digits.insert(0, 1, '-');
+  }
+  return digits;
+}
+
+}  // namespace archive
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__ARCHIVE_FORMAT_HPP_
@@ -0,0 +1,149 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__ARCHIVE_READER_HPP_
+#define DIAGNOSTIC_AGGREGATOR__ARCHIVE_READER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/archive_format.hpp"
+#include "diagnostic_aggregator/flight_recorder_format.hpp"
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief Reads back an archive written by the ArchiveWriter.
+ *
+ * The messages are read in the order they were written. seek() uses the index
+ * of the blocks to jump to a time, so only the block that covers it is
+ * decompressed. An archive that was not closed, e.g. after a crash, has no
+ * index; its blocks are then found by scanning the file.
+ */
+class ArchiveReader
+{
+public:
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  ArchiveReader();
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  ~ArchiveReader();
+
+  /*!
+   *\brief Opens the archive and reads its index.
+   *
+   *\return False if the file doesn't exist or isn't an archive.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool open(const std::string & file);
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void close();
+
+  /*!
+   *\brief Stamps of the first and the last message of the archive.
+   *
+   *\return False if the archive is empty.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool getTimeRange(rclcpp::Time & first, rclcpp::Time & last) const;
+
+  /*!
+   *\brief Number of blocks in the archive
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::size_t getBlockCount() const {return index_.size();}
+
+  /*!
+   *\brief Moves to the first message at or after the given time.
+   *
+   *\return False if there is no such message.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool seek(const rclcpp::Time & stamp);
+
+  /*!
+   *\brief Reads the next message.
+   *
+   *\param topic : Topic the message was received on
+   *\param stamp : Time the message was received
+   *\param msg : The message as it was written
+   *\return False at the end of the archive or if it is corrupt.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool read(std::string & topic, rclcpp::Time & stamp, diagnostic_msgs::msg::DiagnosticArray & msg);
+
+private:
+  bool readIndex(std::uint64_t file_size);
+  bool scanBlocks(std::uint64_t file_size);
+  bool loadBlock(std::size_t block);
+  bool decode(
+    std::string & topic, std::int64_t & stamp, diagnostic_msgs::msg::DiagnosticArray & msg);
+  bool decodeStatus(std::uint64_t topic, diagnostic_msgs::msg::DiagnosticStatus & status);
+  bool getRef(std::vector<std::string> & dictionary, std::uint64_t & id);
+
+  rclcpp::Logger logger_;
+  int fd_;
+  std::vector<archive::IndexEntry> index_;
+
+  /// Current block
+  std::size_t next_block_;
+  std::vector<std::uint8_t> payload_;
+  flight_recorder::RecordCursor cursor_;
+  std::uint32_t remaining_;
+  std::int64_t last_stamp_;
+  std::vector<std::string> topics_;
+  std::vector<std::string> names_;
+  std::vector<std::string> keys_;
+  std::vector<std::string> texts_;
+  std::vector<std::string> values_;
+  /// Last status by topic and name id
+  std::vector<std::vector<archive::StatusState>> states_;
+
+  /// Message found by seek(), returned by the next read()
+  bool pending_;
+  std::string pending_topic_;
+  std::int64_t pending_stamp_;
+  diagnostic_msgs::msg::DiagnosticArray pending_msg_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__ARCHIVE_READER_HPP_
@@ -0,0 +1,140 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__ARCHIVE_WRITER_HPP_
+#define DIAGNOSTIC_AGGREGATOR__ARCHIVE_WRITER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "diagnostic_aggregator/archive_format.hpp"
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief Writes diagnostics messages to a compact archive.
+ *
+ * Messages of several topics, e.g. /diagnostics and /diagnostics_agg, can be
+ * written to the same archive. They are encoded against the previous message
+ * of the same topic, collected into blocks of about block_size bytes, and
+ * every full block is compressed and appended to the file. The index of the
+ * blocks is written by close(), see archive_format.hpp for the layout.
+ *
+ * Messages must be written in the order of their stamps.
+ */
+class ArchiveWriter
+{
+public:
+  /*!
+   *\brief Collects about block_size bytes of encoded messages per block
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  explicit ArchiveWriter(std::size_t block_size = 1024 * 1024);
+
+  /*!
+   *\brief Closes the archive if it is still open
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  ~ArchiveWriter();
+
+  /*!
+   *\brief Creates or truncates the archive file.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool open(const std::string & file);
+
+  /*!
+   *\brief Appends a message.
+   *
+   *\param topic : Topic the message was received on
+   *\param stamp : Time the message was received
+   *\param msg : The message, its header is stored too
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool write(
+    const std::string & topic, const rclcpp::Time & stamp,
+    const diagnostic_msgs::msg::DiagnosticArray & msg);
+
+  /*!
+   *\brief Writes the last block and the index, and closes the file.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool close();
+
+  /*!
+   *\brief Bytes written to the file so far
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::uint64_t getFileSize() const {return offset_;}
+
+private:
+  /// Ids of the strings seen in the current block
+  using Dictionary = std::unordered_map<std::string, std::uint64_t>;
+
+  void encodeStatus(
+    std::uint64_t topic, const diagnostic_msgs::msg::DiagnosticStatus & status);
+  bool flush();
+  bool append(const void * data, std::size_t size);
+
+  rclcpp::Logger logger_;
+  int fd_;
+  std::size_t block_size_;
+  std::uint64_t offset_;
+
+  /// Current block
+  std::string block_;
+  std::uint32_t message_count_;
+  std::int64_t first_stamp_;
+  std::int64_t last_stamp_;
+  Dictionary topics_;
+  Dictionary names_;
+  Dictionary keys_;
+  Dictionary texts_;
+  Dictionary values_;
+  /// Last status by topic and name id
+  std::vector<std::vector<archive::StatusState>> states_;
+
+  std::vector<archive::IndexEntry> index_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__ARCHIVE_WRITER_HPP_
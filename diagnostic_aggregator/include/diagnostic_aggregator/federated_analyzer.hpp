@@ -0,0 +1,173 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__FEDERATED_ANALYZER_HPP_
+#define DIAGNOSTIC_AGGREGATOR__FEDERATED_ANALYZER_HPP_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/analyzer.hpp"
+#include "diagnostic_aggregator/status_item.hpp"
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief FederatedAnalyzer reports the tree of a child aggregator below a prefix
+ *
+ * A parent aggregator, for example at a base station, creates one
+ * FederatedAnalyzer per child aggregator and feeds it the /diagnostics_agg
+ * output of that child with update(). The statuses are already aggregated, so
+ * they are not matched against any analyzer again: every status is stored by
+ * name with the prefix prepended, and reported as is.
+ *
+ * A child that publishes only part of its tree at a time, see the "pub_rate"
+ * of its analyzers, sends deltas: statuses missing from a message keep their
+ * last value. Statuses that the child hasn't sent for "timeout" seconds are
+ * reported stale until they are sent again, so the timeout must be longer
+ * than the longest period of the child. A status that arrives later than
+ * that is logged once. If nothing at all is received for "timeout" seconds,
+ * the whole tree and the header of the child are stale.
+ *
+ * The header, named after the prefix, has the level of the toplevel statuses
+ * of the child, the ones directly below its root.
+ *
+ * FederatedAnalyzer is not loaded as a plugin, it is created by the Aggregator
+ * for each entry of "federation.children". It is not thread safe, the
+ * Aggregator guards it with its mutex.
+ */
+class FederatedAnalyzer : public Analyzer
+{
+public:
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  FederatedAnalyzer();
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  virtual ~FederatedAnalyzer();
+
+  /*!
+   *\brief Initialized with the base path and the name of the child aggregator
+   *
+   *\param base_path Base path of the Aggregator
+   *\param name Name of the child, its tree is reported below base_path/name
+   *\param timeout Seconds after which a child or a status of it is out of date
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool init(const std::string & base_path, const std::string & name, double timeout);
+
+  /*!
+   *\brief FederatedAnalyzer cannot be initialized with a node
+   *
+   *\return False, since it can't be used as a plugin
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool init(
+    const std::string & base_path, const std::string & breadcrumb,
+    const rclcpp::Node::SharedPtr node);
+
+  /*!
+   *\brief Stores the statuses of an output of the child aggregator
+   *
+   *\return The highest level in the message
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  uint8_t update(const diagnostic_msgs::msg::DiagnosticArray & msg);
+
+  /*!
+   *\brief Stores the statuses of an output of the child aggregator received at now
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  uint8_t update(const diagnostic_msgs::msg::DiagnosticArray & msg, const rclcpp::Time & now);
+
+  /*!
+   *\brief Never matches, the incoming items of the parent don't belong to a child
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool match(const std::string & name);
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool analyze(const std::shared_ptr<StatusItem> item);
+
+  /*!
+   *\brief Reports the stored tree of the child and its header
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> report();
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::string getPath() const {return path_;}
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::string getName() const {return nice_name_;}
+
+  /*!
+   *\brief Number of stored statuses of the child
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  size_t getStatusCount() const {return statuses_.size();}
+
+private:
+  struct Entry
+  {
+    std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus> status;
+    /// Copy of status reported once it is out of date, null until then
+    std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus> stale;
+    rclcpp::Time last_update;
+    bool toplevel;
+  };
+
+  std::string path_;
+  std::string nice_name_;
+  rclcpp::Duration timeout_;
+
+  /// Statuses by their name in the child tree
+  std::map<std::string, Entry> statuses_;
+  rclcpp::Time last_update_;
+  bool received_;
+  /// True once a status arrived later than the timeout
+  bool warned_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__FEDERATED_ANALYZER_HPP_
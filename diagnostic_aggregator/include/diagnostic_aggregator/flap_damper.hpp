@@ -0,0 +1,100 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__FLAP_DAMPER_HPP_
+#define DIAGNOSTIC_AGGREGATOR__FLAP_DAMPER_HPP_
+
+#include <cstdint>
+#include <deque>
+
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief Damps the level changes of a status.
+ *
+ * A higher level is reported at once. A lower level is only reported once
+ * the status has kept it for the dwell time. Each change of the received
+ * level is a flap. Once a window holds max_flaps flaps, the status is
+ * flapping: its highest level is reported until a window without flaps.
+ */
+class FlapDamper
+{
+public:
+  /*!
+   *\param dwell Seconds a lower level must last before it is reported
+   *\param window Length of the window of the flap count in seconds
+   *\param max_flaps Flaps in the window from which the status is flapping, never if 0
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  FlapDamper(double dwell, double window, int max_flaps);
+
+  /*!
+   *\brief Returns the level to report for the level received at stamp
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::uint8_t update(const rclcpp::Time & stamp, std::uint8_t level);
+
+  /*!
+   *\brief Number of flaps in the window
+   */
+  std::size_t getFlapCount() const {return flaps_.size();}
+
+  /*!
+   *\brief Number of flaps since the first update
+   */
+  std::uint64_t getTotalFlaps() const {return total_flaps_;}
+
+  bool isFlapping() const {return flapping_;}
+
+private:
+  std::int64_t dwell_;
+  std::int64_t window_;
+  std::size_t max_flaps_;
+
+  bool initialized_;
+  bool flapping_;
+  std::uint8_t received_;   /**< Last level received */
+  std::uint8_t reported_;   /**< Last level reported */
+  std::int64_t changed_;    /**< Time the received level last changed */
+  std::deque<std::int64_t> flaps_;
+  std::uint64_t total_flaps_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__FLAP_DAMPER_HPP_
@@ -0,0 +1,120 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__FLIGHT_RECORD_READER_HPP_
+#define DIAGNOSTIC_AGGREGATOR__FLIGHT_RECORD_READER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/flight_recorder_format.hpp"
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief Reads back a ring file written by the FlightRecorder.
+ *
+ * The tree at a given time is rebuilt from the keyframe of the segment that
+ * covers that time plus the transitions recorded after it, so at most one
+ * segment is decoded per query. The file may be read while the aggregator is
+ * still recording into it.
+ */
+class FlightRecordReader
+{
+public:
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  FlightRecordReader();
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  ~FlightRecordReader();
+
+  /*!
+   *\brief Maps the ring file read-only.
+   *
+   *\return False if the file doesn't exist or isn't a flight record.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool open(const std::string & file);
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void close();
+
+  /*!
+   *\brief Oldest and newest time that can be rebuilt from the file.
+   *
+   *\return False if nothing has been recorded yet.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool getTimeRange(rclcpp::Time & first, rclcpp::Time & last) const;
+
+  /*!
+   *\brief Rebuilds the aggregated tree as it was published at the given time.
+   *
+   *\param stamp : Time of interest, must be within getTimeRange()
+   *\param tree : Filled with the statuses that were reported at that time
+   *\return False if the time isn't covered by the file anymore.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool getTreeAt(const rclcpp::Time & stamp, diagnostic_msgs::msg::DiagnosticArray & tree) const;
+
+private:
+  struct Segment
+  {
+    std::uint64_t index;
+    flight_recorder::SegmentHeader header;
+  };
+
+  std::vector<Segment> getSegments() const;
+  const flight_recorder::SegmentHeader * segmentHeader(std::uint64_t index) const;
+  bool decode(
+    const std::vector<std::uint8_t> & payload, std::int64_t stamp,
+    diagnostic_msgs::msg::DiagnosticArray & tree) const;
+
+  rclcpp::Logger logger_;
+  int fd_;
+  const std::uint8_t * data_;
+  std::uint64_t file_size_;
+  std::uint64_t segment_size_;
+  std::uint64_t segment_count_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__FLIGHT_RECORD_READER_HPP_
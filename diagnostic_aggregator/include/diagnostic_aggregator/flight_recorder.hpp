@@ -0,0 +1,185 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__FLIGHT_RECORDER_HPP_
+#define DIAGNOSTIC_AGGREGATOR__FLIGHT_RECORDER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "diagnostic_aggregator/flight_recorder_format.hpp"
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+#include "diagnostic_msgs/msg/key_value.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief Records every transition of the aggregated tree into a ring file.
+ *
+ * The FlightRecorder is owned by the Aggregator and fed with every array
+ * published on /diagnostics_agg. record() only queues the array, the
+ * comparison with the previous tree and the encoding are done by a writer
+ * thread, so the publishing path is never blocked by disk I/O.
+ *
+ * The ring file is memory-mapped and has a fixed size of
+ * segment_count * segment_size bytes. When a segment is full, the oldest
+ * segment is overwritten and starts with a keyframe of the complete tree.
+ * See FlightRecordReader for reading the file back.
+ *
+ * Configured via the aggregator parameters:
+\verbatim
+flight_recorder:
+  file: /var/log/ros/diagnostics.rec  # Recording is disabled if empty
+  segment_size: 4194304
+  segment_count: 16
+\endverbatim
+ */
+class FlightRecorder
+{
+public:
+  /*!
+   *\brief Opens (or creates) the ring file and starts the writer thread.
+   *
+   * An existing file with the same geometry is continued after its newest
+   * segment, otherwise it is reinitialized.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  FlightRecorder(
+    const std::string & file, std::uint64_t segment_size = 4 * 1024 * 1024,
+    std::uint64_t segment_count = 16);
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  ~FlightRecorder();
+
+  /*!
+   *\brief True if the file could be mapped and the recorder is running
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool isOpen() const {return open_;}
+
+  /*!
+   *\brief Queues an aggregated tree. Never blocks on the writer thread.
+   *
+   * The tree is dropped if the queue is full, see getDroppedCount().
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void record(std::shared_ptr<const diagnostic_msgs::msg::DiagnosticArray> tree);
+
+  /*!
+   *\brief Blocks until all queued trees have been written.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void flush();
+
+  /*!
+   *\brief Number of trees dropped because the writer couldn't keep up
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::uint64_t getDroppedCount() const {return dropped_;}
+
+private:
+  /*!
+   *\brief Last written state of one status, used to compute the transitions.
+   */
+  struct Entry
+  {
+    std::string name;
+    diagnostic_msgs::msg::DiagnosticStatus status;
+    bool present = false;
+    bool seen = false;
+  };
+
+  bool open(const std::string & file);
+  void close();
+  void run();
+  void process(const diagnostic_msgs::msg::DiagnosticArray & tree);
+
+  std::uint32_t getId(const std::string & name);
+  static void encodeName(std::string & out, std::uint32_t id, const std::string & name);
+  static void encodeStatus(
+    std::string & out, std::uint32_t id, std::int64_t stamp,
+    const diagnostic_msgs::msg::DiagnosticStatus & status,
+    const diagnostic_msgs::msg::DiagnosticStatus * previous);
+  static std::size_t beginRecord(std::string & out, flight_recorder::RecordType type);
+  static void endRecord(std::string & out, std::size_t start);
+
+  bool append(const std::string & records, std::int64_t stamp);
+  void encodeKeyframe(std::string & out, std::int64_t stamp) const;
+  bool startSegment(std::uint64_t index, std::int64_t stamp);
+  flight_recorder::SegmentHeader * segmentHeader(std::uint64_t index);
+
+  rclcpp::Logger logger_;
+  std::uint64_t segment_size_;
+  std::uint64_t segment_count_;
+
+  int fd_;
+  std::uint8_t * data_;
+  std::atomic<bool> open_;
+  std::uint64_t file_size_;
+  std::uint64_t segment_;
+  std::uint64_t sequence_;
+  bool segment_open_;  /**< False until the first keyframe of this run is written */
+
+  std::unordered_map<std::string, std::uint32_t> ids_;
+  std::vector<Entry> entries_;
+  std::string pending_;  /**< Records of the tree being processed */
+  std::string keyframe_;
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cv_;
+  std::condition_variable idle_cv_;
+  std::deque<std::shared_ptr<const diagnostic_msgs::msg::DiagnosticArray>> queue_;
+  std::size_t max_queue_;
+  bool busy_;
+  bool running_;
+  std::atomic<std::uint64_t> dropped_;
+  std::thread thread_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__FLIGHT_RECORDER_HPP_
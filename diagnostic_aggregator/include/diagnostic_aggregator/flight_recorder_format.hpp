@@ -0,0 +1,209 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__FLIGHT_RECORDER_FORMAT_HPP_
+#define DIAGNOSTIC_AGGREGATOR__FLIGHT_RECORDER_FORMAT_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief On-disk layout of the flight recorder ring file.
+ *
+ * The file starts with a FileHeader, followed by segment_count segments of
+ * segment_size bytes each. Every segment starts with a SegmentHeader and a
+ * keyframe, i.e. the complete tree at the time the segment was opened, followed
+ * by the transitions recorded afterwards. A segment can therefore be decoded
+ * without reading any other segment.
+\verbatim
+record := u32 size | u8 type | payload[size - 1]
+\endverbatim
+ * All integers are little endian, strings are a varint length followed by the bytes.
+ */
+namespace flight_recorder
+{
+constexpr char kFileMagic[8] = {'D', 'I', 'A', 'G', 'R', 'E', 'C', '1'};
+constexpr std::uint32_t kSegmentMagic = 0x47455344;  // "DSEG"
+constexpr std::uint32_t kVersion = 1;
+
+/*!
+ *\brief Record types stored in a segment payload
+ */
+enum RecordType : std::uint8_t
+{
+  Record_Name = 1,           /**< varint id, string name */
+  Record_KeyframeBegin = 2,  /**< i64 stamp */
+  Record_Status = 3,         /**< varint id, i64 stamp, u8 level, u8 flags, ... */
+  Record_Remove = 4,         /**< varint id, i64 stamp */
+  Record_KeyframeEnd = 5     /**< i64 stamp */
+};
+
+/*!
+ *\brief Flags of a Record_Status record, telling which fields follow.
+ */
+enum StatusFlags : std::uint8_t
+{
+  Status_Message = 1 << 0,
+  Status_HardwareId = 1 << 1
+};
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t reserved;
+  std::uint64_t segment_size;
+  std::uint64_t segment_count;
+  std::uint8_t padding[32];
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader must be 64 bytes");
+
+struct SegmentHeader
+{
+  std::uint32_t magic;
+  std::uint32_t reserved;
+  std::uint64_t sequence;     /**< 0 while the segment is being (re)written */
+  std::int64_t first_stamp;   /**< stamp of the keyframe, in ns */
+  std::int64_t last_stamp;    /**< stamp of the last committed record, in ns */
+  std::uint64_t used;         /**< committed payload bytes after the header */
+  std::uint8_t padding[24];
+};
+static_assert(sizeof(SegmentHeader) == 64, "SegmentHeader must be 64 bytes");
+
+inline void putVarint(std::string & out, std::uint64_t value)
+{
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+inline void putFixed64(std::string & out, std::int64_t value)
+{
+  std::uint64_t v = static_cast<std::uint64_t>(value);
+  for (int i = 0; i < 8; ++i) {
+    out.push_back(static_cast<char>(v & 0xff));
+    v >>= 8;
+  }
+}
+
+inline void putString(std::string & out, const std::string & value)
+{
+  putVarint(out, value.size());
+  out.append(value);
+}
+
+/*!
+ *\brief Bounds-checked cursor over an encoded record. Every getter returns false
+ * once the input is exhausted, so truncated records are detected.
+ */
+class RecordCursor
+{
+public:
+  RecordCursor(const std::uint8_t * data, std::size_t size)
+  : pos_(data), end_(data + size) {}
+
+  bool getByte(std::uint8_t & value)
+  {
+    if (pos_ >= end_) {
+      return false;
+    }
+    value = *pos_++;
+    return true;
+  }
+
+  bool getVarint(std::uint64_t & value)
+  {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      std::uint8_t byte;
+      if (!getByte(byte)) {
+        return false;
+      }
+      value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool getFixed64(std::int64_t & value)
+  {
+    if (end_ - pos_ < 8) {
+      return false;
+    }
+    std::uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) {
+      v = (v << 8) | pos_[i];
+    }
+    pos_ += 8;
+    value = static_cast<std::int64_t>(v);
+    return true;
+  }
+
+  bool getString(std::string & value)
+  {
+    std::uint64_t size;
+    if (!getVarint(size) || static_cast<std::uint64_t>(end_ - pos_) < size) {
+      return false;
+    }
+    value.assign(reinterpret_cast<const char *>(pos_), size);
+    pos_ += size;
+    return true;
+  }
+
+  bool skipString()
+  {
+    std::uint64_t size;
+    if (!getVarint(size) || static_cast<std::uint64_t>(end_ - pos_) < size) {
+      return false;
+    }
+    pos_ += size;
+    return true;
+  }
+
+private:
+  const std::uint8_t * pos_;
+  const std::uint8_t * end_;
+};
+
+}  // namespace flight_recorder
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__FLIGHT_RECORDER_FORMAT_HPP_
@@ -141,6 +141,18 @@ inline bool getParamVals(rclcpp::Parameter param, std::vector<std::string> & out
  * The GenericAnalyzer can discard stale items. Use the "discard_stale" parameter to
  * remove any items that haven't updated within the timeout. This is "false" by default.
  *
+ * Statistics of numeric values can be added to the output with the "statistics_window"
+ * parameter, in seconds. For every numeric value, the minimum, maximum, mean and 95th
+ * percentile of its updates within the window are appended as "<key> (min)", "<key> (max)",
+ * "<key> (mean)" and "<key> (p95)". Use "statistics_keys" to restrict this to some keys.
+ * Disabled by default.
+ *
+ * Flapping items can be damped with "flap_dwell" and "flap_max", see FlapDamper. A lower
+ * level is only reported once it lasted "flap_dwell" seconds, and the highest level is held
+ * while an item changed its level "flap_max" times within "flap_window" seconds (default
+ * 10.0). The flaps in the window and in total are appended as "Flaps" and "Flaps (total)".
+ * Disabled by default.
+ *
  * Example configurations:
  *\verbatim
  * hokuyo:
@@ -76,6 +76,10 @@ public:
     path_(""),
     timeout_(-1.0),
     num_items_expected_(-1),
+    statistics_window_(0.0),
+    flap_dwell_(0.0),
+    flap_window_(10.0),
+    flap_max_(0),
     discard_stale_(false),
     has_initialized_(false),
     has_warned_(false)
@@ -148,6 +152,14 @@ public:
       return false;
     }
 
+    if (statistics_window_ > 0 || flap_dwell_ > 0 || flap_max_ > 0) {
+      auto previous = items_.find(item->getName());
+      const StatusItem * previous_item =
+        previous != items_.end() ? previous->second.get() : nullptr;
+      item->trackStatistics(statistics_window_, statistics_keys_, previous_item);
+      item->dampFlaps(flap_dwell_, flap_window_, flap_max_, previous_item);
+    }
+
     items_[item->getName()] = item;
 
     return has_initialized_;
@@ -214,6 +226,12 @@ public:
       all_stale = all_stale && ((level == diagnostic_msgs::msg::DiagnosticStatus::STALE) || stale);
 
       processed.push_back(item->toStatusMsg(path_, stale));
+      if (statistics_window_ > 0) {
+        addStatistics(*item, *processed.back());
+      }
+      if (item->getFlapDamper()) {
+        addFlaps(*item->getFlapDamper(), *processed.back());
+      }
 
       if (stale) {
         header_status->level = diagnostic_msgs::msg::DiagnosticStatus::STALE;
@@ -289,6 +307,16 @@ protected:
   double timeout_;
   int num_items_expected_;
 
+  /// Window of the statistics of numeric values in seconds, disabled if 0
+  double statistics_window_;
+  /// Keys to take statistics of, all numeric values if empty
+  std::vector<std::string> statistics_keys_;
+
+  /// Flap damping of the items, see FlapDamper. Disabled if dwell and max are 0
+  double flap_dwell_;
+  double flap_window_;
+  int flap_max_;
+
   /*!
    *\brief Subclasses can add items to analyze
    */
@@ -297,7 +325,61 @@ protected:
     items_[name] = item;
   }
 
+  /*!
+   *\brief Returns true if an item of this name is analyzed, and wasn't discarded
+   */
+  bool hasItem(const std::string & name) const
+  {
+    return items_.find(name) != items_.end();
+  }
+
 private:
+  /*!
+   *\brief Appends the window statistics of item as "<key> (min)" etc. to status
+   */
+  void addStatistics(const StatusItem & item, diagnostic_msgs::msg::DiagnosticStatus & status)
+  {
+    const std::size_t num_values = status.values.size();
+    for (std::size_t i = 0; i < num_values; ++i) {
+      const WindowStatistics * statistics = item.getStatistics(status.values[i].key);
+      if (!statistics || statistics->count() == 0) {
+        continue;
+      }
+
+      const std::string key = status.values[i].key;
+      diagnostic_msgs::msg::KeyValue kv;
+      kv.key = key + " (min)";
+      kv.value = std::to_string(statistics->min());
+      status.values.push_back(kv);
+      kv.key = key + " (max)";
+      kv.value = std::to_string(statistics->max());
+      status.values.push_back(kv);
+      kv.key = key + " (mean)";
+      kv.value = std::to_string(statistics->mean());
+      status.values.push_back(kv);
+      kv.key = key + " (p95)";
+      kv.value = std::to_string(statistics->percentile(0.95));
+      status.values.push_back(kv);
+    }
+  }
+
+  /*!
+   *\brief Appends the flap counts of damper as "Flaps" and "Flaps (total)" to status
+   */
+  void addFlaps(const FlapDamper & damper, diagnostic_msgs::msg::DiagnosticStatus & status)
+  {
+    diagnostic_msgs::msg::KeyValue kv;
+    kv.key = "Flaps";
+    kv.value = std::to_string(damper.getFlapCount());
+    status.values.push_back(kv);
+    kv.key = "Flaps (total)";
+    kv.value = std::to_string(damper.getTotalFlaps());
+    status.values.push_back(kv);
+    if (damper.isFlapping()) {
+      status.message += " (flapping)";
+    }
+  }
+
   /*!
    *\brief Stores items by name. State of analyzer
    */
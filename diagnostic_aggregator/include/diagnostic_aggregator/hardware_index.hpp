@@ -0,0 +1,152 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__HARDWARE_INDEX_HPP_
+#define DIAGNOSTIC_AGGREGATOR__HARDWARE_INDEX_HPP_
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "diagnostic_aggregator/status_item.hpp"
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief Index of the incoming items by hardware_id, with per-device rollup.
+ *
+ * The Aggregator updates the index with every incoming item, before and
+ * independent of the analyzers, so it covers the items of all analyzers.
+ * Every device keeps its latest items and the number of items per level,
+ * which are adjusted when an item changes its level or hardware_id. Items
+ * without hardware_id are not indexed.
+ *
+ * With a timeout, expire() counts the items that weren't updated within it
+ * as STALE until they are updated again. Like in the analyzers, a device is
+ * STALE if all its items are, and ERROR if only some are.
+ *
+ * Lookups are proportional to the items of one device, the rollup is
+ * proportional to the number of devices, expiry to the number of expired
+ * items. None scans all items.
+ *
+ * The index is not thread safe, the Aggregator guards it with its mutex.
+ */
+class HardwareIndex
+{
+public:
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  HardwareIndex();
+
+  /*!
+   *\brief Adds or updates an incoming item
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void update(const std::shared_ptr<StatusItem> item);
+
+  /*!
+   *\brief Sets the seconds after which an item that isn't updated is STALE, 0 for never
+   */
+  void setTimeout(double timeout) {timeout_ = timeout;}
+
+  /*!
+   *\brief Counts the items not updated within the timeout before now as STALE
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void expire(const rclcpp::Time & now);
+
+  /*!
+   *\brief Latest items of a device, ordered by name. Empty if unknown.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::vector<std::shared_ptr<StatusItem>> lookup(const std::string & hardware_id) const;
+
+  /*!
+   *\brief Rollup of all devices below path
+   *
+   * Returns a header status named path, and a status per device named
+   * path/hardware_id with the highest level of its items and the number of
+   * items per level as values.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> report(
+    const std::string & path) const;
+
+  /*!
+   *\brief Number of known devices
+   */
+  std::size_t getDeviceCount() const {return devices_.size();}
+
+private:
+  struct Device
+  {
+    std::map<std::string, std::shared_ptr<StatusItem>> items;
+    std::array<std::uint32_t, 4> level_counts{};  /**< Indexed by DiagnosticLevel */
+
+    DiagnosticLevel getLevel() const;
+  };
+
+  /*!
+   *\brief Where an item is counted
+   */
+  struct Indexed
+  {
+    std::string hardware_id;
+    DiagnosticLevel level;  /**< Level_Stale once expired */
+    std::int64_t updated;  /**< Nanoseconds */
+  };
+
+  void remove(const std::string & name, const Indexed & indexed);
+
+  std::map<std::string, Device> devices_;
+  /// Indexed items by name
+  std::unordered_map<std::string, Indexed> items_;
+  /// Update time and name of the items that didn't expire yet, oldest first
+  std::set<std::pair<std::int64_t, std::string>> updates_;
+  double timeout_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__HARDWARE_INDEX_HPP_
@@ -0,0 +1,188 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__INGEST_QUEUE_HPP_
+#define DIAGNOSTIC_AGGREGATOR__INGEST_QUEUE_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief Queue between the /diagnostics subscription and the analyzers.
+ *
+ * The subscription only pushes the received arrays, a thread of the
+ * Aggregator pops them in batches and analyzes them. How a batch is built
+ * depends on the load of the queue, measured as the number of queued statuses
+ * (depth) and the age of the oldest queued array (lag):
+ * - Mode_Normal: every status is analyzed in arrival order.
+ * - Mode_Coalesce: only the latest status of every name is analyzed.
+ * - Mode_Shed: like Mode_Coalesce, and the non-OK statuses are analyzed
+ *   first. The KeyValues of OK statuses are dropped, so they aren't copied.
+ *
+ * The mode goes up as soon as the depth or the lag reaches the thresholds of
+ * a mode, and back down once both are below half of the thresholds of the
+ * current mode. If the depth exceeds the capacity, the oldest arrays are
+ * dropped.
+ *
+ * Configured via the aggregator parameters:
+\verbatim
+overload:
+  queue_size: 100000  # Capacity in statuses, the queue is disabled if 0
+  coalesce_depth: 1000
+  coalesce_lag: 0.5
+  shed_depth: 10000
+  shed_lag: 2.0
+\endverbatim
+ */
+class IngestQueue
+{
+public:
+  enum Mode
+  {
+    Mode_Normal = 0,
+    Mode_Coalesce = 1,
+    Mode_Shed = 2
+  };
+
+  /*!
+   *\brief Depth in statuses and lag in seconds at which a mode starts
+   */
+  struct Thresholds
+  {
+    std::size_t depth;
+    double lag;
+  };
+
+  /*!
+   *\brief Statuses to analyze, in order
+   */
+  struct Batch
+  {
+    Mode mode = Mode_Normal;
+    /// Time the oldest array was received
+    std::chrono::steady_clock::time_point received;
+    /// Own the statuses
+    std::vector<diagnostic_msgs::msg::DiagnosticArray::SharedPtr> arrays;
+    std::vector<const diagnostic_msgs::msg::DiagnosticStatus *> statuses;
+  };
+
+  /*!
+   *\brief Counters since construction and the current load
+   */
+  struct Statistics
+  {
+    Mode mode = Mode_Normal;
+    std::size_t depth = 0;
+    double lag = 0.0;
+    std::uint64_t received = 0;    /**< statuses pushed */
+    std::uint64_t coalesced = 0;   /**< statuses skipped for a newer one of the same name */
+    std::uint64_t stripped = 0;    /**< OK statuses analyzed without KeyValues */
+    std::uint64_t dropped = 0;     /**< statuses dropped at capacity */
+  };
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  IngestQueue(std::size_t capacity, const Thresholds & coalesce, const Thresholds & shed);
+
+  /*!
+   *\brief Queues a received array
+   *
+   *\param received : Time the array was received, the lag is measured from it
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void push(
+    const diagnostic_msgs::msg::DiagnosticArray::SharedPtr & msg,
+    std::chrono::steady_clock::time_point received = std::chrono::steady_clock::now());
+
+  /*!
+   *\brief Takes all queued arrays as a batch, according to the current mode.
+   *
+   * Waits for an array if the queue is empty.
+   *\return False once the queue is stopped.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool pop(Batch & batch);
+
+  /*!
+   *\brief Fails all current and future pop() calls
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void stop();
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  Statistics getStatistics() const;
+
+  /*!
+   *\brief Name of a mode for logs and diagnostics
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  static const char * getModeName(Mode mode);
+
+private:
+  struct Entry
+  {
+    diagnostic_msgs::msg::DiagnosticArray::SharedPtr msg;
+    std::chrono::steady_clock::time_point received;
+  };
+
+  double getLag(std::chrono::steady_clock::time_point now) const;
+  void updateMode(std::chrono::steady_clock::time_point now);
+
+  rclcpp::Logger logger_;
+  const std::size_t capacity_;
+  const Thresholds coalesce_;
+  const Thresholds shed_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable pushed_;
+  bool stopped_;
+  std::deque<Entry> entries_;
+  Statistics statistics_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__INGEST_QUEUE_HPP_
@@ -0,0 +1,163 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__METRICS_EXPORTER_HPP_
+#define DIAGNOSTIC_AGGREGATOR__METRICS_EXPORTER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief Serves the aggregated state as OpenMetrics text over HTTP.
+ *
+ * The MetricsExporter is owned by the Aggregator, which hands it the whole
+ * tree after every publication. It answers GET /metrics on a local port with
+ * the level and staleness of every status, the number of statuses per level,
+ * the toplevel level and the counters of the aggregator itself.
+ *
+ * The text of the statuses is kept between publications: the lines of a
+ * status are only formatted again when its level changes, and the section is
+ * only reassembled when any status changed, appeared or disappeared. A scrape
+ * sends that section as it is plus a few lines of counters, so scraping often
+ * costs almost nothing.
+ *
+ * Requests are served one at a time by a thread of the exporter.
+ *
+ * Configured via the aggregator parameters:
+\verbatim
+metrics:
+  port: 9469  # Export is disabled if 0
+  address: 127.0.0.1
+\endverbatim
+ */
+class MetricsExporter
+{
+public:
+  /*!
+   *\brief Listens on the given address and port, 0 for any free port.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  MetricsExporter(const std::string & address, int port);
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  ~MetricsExporter();
+
+  /*!
+   *\brief True if the exporter is listening
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool isOpen() const {return listen_fd_ >= 0;}
+
+  /*!
+   *\brief Port the exporter listens on
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  int getPort() const {return port_;}
+
+  /*!
+   *\brief Takes the tree after a publication of the aggregator.
+   *
+   *\param tree : All statuses of the aggregated tree
+   *\param toplevel_level : Level published on /diagnostics_toplevel_state
+   *\param duration : Seconds it took to process and publish the tree
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void update(
+    const std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> & tree,
+    std::uint8_t toplevel_level, double duration);
+
+  /*!
+   *\brief Counts the statuses received on /diagnostics
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void countReceived(std::size_t statuses) {received_ += statuses;}
+
+  /*!
+   *\brief Number of times the section of the statuses was reassembled
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::uint64_t getRebuildCount() const {return rebuilds_;}
+
+private:
+  struct Series
+  {
+    std::uint8_t level;
+    std::uint64_t generation;
+    std::string level_line;
+    std::string stale_line;
+  };
+
+  void run();
+  void serve(int fd);
+  std::string counters() const;
+
+  rclcpp::Logger logger_;
+  int listen_fd_;
+  int port_;
+  std::thread thread_;
+  std::atomic<bool> running_;
+
+  /// Series by status name, only used by update()
+  std::map<std::string, Series> series_;
+  std::uint64_t generation_;
+
+  /// Section of the statuses, swapped by update() and sent by serve()
+  std::mutex section_mutex_;
+  std::shared_ptr<const std::string> section_;
+
+  std::atomic<std::uint8_t> toplevel_level_;
+  std::atomic<double> duration_;
+  std::atomic<std::uint64_t> publications_;
+  std::atomic<std::uint64_t> received_;
+  std::atomic<std::uint64_t> scrapes_;
+  std::atomic<std::uint64_t> rebuilds_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__METRICS_EXPORTER_HPP_
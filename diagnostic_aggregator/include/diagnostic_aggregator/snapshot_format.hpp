@@ -0,0 +1,110 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__SNAPSHOT_FORMAT_HPP_
+#define DIAGNOSTIC_AGGREGATOR__SNAPSHOT_FORMAT_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief Layout of the shared-memory snapshot of the aggregated tree.
+ *
+ * The region starts with a RegionHeader, followed by capacity bytes of data.
+ * The data holds status_count StatusRecords, then the ValueRecords of all
+ * statuses, then the characters of all strings. Strings are referenced by an
+ * offset from the start of the data and a length, and are not terminated.
+\verbatim
+data := StatusRecord[status_count] | ValueRecord[value_count] | char[]
+\endverbatim
+ * The region has a single writer and is guarded by a seqlock: sequence is odd
+ * while the writer changes the snapshot, or before the first snapshot. A
+ * reader copies size bytes of data and retries if sequence was odd or changed
+ * meanwhile.
+ */
+namespace snapshot
+{
+constexpr char kRegionMagic[8] = {'D', 'I', 'A', 'G', 'S', 'H', 'M', '1'};
+constexpr std::uint32_t kVersion = 1;
+
+static_assert(
+  std::atomic<std::uint64_t>::is_always_lock_free,
+  "The seqlock needs a lock free 64 bit atomic to work across processes");
+
+struct RegionHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t reserved;
+  std::uint64_t capacity;              /**< bytes of data after the header */
+  std::atomic<std::uint64_t> sequence; /**< odd while the snapshot is being written */
+  // Guarded by sequence
+  std::uint64_t size;                  /**< bytes of data used by the snapshot */
+  std::int64_t stamp;                  /**< stamp of the snapshot, in ns */
+  std::uint32_t status_count;
+  std::uint32_t value_count;
+  std::uint8_t padding[8];
+};
+static_assert(sizeof(RegionHeader) == 64, "RegionHeader must be 64 bytes");
+
+struct StatusRecord
+{
+  std::uint32_t name_offset;
+  std::uint32_t name_size;
+  std::uint32_t message_offset;
+  std::uint32_t message_size;
+  std::uint32_t hardware_id_offset;
+  std::uint32_t hardware_id_size;
+  std::uint32_t first_value;  /**< index of the first ValueRecord of the status */
+  std::uint16_t value_count;
+  std::uint8_t level;
+  std::uint8_t reserved;
+};
+static_assert(sizeof(StatusRecord) == 32, "StatusRecord must be 32 bytes");
+
+struct ValueRecord
+{
+  std::uint32_t key_offset;
+  std::uint32_t key_size;
+  std::uint32_t value_offset;
+  std::uint32_t value_size;
+};
+static_assert(sizeof(ValueRecord) == 16, "ValueRecord must be 16 bytes");
+
+}  // namespace snapshot
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__SNAPSHOT_FORMAT_HPP_
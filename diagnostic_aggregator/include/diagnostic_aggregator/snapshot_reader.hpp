@@ -0,0 +1,206 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__SNAPSHOT_READER_HPP_
+#define DIAGNOSTIC_AGGREGATOR__SNAPSHOT_READER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "diagnostic_aggregator/snapshot_format.hpp"
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief A consistent copy of the aggregated tree taken by a SnapshotReader.
+ *
+ * The statuses are read in place from the copied region, all strings are
+ * views into the snapshot and stay valid until it is read into again.
+ */
+class Snapshot
+{
+public:
+  /*!
+   *\brief View of one status of the snapshot
+   */
+  class Status
+  {
+public:
+    std::uint8_t getLevel() const {return record_->level;}
+    std::string_view getName() const {return view(record_->name_offset, record_->name_size);}
+    std::string_view getMessage() const
+    {
+      return view(record_->message_offset, record_->message_size);
+    }
+    std::string_view getHardwareId() const
+    {
+      return view(record_->hardware_id_offset, record_->hardware_id_size);
+    }
+    std::size_t getValueCount() const {return record_->value_count;}
+    std::string_view getKey(std::size_t i) const
+    {
+      const snapshot::ValueRecord & value = values_[record_->first_value + i];
+      return view(value.key_offset, value.key_size);
+    }
+    std::string_view getValue(std::size_t i) const
+    {
+      const snapshot::ValueRecord & value = values_[record_->first_value + i];
+      return view(value.value_offset, value.value_size);
+    }
+
+private:
+    friend class Snapshot;
+    Status(
+      const char * data, const snapshot::StatusRecord * record,
+      const snapshot::ValueRecord * values)
+    : data_(data), record_(record), values_(values) {}
+
+    std::string_view view(std::uint32_t offset, std::uint32_t size) const
+    {
+      return std::string_view(data_ + offset, size);
+    }
+
+    const char * data_;
+    const snapshot::StatusRecord * record_;
+    const snapshot::ValueRecord * values_;
+  };
+
+  Snapshot()
+  : sequence_(0), stamp_(0), status_count_(0) {}
+
+  /*!
+   *\brief Number of statuses in the tree
+   */
+  std::size_t size() const {return status_count_;}
+
+  Status operator[](std::size_t i) const
+  {
+    auto records = reinterpret_cast<const snapshot::StatusRecord *>(data_.data());
+    return Status(
+      data_.data(), records + i,
+      reinterpret_cast<const snapshot::ValueRecord *>(records + status_count_));
+  }
+
+  /*!
+   *\brief Stamp of the tree in ns, as published on /diagnostics_agg
+   */
+  std::int64_t getStamp() const {return stamp_;}
+
+  /*!
+   *\brief Sequence of the region when the snapshot was taken
+   */
+  std::uint64_t getSequence() const {return sequence_;}
+
+private:
+  friend class SnapshotReader;
+
+  /// Copy of the data, kept 8 byte aligned for the records
+  std::vector<std::uint64_t> storage_;
+  std::string_view data_;
+  std::uint64_t sequence_;
+  std::int64_t stamp_;
+  std::size_t status_count_;
+};
+
+/*!
+ *\brief Reads the aggregated tree that an Aggregator exports to shared memory.
+ *
+ * The region is mapped read-only, reading a snapshot copies the used bytes
+ * once and checks that the writer didn't change them meanwhile, see
+ * snapshot_format.hpp. Nothing is deserialized and, once the snapshot has
+ * grown to the size of the tree, nothing is allocated either.
+ *
+ * This library doesn't depend on ROS, so any local process can use it:
+\verbatim
+SnapshotReader reader;
+Snapshot snapshot;
+if (reader.open("/diagnostics_agg") && reader.read(snapshot)) {
+  for (std::size_t i = 0; i < snapshot.size(); ++i) {
+    std::cout << snapshot[i].getName() << ": " << snapshot[i].getMessage() << std::endl;
+  }
+}
+\endverbatim
+ */
+class SnapshotReader
+{
+public:
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  SnapshotReader();
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  ~SnapshotReader();
+
+  /*!
+   *\brief Maps the region exported by an Aggregator read-only.
+   *
+   *\return False if the region doesn't exist or isn't a snapshot region.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool open(const std::string & name);
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void close();
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool isOpen() const {return header_ != nullptr;}
+
+  /*!
+   *\brief Current sequence of the region, to check cheaply for a new snapshot
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::uint64_t getSequence() const;
+
+  /*!
+   *\brief Copies the latest snapshot.
+   *
+   *\param max_retries : Attempts while the writer is changing the snapshot
+   *\return False if nothing has been exported yet, or no consistent copy could be taken.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool read(Snapshot & snapshot, int max_retries = 100) const;
+
+private:
+  bool validate(const Snapshot & snapshot, std::uint32_t value_count) const;
+
+  const snapshot::RegionHeader * header_;
+  const char * data_;
+  std::uint64_t region_size_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__SNAPSHOT_READER_HPP_
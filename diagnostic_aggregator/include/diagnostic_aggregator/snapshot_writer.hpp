@@ -0,0 +1,110 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__SNAPSHOT_WRITER_HPP_
+#define DIAGNOSTIC_AGGREGATOR__SNAPSHOT_WRITER_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/snapshot_format.hpp"
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief Exports the aggregated tree into a shared-memory region.
+ *
+ * The SnapshotWriter is owned by the Aggregator, which writes the whole tree
+ * into it after every publication. Local readers map the region with a
+ * SnapshotReader and get the tree without a subscription or deserialization.
+ * The layout is described in snapshot_format.hpp.
+ *
+ * The region is created with shm_open() and removed again when the writer
+ * is destroyed. A tree that doesn't fit into the capacity is not exported.
+ *
+ * Configured via the aggregator parameters:
+\verbatim
+snapshot:
+  name: /diagnostics_agg  # Export is disabled if empty
+  capacity: 1048576
+\endverbatim
+ */
+class SnapshotWriter
+{
+public:
+  /*!
+   *\brief Creates (or takes over) the shared-memory region.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  SnapshotWriter(const std::string & name, std::uint64_t capacity = 1024 * 1024);
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  ~SnapshotWriter();
+
+  /*!
+   *\brief True if the region could be created and mapped
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool isOpen() const {return header_ != nullptr;}
+
+  /*!
+   *\brief Replaces the snapshot in the region with the given tree.
+   *
+   *\return False if the region isn't open or the tree doesn't fit
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool write(
+    const std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> & statuses,
+    const rclcpp::Time & stamp);
+
+private:
+  rclcpp::Logger logger_;
+  std::string name_;
+  std::uint64_t capacity_;
+  std::uint64_t region_size_;
+  snapshot::RegionHeader * header_;
+  char * data_;
+  bool overflow_warned_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__SNAPSHOT_WRITER_HPP_
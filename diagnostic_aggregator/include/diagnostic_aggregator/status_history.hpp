@@ -0,0 +1,135 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__STATUS_HISTORY_HPP_
+#define DIAGNOSTIC_AGGREGATOR__STATUS_HISTORY_HPP_
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief In-memory history of the levels of the aggregated statuses.
+ *
+ * Every status of the aggregated output keeps the runs of equal level it went
+ * through, i.e. only level changes are stored. A run takes 8 bytes, its start
+ * is kept with microsecond resolution. At most max_transitions runs are kept
+ * per status, older ones are dropped.
+ *
+ * The statuses are indexed by name, so a subtree is a range of the index, and
+ * the runs of a status are ordered by time, so the runs of a time window are
+ * found by binary search. A query only touches the statuses of the subtree and
+ * the runs of the window.
+ *
+ * Configured via the aggregator parameter:
+\verbatim
+history:
+  max_transitions: 128  # History is disabled if 0
+\endverbatim
+ */
+class StatusHistory
+{
+public:
+  struct Transition
+  {
+    std::string name;
+    std::int64_t stamp;  /**< Nanoseconds, truncated to microseconds */
+    std::uint8_t level;
+  };
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  explicit StatusHistory(std::size_t max_transitions = 128);
+
+  /*!
+   *\brief Adds an aggregated tree, stamped with its header stamp.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void record(const diagnostic_msgs::msg::DiagnosticArray & tree);
+
+  /*!
+   *\brief Level transitions of a subtree in [start, end], ordered by time.
+   *
+   *\param path Selects the status with this name and all statuses below it,
+   * an empty path selects all statuses.
+   *
+   * For every selected status, the transition that set its level at start is
+   * included as well, even if it is older than start.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::vector<Transition> query(
+    const std::string & path, std::int64_t start, std::int64_t end) const;
+
+  /*!
+   *\brief Number of statuses with a history
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::size_t getStatusCount() const;
+
+private:
+  /*!
+   *\brief Ring of the runs of one status, oldest first.
+   *
+   * A run is packed as (start in microseconds << 8) | level.
+   */
+  struct Track
+  {
+    std::vector<std::uint64_t> runs;
+    std::size_t head = 0;  /**< Index of the oldest run once the ring is full */
+
+    std::uint64_t at(std::size_t i) const {return runs[(head + i) % runs.size()];}
+    std::uint64_t back() const {return at(runs.size() - 1);}
+  };
+
+  using Index = std::map<std::string, Track>;
+
+  void collect(
+    Index::const_iterator begin, Index::const_iterator end, std::int64_t start,
+    std::int64_t stop, std::vector<Transition> & out) const;
+
+  std::size_t max_transitions_;
+  Index tracks_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__STATUS_HISTORY_HPP_
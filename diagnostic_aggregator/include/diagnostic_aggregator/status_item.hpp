@@ -44,7 +44,9 @@
 #include <string>
 #include <vector>
 
+#include "diagnostic_aggregator/flap_damper.hpp"
 #include "diagnostic_aggregator/visibility_control.hpp"
+#include "diagnostic_aggregator/window_statistics.hpp"
 
 #include "diagnostic_msgs/msg/diagnostic_status.hpp"
 #include "diagnostic_msgs/msg/key_value.hpp"
@@ -185,9 +187,13 @@ class StatusItem
 public:
   /*!
    *\brief Constructed from const DiagnosticStatus*
+   *
+   *\param clock : Clock of the update time, a system clock if null
    */
   DIAGNOSTIC_AGGREGATOR_PUBLIC
-  explicit StatusItem(const diagnostic_msgs::msg::DiagnosticStatus * status);
+  explicit StatusItem(
+    const diagnostic_msgs::msg::DiagnosticStatus * status,
+    rclcpp::Clock::SharedPtr clock = nullptr);
 
   /*!
   *\brief Constructed from string of item name
@@ -195,7 +201,7 @@ public:
   DIAGNOSTIC_AGGREGATOR_PUBLIC
   StatusItem(
     const std::string item_name, const std::string message = "Missing",
-    const DiagnosticLevel level = Level_Stale);
+    const DiagnosticLevel level = Level_Stale, rclcpp::Clock::SharedPtr clock = nullptr);
 
   DIAGNOSTIC_AGGREGATOR_PUBLIC
   ~StatusItem();
@@ -223,6 +229,15 @@ public:
   std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus> toStatusMsg(
     const std::string & path, const bool stale = false) const;
 
+  /*!
+   *\brief Returns a copy of this item with another level and message.
+   *
+   * The copy keeps the update time, so it goes stale like the original.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::shared_ptr<StatusItem> withLevel(
+    const DiagnosticLevel level, const std::string & message) const;
+
   /*
    *\brief Returns level of DiagnosticStatus message
    */
@@ -231,17 +246,17 @@ public:
   /*!
    *\brief Get message field of DiagnosticStatus
    */
-  std::string getMessage() const {return message_;}
+  const std::string & getMessage() const {return message_;}
 
   /*!
    *\brief Returns name of DiagnosticStatus message
    */
-  std::string getName() const {return name_;}
+  const std::string & getName() const {return name_;}
 
   /*!
    *\brief Returns hardware ID field of DiagnosticStatus message
    */
-  std::string getHwId() const {return hw_id_;}
+  const std::string & getHwId() const {return hw_id_;}
 
   /*!
    *\brief Returns the time since last update for this item
@@ -280,7 +295,78 @@ public:
     return std::string("");
   }
 
+  /*!
+   *\brief Returns value for given key without copying it
+   *
+   *\return Pointer to the value if key present, null if not
+   */
+  const std::string * findValue(const std::string & key) const
+  {
+    for (unsigned int i = 0; i < values_.size(); ++i) {
+      if (values_[i].key == key) {
+        return &values_[i].value;
+      }
+    }
+
+    return nullptr;
+  }
+
+  /*!
+   *\brief Returns the value for given key as number
+   *
+   * All values are parsed once per update, on the first call.
+   *
+   *\return True if key present and its value is a number
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool getNumber(const std::string & key, double & value) const;
+
+  /*!
+   *\brief Adds the numeric values to statistics over a time window
+   *
+   * The statistics are taken over from the previous item of the same status,
+   * so they cover all its updates within the window. Calling this again for
+   * the same item has no effect.
+   *
+   *\param window : Window length in seconds
+   *\param keys : Keys to track, all numeric values if empty
+   *\param previous : Previous item of this status, may be null
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void trackStatistics(
+    double window, const std::vector<std::string> & keys, const StatusItem * previous);
+
+  /*!
+   *\brief Returns the window statistics of key, null if not tracked
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  const WindowStatistics * getStatistics(const std::string & key) const;
+
+  /*!
+   *\brief Damps the level changes of this status, see FlapDamper
+   *
+   * The damper is taken over from the previous item of the same status. If
+   * the level is held, the item gets the level and message of the previous
+   * item. Calling this again for the same item has no effect.
+   *
+   *\param dwell : Seconds a lower level must last before it is reported
+   *\param window : Window of the flap count in seconds
+   *\param max_flaps : Flaps in the window from which the highest level is held
+   *\param previous : Previous item of this status, may be null
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void dampFlaps(double dwell, double window, int max_flaps, const StatusItem * previous);
+
+  /*!
+   *\brief Returns the flap damper of this status, null if not damped
+   */
+  const FlapDamper * getFlapDamper() const {return flap_damper_.get();}
+
 private:
+  void parseNumbers() const;
+  void addStatistics();
+
+
   rclcpp::Time update_time_;
   rclcpp::Clock::SharedPtr clock_;
 
@@ -290,6 +376,16 @@ private:
   std::string message_;
   std::string hw_id_;
   std::vector<diagnostic_msgs::msg::KeyValue> values_;
+
+  /// Parsed values_, NaN if not a number. Empty until first needed.
+  mutable std::vector<double> numbers_;
+  mutable bool numbers_parsed_;
+
+  double statistics_window_;
+  std::vector<std::string> statistics_keys_;
+  std::shared_ptr<std::map<std::string, WindowStatistics>> statistics_;
+
+  std::shared_ptr<FlapDamper> flap_damper_;
 };
 
 }  // namespace diagnostic_aggregator
@@ -0,0 +1,144 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__SUBTREE_PUBLISHER_HPP_
+#define DIAGNOSTIC_AGGREGATOR__SUBTREE_PUBLISHER_HPP_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief Name order of an aggregated tree, to cut subtrees by binary search.
+ */
+class SubtreeIndex
+{
+public:
+  /*!
+   *\brief Sorts the statuses of tree by name. tree must outlive the index.
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void build(const diagnostic_msgs::msg::DiagnosticArray & tree);
+
+  /*!
+   *\brief Appends the status named path and all statuses below it, by name
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void cut(
+    const std::string & path, std::vector<diagnostic_msgs::msg::DiagnosticStatus> & out) const;
+
+private:
+  const diagnostic_msgs::msg::DiagnosticArray * tree_ = nullptr;
+  std::vector<std::uint32_t> order_;
+};
+
+/*!
+ *\brief Publishes subtrees of the aggregated output on dedicated topics.
+ *
+ * Clients subscribe to a path and a maximum rate with the
+ * ~/subscribe_subtree service and get a topic name, ~/subtree_<n>. Clients
+ * asking for the same path and rate share a topic. On every aggregated
+ * output, the statuses are sorted by name once, and every path that is due
+ * is cut once, no matter how many topics publish it.
+ *
+ * A topic is removed once it had no subscribers for idle_timeout seconds.
+ */
+class SubtreePublisher
+{
+public:
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  explicit SubtreePublisher(rclcpp::Node::SharedPtr node, double idle_timeout = 10.0);
+
+  /*!
+   *\brief Returns the topic publishing path at up to max_rate Hz
+   *
+   *\param max_rate : 0 publishes every aggregated output
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::string subscribe(const std::string & path, double max_rate);
+
+  /*!
+   *\brief Publishes the subtrees of an aggregated output that are due
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void publish(const diagnostic_msgs::msg::DiagnosticArray & tree);
+
+  /*!
+   *\brief Number of subtree topics
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  std::size_t getTopicCount() const;
+
+private:
+  struct Cut
+  {
+    diagnostic_msgs::msg::DiagnosticArray tree;
+    bool done = false;  /**< True once cut from the current output */
+  };
+
+  struct Subtree
+  {
+    std::string path;
+    double max_rate;
+    std::string topic;
+    rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr publisher;
+    rclcpp::Time last_published;
+    rclcpp::Time last_subscribed;  /**< Last time the topic had subscribers */
+  };
+
+  rclcpp::Node::SharedPtr node_;
+  rclcpp::Clock::SharedPtr clock_;
+  double idle_timeout_;
+  std::uint64_t next_id_;
+  std::vector<Subtree> subtrees_;
+  SubtreeIndex index_;
+  std::map<std::string, Cut> cuts_;  /**< By path, reused for every output */
+  mutable std::mutex mutex_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__SUBTREE_PUBLISHER_HPP_
@@ -0,0 +1,141 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__THRESHOLD_ANALYZER_HPP_
+#define DIAGNOSTIC_AGGREGATOR__THRESHOLD_ANALYZER_HPP_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/generic_analyzer.hpp"
+#include "diagnostic_aggregator/status_item.hpp"
+#include "diagnostic_aggregator/threshold_rule.hpp"
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief ThresholdAnalyzer is a GenericAnalyzer that raises levels by rules.
+ *
+ * The ThresholdAnalyzer matches and reports items like the GenericAnalyzer and
+ * takes the same parameters. Additionally, the "rules" parameter gives a list of
+ * level rules, see ThresholdRule for their syntax. The rules are compiled once
+ * in init() and evaluated for every incoming item. If rules apply, the item is
+ * reported with the highest of their levels, if that is above its own level,
+ * and the description of that rule as message.
+ *
+ * Rules with a duration, or depending on age, are evaluated again on report.
+ *
+ * Example configuration:
+ *\verbatim
+ * motors:
+ *   type: diagnostic_aggregator/ThresholdAnalyzer
+ *   path: Motors
+ *   startswith: [ 'motor' ]
+ *   rules: [
+ *     'ERROR if Temperature > 80 for 5',
+ *     'WARN if Temperature > 60',
+ *     'WARN if `Actual frequency` < 0.9 * `Target frequency` || age > 2',
+ *     'ERROR if message == "Disconnected"']
+ *\endverbatim
+ */
+class ThresholdAnalyzer : public GenericAnalyzer
+{
+public:
+  /*!
+   *\brief Default constructor loaded by pluginlib
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  ThresholdAnalyzer();
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  virtual ~ThresholdAnalyzer();
+
+  /*!
+   *\brief Initializes the GenericAnalyzer part and compiles the rules
+   *
+   *\return False if the GenericAnalyzer failed or a rule is invalid
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool init(
+    const std::string & base_path, const std::string & breadcrumb,
+    const rclcpp::Node::SharedPtr node);
+
+  /*!
+   *\brief Applies the rules to item and analyzes the result
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  virtual bool analyze(const std::shared_ptr<StatusItem> item);
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  virtual std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> report();
+
+private:
+  /*!
+   *\brief Incoming item of a status and since when each rule's condition holds.
+   */
+  struct Tracked
+  {
+    std::shared_ptr<StatusItem> item;
+    std::vector<std::int64_t> since;  /**< Nanoseconds, -1 if the condition doesn't hold */
+    const ThresholdRule * applied = nullptr;  /**< Rule that set the reported level */
+  };
+
+  /*!
+   *\brief Evaluates the rules for tracked, updates since and applied
+   *
+   *\return True if the applied rule changed
+   */
+  bool apply(Tracked & tracked, const rclcpp::Time & now);
+
+  /*!
+   *\brief Returns the item to be reported for tracked
+   */
+  std::shared_ptr<StatusItem> result(const Tracked & tracked) const;
+
+  std::vector<ThresholdRule> rules_;
+  bool reevaluate_;  /**< True if a rule has a duration or depends on age */
+  std::map<std::string, Tracked> tracked_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__THRESHOLD_ANALYZER_HPP_
@@ -0,0 +1,151 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__THRESHOLD_RULE_HPP_
+#define DIAGNOSTIC_AGGREGATOR__THRESHOLD_RULE_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/status_item.hpp"
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief A level rule of the ThresholdAnalyzer, compiled to bytecode.
+ *
+ * A rule has the form
+\verbatim
+LEVEL if CONDITION [for SECONDS]
+\endverbatim
+ * for example "ERROR if Temperature > 80 for 5". LEVEL is one of OK, WARN,
+ * ERROR and STALE. CONDITION is an expression over
+ * - the numeric KeyValues of the status, by key. Keys that are not plain
+ *   identifiers are quoted with backticks, e.g. `Actual frequency`.
+ * - level, the level of the status, and the constants OK, WARN, ERROR, STALE
+ * - age, the seconds since the last update of the status
+ * - message, hardware_id and name, and KeyValues, compared with == or != to
+ *   a 'quoted' or "quoted" string
+ *
+ * with the operators + - * / < <= > >= == != && || ! (or "and", "or", "not")
+ * and parentheses. Unlike in C, ! binds looser than comparisons. A KeyValue
+ * that is missing or not a number is NaN, so any comparison with it but != is
+ * false.
+ *
+ * The rule is parsed once by compile(). test() runs the bytecode on a
+ * preallocated stack and doesn't parse or allocate.
+ */
+class ThresholdRule
+{
+public:
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  ThresholdRule();
+
+  /*!
+   *\brief Compiles a rule.
+   *
+   *\return False with a description of the problem in error, if it is invalid
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool compile(const std::string & source, std::string & error);
+
+  /*!
+   *\brief Evaluates the condition of the rule for an item.
+   *
+   *\param age : Seconds since the last update of item
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  bool test(const StatusItem & item, double age) const;
+
+  /*!
+   *\brief Level the rule sets while its condition holds
+   */
+  DiagnosticLevel getLevel() const {return level_;}
+
+  /*!
+   *\brief Seconds the condition has to hold before the rule applies
+   */
+  double getDuration() const {return duration_;}
+
+  /*!
+   *\brief True if the condition depends on age
+   */
+  bool usesAge() const {return uses_age_;}
+
+  /*!
+   *\brief The rule without its level, e.g. "Temperature > 80 for 5"
+   */
+  const std::string & getDescription() const {return description_;}
+
+  enum class Op : std::uint8_t
+  {
+    Number, Key, Level, Age,
+    Neg, Not, Add, Sub, Mul, Div,
+    Lt, Le, Gt, Ge, Eq, Ne, And, Or,
+    StringEq, StringNe
+  };
+
+  enum class Field : std::uint8_t
+  {
+    None, Key, Message, HardwareId, Name
+  };
+
+  struct Instruction
+  {
+    Op op;
+    Field field;         /**< Compared field of StringEq and StringNe */
+    std::uint32_t index; /**< Into keys_ for Key, into strings_ for StringEq and StringNe */
+    std::uint32_t key;   /**< Into keys_ for a compared KeyValue */
+    double value;        /**< Constant of Number */
+  };
+
+private:
+  DiagnosticLevel level_;
+  double duration_;
+  bool uses_age_;
+  std::string description_;
+
+  std::vector<Instruction> code_;
+  std::vector<std::string> keys_;
+  std::vector<std::string> strings_;
+  mutable std::vector<double> stack_;
+
+  friend class ThresholdRuleCompiler;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__THRESHOLD_RULE_HPP_
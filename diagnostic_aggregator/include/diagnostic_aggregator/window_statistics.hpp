@@ -0,0 +1,109 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_AGGREGATOR__WINDOW_STATISTICS_HPP_
+#define DIAGNOSTIC_AGGREGATOR__WINDOW_STATISTICS_HPP_
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "diagnostic_aggregator/visibility_control.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief Streaming statistics of the samples of a sliding time window.
+ *
+ * Samples older than the window, measured from the newest sample, are
+ * dropped when a sample is added. Minimum, maximum and mean are maintained
+ * incrementally in amortized O(1), percentiles are selected on request.
+ */
+class WindowStatistics
+{
+public:
+  /*!
+   *\param window Length of the window in seconds
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  explicit WindowStatistics(double window);
+
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  void add(const rclcpp::Time & stamp, double value);
+
+  /*!
+   *\brief Number of samples in the window
+   */
+  std::size_t count() const {return samples_.size();}
+
+  /*!
+   *\brief Smallest sample of the window, 0 if empty
+   */
+  double min() const {return min_.empty() ? 0.0 : min_.front().second;}
+
+  /*!
+   *\brief Largest sample of the window, 0 if empty
+   */
+  double max() const {return max_.empty() ? 0.0 : max_.front().second;}
+
+  /*!
+   *\brief Mean of the samples of the window, 0 if empty
+   */
+  double mean() const {return samples_.empty() ? 0.0 : sum_ / samples_.size();}
+
+  /*!
+   *\brief Nearest-rank percentile of the window, 0 if empty
+   *
+   *\param p Percentile in [0, 1]
+   */
+  DIAGNOSTIC_AGGREGATOR_PUBLIC
+  double percentile(double p) const;
+
+private:
+  using Sample = std::pair<std::int64_t, double>;
+
+  std::int64_t window_;
+  std::deque<Sample> samples_;
+  std::deque<Sample> min_;  /**< Increasing candidates for the minimum */
+  std::deque<Sample> max_;  /**< Decreasing candidates for the maximum */
+  double sum_;
+  mutable std::vector<double> scratch_;
+};
+
+}  // namespace diagnostic_aggregator
+
+#endif  // DIAGNOSTIC_AGGREGATOR__WINDOW_STATISTICS_HPP_
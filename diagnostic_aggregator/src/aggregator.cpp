@@ -37,11 +37,15 @@
 
 #include "diagnostic_aggregator/aggregator.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace diagnostic_aggregator
@@ -56,7 +60,7 @@ using diagnostic_msgs::msg::DiagnosticStatus;
 /**
  * @todo(anordman): make aggregator a lifecycle node.
  */
-Aggregator::Aggregator()
+Aggregator::Aggregator(rclcpp::Clock::SharedPtr clock)
 : n_(std::make_shared<rclcpp::Node>(
       "analyzers", "",
       rclcpp::NodeOptions().allow_undeclared_parameters(true).
@@ -64,14 +68,65 @@ Aggregator::Aggregator()
   logger_(rclcpp::get_logger("Aggregator")),
   pub_rate_(1.0),
   history_depth_(1000),
-  clock_(n_->get_clock()),
+  clock_(clock ? clock : n_->get_clock()),
+  analyzer_clock_(clock),
   base_path_(""),
   critical_(false),
-  last_top_level_state_(DiagnosticStatus::STALE)
+  critical_deadline_(0.1),
+  last_top_level_state_(DiagnosticStatus::STALE),
+  flight_recorder_segment_size_(4 * 1024 * 1024),
+  flight_recorder_segment_count_(16),
+  snapshot_capacity_(1024 * 1024),
+  metrics_address_("127.0.0.1"),
+  metrics_port_(0),
+  history_max_transitions_(128),
+  publish_period_(1.0),
+  tick_(0),
+  other_ticks_(1),
+  measure_phases_(false),
+  overload_queue_size_(0),
+  overload_coalesce_{1000, 0.5},
+  overload_shed_{10000, 2.0},
+  overload_dropped_(0)
 {
   RCLCPP_DEBUG(logger_, "constructor");
   initAnalyzers();
 
+  if (!flight_recorder_file_.empty()) {
+    flight_recorder_ = std::make_unique<FlightRecorder>(
+      flight_recorder_file_, flight_recorder_segment_size_, flight_recorder_segment_count_);
+  }
+
+  if (!snapshot_name_.empty()) {
+    snapshot_writer_ = std::make_unique<SnapshotWriter>(snapshot_name_, snapshot_capacity_);
+  }
+
+  if (metrics_port_ > 0) {
+    metrics_exporter_ = std::make_unique<MetricsExporter>(
+      metrics_address_, static_cast<int>(metrics_port_));
+  }
+
+  if (overload_queue_size_ > 0) {
+    ingest_queue_ = std::make_unique<IngestQueue>(
+      overload_queue_size_, overload_coalesce_, overload_shed_);
+    ingest_status_pub_ = n_->create_publisher<DiagnosticArray>("/diagnostics", 1);
+    ingest_thread_ = std::thread(&Aggregator::ingestLoop, this);
+  }
+
+  subtree_publisher_ = std::make_unique<SubtreePublisher>(n_);
+  subtree_srv_ = n_->create_service<diagnostic_aggregator_msgs::srv::SubscribeSubtree>(
+    "~/subscribe_subtree", std::bind(&Aggregator::subscribeSubtree, this, _1, _2));
+
+  hardware_srv_ = n_->create_service<diagnostic_aggregator_msgs::srv::GetHardwareStatus>(
+    "~/get_hardware_status",
+    std::bind(&Aggregator::getHardwareStatus, this, _1, _2));
+
+  if (history_max_transitions_ > 0) {
+    history_ = std::make_unique<StatusHistory>(history_max_transitions_);
+    history_srv_ = n_->create_service<diagnostic_aggregator_msgs::srv::GetHistory>(
+      "~/get_history", std::bind(&Aggregator::getHistory, this, _1, _2));
+  }
+
   diag_sub_ = n_->create_subscription<DiagnosticArray>(
     "/diagnostics", rclcpp::SystemDefaultsQoS().keep_last(history_depth_),
     std::bind(&Aggregator::diagCallback, this, _1));
@@ -79,10 +134,7 @@ Aggregator::Aggregator()
   toplevel_state_pub_ =
     n_->create_publisher<DiagnosticStatus>("/diagnostics_toplevel_state", 1);
 
-  int publish_rate_ms = 1000 / pub_rate_;
-  publish_timer_ = n_->create_wall_timer(
-    std::chrono::milliseconds(publish_rate_ms),
-    std::bind(&Aggregator::publishData, this));
+  createPublishTimer();
 
   param_sub_ = n_->create_subscription<rcl_interfaces::msg::ParameterEvent>(
     "/parameter_events", 1, std::bind(&Aggregator::parameterCallback, this, _1));
@@ -93,7 +145,11 @@ void Aggregator::parameterCallback(const rcl_interfaces::msg::ParameterEvent::Sh
   if (msg->node == "/" + std::string(n_->get_name())) {
     if (msg->new_parameters.size() != 0) {
       base_path_ = "";
+      double publish_period = publish_period_;
       initAnalyzers();
+      if (publish_period_ != publish_period) {
+        createPublishTimer();
+      }
     }
   }
 }
@@ -101,6 +157,9 @@ void Aggregator::parameterCallback(const rcl_interfaces::msg::ParameterEvent::Sh
 void Aggregator::initAnalyzers()
 {
   bool other_as_errors = false;
+  std::vector<std::string> federation_children;
+  double federation_timeout = 5.0;
+  double hardware_timeout = 5.0;
 
   std::map<std::string, rclcpp::Parameter> parameters;
   if (!n_->get_parameters("", parameters)) {
@@ -123,6 +182,42 @@ void Aggregator::initAnalyzers()
       history_depth_ = param.second.as_int();
     } else if (param.first.compare("critical") == 0) {
       critical_ = param.second.as_bool();
+    } else if (param.first.compare("critical_deadline") == 0) {
+      critical_deadline_ = param.second.as_double();
+    } else if (param.first.compare("flight_recorder.file") == 0) {
+      flight_recorder_file_ = param.second.as_string();
+    } else if (param.first.compare("flight_recorder.segment_size") == 0) {
+      flight_recorder_segment_size_ = param.second.as_int();
+    } else if (param.first.compare("flight_recorder.segment_count") == 0) {
+      flight_recorder_segment_count_ = param.second.as_int();
+    } else if (param.first.compare("snapshot.name") == 0) {
+      snapshot_name_ = param.second.as_string();
+    } else if (param.first.compare("snapshot.capacity") == 0) {
+      snapshot_capacity_ = param.second.as_int();
+    } else if (param.first.compare("metrics.port") == 0) {
+      metrics_port_ = param.second.as_int();
+    } else if (param.first.compare("metrics.address") == 0) {
+      metrics_address_ = param.second.as_string();
+    } else if (param.first.compare("overload.queue_size") == 0) {
+      overload_queue_size_ = param.second.as_int();
+    } else if (param.first.compare("overload.coalesce_depth") == 0) {
+      overload_coalesce_.depth = param.second.as_int();
+    } else if (param.first.compare("overload.coalesce_lag") == 0) {
+      overload_coalesce_.lag = param.second.as_double();
+    } else if (param.first.compare("overload.shed_depth") == 0) {
+      overload_shed_.depth = param.second.as_int();
+    } else if (param.first.compare("overload.shed_lag") == 0) {
+      overload_shed_.lag = param.second.as_double();
+    } else if (param.first.compare("history.max_transitions") == 0) {
+      history_max_transitions_ = param.second.as_int();
+    } else if (param.first.compare("hardware_rollup.path") == 0) {
+      hardware_rollup_path_ = param.second.as_string();
+    } else if (param.first.compare("hardware_rollup.timeout") == 0) {
+      hardware_timeout = param.second.as_double();
+    } else if (param.first.compare("federation.children") == 0) {
+      federation_children = param.second.as_string_array();
+    } else if (param.first.compare("federation.timeout") == 0) {
+      federation_timeout = param.second.as_double();
     }
   }
   RCLCPP_DEBUG(logger_, "Aggregator publication rate configured to: %f", pub_rate_);
@@ -135,14 +230,57 @@ void Aggregator::initAnalyzers()
   {  // lock the mutex while analyzer_group_ and other_analyzer_ are being updated
     std::lock_guard<std::mutex> lock(mutex_);
     analyzer_group_ = std::make_unique<AnalyzerGroup>();
+    hardware_index_.setTimeout(hardware_timeout);
+    if (analyzer_clock_) {
+      analyzer_group_->setClock(analyzer_clock_);
+    }
     if (!analyzer_group_->init(base_path_, "", n_)) {
       RCLCPP_ERROR(logger_, "Analyzer group for diagnostic aggregator failed to initialize!");
     }
 
+    // Child aggregators are reported as they are, next to the analyzers
+    federated_.clear();
+    federation_subs_.clear();
+    for (const auto & child : federation_children) {
+      auto federated = std::make_shared<FederatedAnalyzer>();
+      if (analyzer_clock_) {
+        federated->setClock(analyzer_clock_);
+      }
+      federated->init(base_path_, child, federation_timeout);
+      std::shared_ptr<Analyzer> analyzer = federated;
+      analyzer_group_->addAnalyzer(analyzer);
+      federated_[child] = federated;
+      federation_subs_.push_back(
+        n_->create_subscription<DiagnosticArray>(
+          "/" + child + "/diagnostics_agg", rclcpp::SystemDefaultsQoS().keep_last(history_depth_),
+          std::bind(&Aggregator::federationCallback, this, federated, _1)));
+    }
+
     // Last analyzer handles remaining data
     other_analyzer_ = std::make_unique<OtherAnalyzer>(other_as_errors);
+    if (analyzer_clock_) {
+      other_analyzer_->setClock(analyzer_clock_);
+    }
     other_analyzer_->init(base_path_);  // This always returns true
+
+    // The timer ticks at the highest rate in the tree, every analyzer is reported
+    // on the multiple of that tick which is closest to its own period
+    publish_period_ = analyzer_group_->setPeriod(1.0 / pub_rate_);
+    analyzer_group_->setTick(publish_period_);
+    other_ticks_ = std::max<uint64_t>(1, std::llround(1.0 / pub_rate_ / publish_period_));
+    other_output_.clear();
+    hardware_output_.clear();
+    tick_ = 0;
   }
+  RCLCPP_DEBUG(logger_, "Aggregator scheduler tick configured to: %f s", publish_period_);
+}
+
+void Aggregator::createPublishTimer()
+{
+  int publish_period_ms = 1000 * publish_period_;
+  publish_timer_ = n_->create_wall_timer(
+    std::chrono::milliseconds(publish_period_ms),
+    std::bind(&Aggregator::publishData, this));
 }
 
 void Aggregator::checkTimestamp(const DiagnosticArray::SharedPtr diag_msg)
@@ -170,45 +308,193 @@ void Aggregator::checkTimestamp(const DiagnosticArray::SharedPtr diag_msg)
 void Aggregator::diagCallback(const DiagnosticArray::SharedPtr diag_msg)
 {
   RCLCPP_DEBUG(logger_, "diagCallback()");
+  auto start = std::chrono::steady_clock::now();
   checkTimestamp(diag_msg);
+  if (metrics_exporter_) {
+    metrics_exporter_->countReceived(diag_msg->status.size());
+  }
+
+  if (ingest_queue_) {
+    ingest_queue_->push(diag_msg, start);
+    return;
+  }
+
+  std::vector<const DiagnosticStatus *> statuses;
+  statuses.reserve(diag_msg->status.size());
+  for (const auto & status : diag_msg->status) {
+    statuses.push_back(&status);
+  }
+  analyzeStatuses(std::move(statuses), 1, start, start);
+}
+
+void Aggregator::ingestLoop()
+{
+  IngestQueue::Batch batch;
+  while (ingest_queue_->pop(batch)) {
+    analyzeStatuses(
+      std::move(batch.statuses), batch.arrays.size(), batch.received,
+      std::chrono::steady_clock::now());
+  }
+}
+
+bool Aggregator::isUrgent(const DiagnosticStatus & status)
+{
+  auto it = ingest_levels_.find(status.name);
+  if (it == ingest_levels_.end()) {
+    // A new status is only urgent if it isn't OK
+    ingest_levels_.emplace(status.name, status.level);
+    return status.level != DiagnosticStatus::OK;
+  }
+  bool changed = it->second != status.level;
+  it->second = status.level;
+  return changed || status.level != DiagnosticStatus::OK;
+}
 
-  bool analyzed = false;
+void Aggregator::analyzeStatuses(
+  std::vector<const DiagnosticStatus *> statuses, std::size_t arrays,
+  std::chrono::steady_clock::time_point received, std::chrono::steady_clock::time_point start)
+{
   bool immediate_report = false;
   {  // lock the whole loop to ensure nothing in the analyzer group changes during it.
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (auto j = 0u; j < diag_msg->status.size(); ++j) {
-      analyzed = false;
-      auto item = std::make_shared<StatusItem>(&diag_msg->status[j]);
-
-      if (analyzer_group_->match(item->getName())) {
-        analyzed = analyzer_group_->analyze(item);
+    std::unique_lock<std::mutex> lock(mutex_);
+    // The urgent statuses go first. The other statuses are dropped if an
+    // urgent one of the same name follows them, they would overwrite its
+    // newer level otherwise.
+    std::vector<bool> urgent(statuses.size());
+    std::unordered_map<std::string_view, std::size_t> last_urgent;
+    for (std::size_t i = 0; i < statuses.size(); ++i) {
+      urgent[i] = isUrgent(*statuses[i]);
+      if (urgent[i]) {
+        last_urgent[statuses[i]->name] = i;
       }
-
-      if (!analyzed) {
-        other_analyzer_->analyze(item);
+    }
+    std::vector<const DiagnosticStatus *> ordered;
+    ordered.reserve(statuses.size());
+    for (std::size_t i = 0; i < statuses.size(); ++i) {
+      if (urgent[i]) {
+        ordered.push_back(statuses[i]);
       }
-
-      // In case there is a degraded state, publish immediately
-      if (critical_ && item->getLevel() > last_top_level_state_) {
-        immediate_report = true;
+    }
+    std::size_t urgent_count = ordered.size();
+    for (std::size_t i = 0; i < statuses.size(); ++i) {
+      if (!urgent[i]) {
+        auto it = last_urgent.find(statuses[i]->name);
+        if (it == last_urgent.end() || it->second < i) {
+          ordered.push_back(statuses[i]);
+        }
       }
     }
+    auto urgent_end = ordered.cbegin() + urgent_count;
+    if (analyzeItems(ordered.cbegin(), urgent_end, start)) {
+      // Report before the unchanged OK statuses are analyzed
+      lock.unlock();
+      publishDue(true);
+      auto latency = std::chrono::steady_clock::now() - received;
+      lock.lock();
+      ++critical_latency_.reports;
+      critical_latency_.total += latency;
+      critical_latency_.max = std::max<std::chrono::nanoseconds>(critical_latency_.max, latency);
+      double seconds = std::chrono::duration<double>(latency).count();
+      if (seconds > critical_deadline_) {
+        ++critical_latency_.late;
+        RCLCPP_WARN(
+          logger_, "Immediate report took %.3f s, more than the critical_deadline of %.3f s.",
+          seconds, critical_deadline_);
+      }
+      start = std::chrono::steady_clock::now();
+    }
+    immediate_report = analyzeItems(urgent_end, ordered.cend(), start);
+    if (measure_phases_) {
+      phase_times_.arrays += arrays;
+      phase_times_.statuses += statuses.size();
+    }
+  }
+
+  if (immediate_report) {
+    publishDue(true);
+  }
+}
+
+bool Aggregator::analyzeItems(
+  std::vector<const DiagnosticStatus *>::const_iterator first,
+  std::vector<const DiagnosticStatus *>::const_iterator last,
+  std::chrono::steady_clock::time_point & start)
+{
+  bool immediate_report = false;
+  std::chrono::steady_clock::time_point ingested;
+  for (; first != last; ++first) {
+    bool analyzed = false;
+    auto item = std::make_shared<StatusItem>(*first, analyzer_clock_);
+    if (measure_phases_) {
+      ingested = std::chrono::steady_clock::now();
+      phase_times_.ingest += ingested - start;
+    }
+
+    if (analyzer_group_->match(item->getName())) {
+      analyzed = analyzer_group_->analyze(item);
+    }
+
+    if (!analyzed) {
+      other_analyzer_->analyze(item);
+    }
+
+    // After the analyzers, which may have damped the level of the item
+    hardware_index_.update(item);
+
+    // In case there is a degraded state, publish immediately
+    if (critical_ && item->getLevel() > last_top_level_state_) {
+      immediate_report = true;
+    }
+
+    if (measure_phases_) {
+      start = std::chrono::steady_clock::now();
+      phase_times_.match += start - ingested;
+    }
+  }
+  return immediate_report;
+}
+
+void Aggregator::federationCallback(
+  const std::shared_ptr<FederatedAnalyzer> & child, const DiagnosticArray::SharedPtr diag_msg)
+{
+  RCLCPP_DEBUG(logger_, "federationCallback(%s)", child->getName().c_str());
+  bool immediate_report = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint8_t level = child->update(*diag_msg);
+
+    // In case there is a degraded state, publish immediately
+    immediate_report = critical_ && level > last_top_level_state_;
   }
 
   if (immediate_report) {
-    publishData();
+    publishDue(true);
   }
 }
 
 Aggregator::~Aggregator()
 {
   RCLCPP_DEBUG(logger_, "destructor");
+  if (ingest_queue_) {
+    ingest_queue_->stop();
+    ingest_thread_.join();
+  }
 }
 
 void Aggregator::publishData()
 {
   RCLCPP_DEBUG(logger_, "publishData()");
-  DiagnosticArray diag_array;
+  publishDue(false);
+}
+
+void Aggregator::publishDue(bool force)
+{
+  RCLCPP_DEBUG(logger_, "publishDue()");
+  std::lock_guard<std::mutex> publish_lock(publish_mutex_);
+  auto start = std::chrono::steady_clock::now();
+  // Shared so the flight recorder can take it over without a copy
+  auto diag_array_ptr = std::make_shared<DiagnosticArray>();
+  DiagnosticArray & diag_array = *diag_array_ptr;
   DiagnosticStatus diag_toplevel_state;
   diag_toplevel_state.name = "toplevel_state";
   diag_toplevel_state.level = DiagnosticStatus::STALE;
@@ -216,37 +502,104 @@ void Aggregator::publishData()
   int min_level = 255;
 
   std::vector<std::shared_ptr<DiagnosticStatus>> processed;
+  std::vector<std::shared_ptr<DiagnosticStatus>> processed_hardware;
+  std::vector<std::shared_ptr<DiagnosticStatus>> tree_hardware;
+  std::vector<std::shared_ptr<DiagnosticStatus>> tree;
+  std::chrono::steady_clock::time_point reported;
+  bool measure_phases;
+  bool root_due;
+  bool partial;
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    processed = analyzer_group_->report();
-  }
-  for (const auto & msg : processed) {
-    diag_array.status.push_back(*msg);
+    auto report_start = std::chrono::steady_clock::now();
+    // Subtrees that are not due keep their last output, the toplevel state is
+    // computed from the whole tree
+    analyzer_group_->reportDue(tick_, force, processed);
+    for (const auto & msg : analyzer_group_->getOutput()) {
+      max_level = std::max<int>(max_level, msg->level);
+      min_level = std::min<int>(min_level, msg->level);
+    }
 
-    if (msg->level > max_level) {
-      max_level = msg->level;
+    root_due = force || tick_ % other_ticks_ == 0;
+    if (root_due) {
+      other_output_ = other_analyzer_->report();
+      processed.insert(processed.end(), other_output_.begin(), other_output_.end());
     }
-    if (msg->level < min_level) {
-      min_level = msg->level;
+    for (const auto & msg : other_output_) {
+      max_level = std::max<int>(max_level, msg->level);
+      min_level = std::min<int>(min_level, msg->level);
     }
-  }
 
-  std::vector<std::shared_ptr<DiagnosticStatus>> processed_other =
-    other_analyzer_->report();
-  for (const auto & msg : processed_other) {
-    diag_array.status.push_back(*msg);
+    // Only some subtrees are due if analyzers have rates of their own
+    partial = !root_due ||
+      processed.size() != analyzer_group_->getOutput().size() + other_output_.size();
+    if (partial || snapshot_writer_ || metrics_exporter_) {
+      // The snapshot, the metrics, the recorder, the history and the subtrees
+      // always get the whole tree, not only the due subtrees
+      tree = analyzer_group_->getOutput();
+      tree.insert(tree.end(), other_output_.begin(), other_output_.end());
+    }
 
-    if (msg->level > max_level) {
-      max_level = msg->level;
+    if (root_due && !hardware_rollup_path_.empty()) {
+      hardware_index_.expire(analyzer_clock_ ? analyzer_clock_->now() : rclcpp::Clock().now());
+      hardware_output_ = hardware_index_.report(base_path_ + "/" + hardware_rollup_path_);
+      processed_hardware = hardware_output_;
+    }
+    if (partial) {
+      // The last rollup, which isn't part of the tree for the snapshot and the metrics
+      tree_hardware = hardware_output_;
     }
-    if (msg->level < min_level) {
-      min_level = msg->level;
+    if (!force) {
+      ++tick_;
+    }
+
+    measure_phases = measure_phases_;
+    if (measure_phases) {
+      reported = std::chrono::steady_clock::now();
+      phase_times_.report += reported - report_start;
     }
   }
+  for (const auto & msg : processed) {
+    diag_array.status.push_back(*msg);
+  }
+
+  // The rollup repeats the levels of the items above, it doesn't count for the toplevel state
+  for (const auto & msg : processed_hardware) {
+    diag_array.status.push_back(*msg);
+  }
 
   diag_array.header.stamp = clock_->now();
   agg_pub_->publish(diag_array);
 
+  // Statuses missing from the array count as removed for the recorder, the
+  // history and the subtrees, so they get the whole tree
+  auto tree_array_ptr = diag_array_ptr;
+  if (partial) {
+    tree_array_ptr = std::make_shared<DiagnosticArray>();
+    tree_array_ptr->header = diag_array.header;
+    tree_array_ptr->status.reserve(tree.size() + tree_hardware.size());
+    for (const auto & msg : tree) {
+      tree_array_ptr->status.push_back(*msg);
+    }
+    for (const auto & msg : tree_hardware) {
+      tree_array_ptr->status.push_back(*msg);
+    }
+  }
+
+  if (flight_recorder_) {
+    flight_recorder_->record(tree_array_ptr);
+  }
+
+  if (snapshot_writer_) {
+    snapshot_writer_->write(tree, diag_array.header.stamp);
+  }
+
+  if (history_) {
+    history_->record(*tree_array_ptr);
+  }
+
+  subtree_publisher_->publish(*tree_array_ptr);
+
   diag_toplevel_state.level = max_level;
   if (max_level < 0 ||
     (max_level > DiagnosticStatus::ERROR && min_level <= DiagnosticStatus::ERROR))
@@ -255,9 +608,167 @@ void Aggregator::publishData()
     // have stale items but not all are stale
     diag_toplevel_state.level = DiagnosticStatus::ERROR;
   }
-  last_top_level_state_ = diag_toplevel_state.level;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_top_level_state_ = diag_toplevel_state.level;
+  }
 
   toplevel_state_pub_->publish(diag_toplevel_state);
+
+  if (metrics_exporter_) {
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    metrics_exporter_->update(tree, diag_toplevel_state.level, duration.count());
+  }
+
+  if (root_due && ingest_queue_) {
+    publishIngestStatus();
+  }
+
+  if (measure_phases) {
+    auto published = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    phase_times_.publish += published - reported;
+    ++phase_times_.publications;
+  }
+}
+
+void Aggregator::publishIngestStatus()
+{
+  IngestQueue::Statistics statistics = ingest_queue_->getStatistics();
+
+  DiagnosticStatus status;
+  status.name = std::string(n_->get_name()) + ": Ingest";
+  status.hardware_id = "none";
+  // Published from the timer and from immediate reports of the ingest thread
+  uint64_t dropped = overload_dropped_.exchange(statistics.dropped);
+  if (statistics.dropped > dropped) {
+    status.level = DiagnosticStatus::ERROR;
+    status.message = "Dropping statuses";
+  } else if (statistics.mode != IngestQueue::Mode_Normal) {
+    status.level = DiagnosticStatus::WARN;
+    status.message = std::string("Overloaded, ") + IngestQueue::getModeName(statistics.mode);
+  } else {
+    status.level = DiagnosticStatus::OK;
+    status.message = "OK";
+  }
+
+  auto add = [&status](const std::string & key, const std::string & value) {
+      diagnostic_msgs::msg::KeyValue kv;
+      kv.key = key;
+      kv.value = value;
+      status.values.push_back(kv);
+    };
+  add("Mode", IngestQueue::getModeName(statistics.mode));
+  add("Queued statuses", std::to_string(statistics.depth));
+  add("Lag (s)", std::to_string(statistics.lag));
+  add("Received", std::to_string(statistics.received));
+  add("Coalesced", std::to_string(statistics.coalesced));
+  add("Stripped", std::to_string(statistics.stripped));
+  add("Dropped", std::to_string(statistics.dropped));
+  if (critical_) {
+    CriticalLatency latency = getCriticalLatency();
+    add("Immediate reports", std::to_string(latency.reports));
+    add("Late immediate reports", std::to_string(latency.late));
+    add("Max immediate report latency (s)",
+      std::to_string(std::chrono::duration<double>(latency.max).count()));
+  }
+
+  DiagnosticArray array;
+  array.header.stamp = clock_->now();
+  array.status.push_back(status);
+  ingest_status_pub_->publish(array);
+}
+
+void Aggregator::enablePhaseTimes(bool enable)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (enable && !measure_phases_) {
+    phase_times_ = PhaseTimes();
+  }
+  measure_phases_ = enable;
+}
+
+CriticalLatency Aggregator::getCriticalLatency()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return critical_latency_;
+}
+
+PhaseTimes Aggregator::getPhaseTimes()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return phase_times_;
+}
+
+void Aggregator::subscribeSubtree(
+  const std::shared_ptr<diagnostic_aggregator_msgs::srv::SubscribeSubtree::Request> request,
+  std::shared_ptr<diagnostic_aggregator_msgs::srv::SubscribeSubtree::Response> response)
+{
+  RCLCPP_DEBUG(logger_, "subscribeSubtree()");
+  if (request->path.empty() || request->path == "/") {
+    response->success = false;
+    response->message = "The whole tree is published on /diagnostics_agg";
+    return;
+  }
+  if (request->max_rate < 0) {
+    response->success = false;
+    response->message = "max_rate must not be negative";
+    return;
+  }
+
+  response->topic = subtree_publisher_->subscribe(request->path, request->max_rate);
+  response->success = true;
+}
+
+void Aggregator::getHardwareStatus(
+  const std::shared_ptr<diagnostic_aggregator_msgs::srv::GetHardwareStatus::Request> request,
+  std::shared_ptr<diagnostic_aggregator_msgs::srv::GetHardwareStatus::Response> response)
+{
+  RCLCPP_DEBUG(logger_, "getHardwareStatus()");
+  std::vector<std::shared_ptr<StatusItem>> items;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    items = hardware_index_.lookup(request->hardware_id);
+  }
+
+  if (items.empty()) {
+    response->success = false;
+    response->message = "No status with hardware_id '" + request->hardware_id + "'";
+    return;
+  }
+
+  for (const auto & item : items) {
+    auto status = item->toStatusMsg("");
+    status->name = item->getName();
+    response->status.push_back(*status);
+  }
+  response->success = true;
+}
+
+void Aggregator::getHistory(
+  const std::shared_ptr<diagnostic_aggregator_msgs::srv::GetHistory::Request> request,
+  std::shared_ptr<diagnostic_aggregator_msgs::srv::GetHistory::Response> response)
+{
+  RCLCPP_DEBUG(logger_, "getHistory()");
+  int64_t start = rclcpp::Time(request->start).nanoseconds();
+  int64_t end = rclcpp::Time(request->end).nanoseconds();
+  if (end == 0) {
+    end = clock_->now().nanoseconds();
+  }
+  if (end < start) {
+    response->success = false;
+    response->message = "End of the time window is before its start";
+    return;
+  }
+
+  for (const auto & transition : history_->query(request->path, start, end)) {
+    diagnostic_aggregator_msgs::msg::LevelTransition msg;
+    msg.name = transition.name;
+    msg.stamp = rclcpp::Time(transition.stamp, clock_->get_clock_type());
+    msg.level = transition.level;
+    response->transitions.push_back(msg);
+  }
+  response->success = true;
 }
 
 rclcpp::Node::SharedPtr Aggregator::get_node() const
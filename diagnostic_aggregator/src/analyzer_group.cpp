@@ -38,6 +38,7 @@
 #include "diagnostic_aggregator/analyzer_group.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <map>
 #include <memory>
 #include <string>
@@ -54,7 +55,8 @@ AnalyzerGroup::AnalyzerGroup()
 : path_(""),
   nice_name_(""),
   analyzer_loader_("diagnostic_aggregator", "diagnostic_aggregator::Analyzer"),
-  logger_(rclcpp::get_logger("AnalyzerGroup"))
+  logger_(rclcpp::get_logger("AnalyzerGroup")),
+  period_(0.0)
 {
 }
 
@@ -79,6 +81,7 @@ bool AnalyzerGroup::init(
     breadcrumb_.c_str());
 
   std::string ns, an_type, an_path, an_breadcrumb;
+  double an_pub_rate = 0.0;
   std::shared_ptr<Analyzer> analyzer;
   std::string p_type = breadcrumb_.empty() ? "type" : breadcrumb_ + ".type";
   std::string p_path = breadcrumb_.empty() ? "path" : breadcrumb_ + ".path";
@@ -110,11 +113,18 @@ bool AnalyzerGroup::init(
       RCLCPP_DEBUG(
         logger_, "Group '%s' found analyzer path: %s", nice_name_.c_str(), an_path.c_str());
     }
+    if (param.first.compare(ns + ".pub_rate") == 0) {
+      an_pub_rate = param.second.as_double();
+      RCLCPP_DEBUG(
+        logger_, "Group '%s' found analyzer pub_rate: %f", nice_name_.c_str(), an_pub_rate);
+    }
 
     if (!ns.empty() && !an_type.empty() && !an_path.empty()) {
       RCLCPP_INFO(
         logger_, "Group '%s', creating %s '%s' (breadcrumb: %s) ...", nice_name_.c_str(),
         an_type.c_str(), an_path.c_str(), ns.c_str());
+      double pub_rate = an_pub_rate;
+      an_pub_rate = 0.0;
 
       try {
         if (!analyzer_loader_.isClassAvailable(an_type)) {
@@ -154,6 +164,7 @@ bool AnalyzerGroup::init(
       RCLCPP_DEBUG(
         logger_, "Initializing %s in '%s' (breadcrumb: %s) ...", an_type.c_str(), an_path.c_str(),
         an_breadcrumb.c_str());
+      analyzer->setClock(clock_);
       if (!analyzer->init(an_path, an_breadcrumb, n)) {
         RCLCPP_ERROR(
           logger_, "Unable to initialize analyzer NS: %s, type: %s", n->get_namespace(),
@@ -163,7 +174,7 @@ bool AnalyzerGroup::init(
         init_ok = false;
         continue;
       } else {
-        this->addAnalyzer(analyzer);
+        this->addAnalyzer(analyzer, pub_rate);
         ns = "";
         an_type = "";
         an_path = "";
@@ -190,11 +201,27 @@ AnalyzerGroup::~AnalyzerGroup()
 }
 
 bool AnalyzerGroup::addAnalyzer(std::shared_ptr<Analyzer> & analyzer)
+{
+  return addAnalyzer(analyzer, 0.0);
+}
+
+bool AnalyzerGroup::addAnalyzer(std::shared_ptr<Analyzer> & analyzer, double pub_rate)
 {
   RCLCPP_INFO(
     logger_, "Adding analyzer '%s' to group '%s'.", analyzer->getName().c_str(),
     nice_name_.c_str());
+  if (pub_rate < 0.0) {
+    RCLCPP_WARN(
+      logger_, "Analyzer '%s' has a negative pub_rate, using the rate of group '%s'.",
+      analyzer->getName().c_str(), nice_name_.c_str());
+    pub_rate = 0.0;
+  }
   analyzers_.push_back(analyzer);
+  rates_.push_back(pub_rate);
+  periods_.push_back(pub_rate > 0.0 ? 1.0 / pub_rate : period_);
+  ticks_.push_back(1);
+  groups_.push_back(dynamic_cast<AnalyzerGroup *>(analyzer.get()));
+  cached_.emplace_back();
   return true;
 }
 
@@ -203,7 +230,13 @@ bool AnalyzerGroup::removeAnalyzer(std::shared_ptr<Analyzer> & analyzer)
   RCLCPP_DEBUG(logger_, "removeAnalyzer()");
   auto it = find(analyzers_.begin(), analyzers_.end(), analyzer);
   if (it != analyzers_.end()) {
+    auto i = it - analyzers_.begin();
     analyzers_.erase(it);
+    rates_.erase(rates_.begin() + i);
+    periods_.erase(periods_.begin() + i);
+    ticks_.erase(ticks_.begin() + i);
+    groups_.erase(groups_.begin() + i);
+    cached_.erase(cached_.begin() + i);
     return true;
   }
   return false;
@@ -273,7 +306,69 @@ bool AnalyzerGroup::analyze(const std::shared_ptr<StatusItem> item)
 std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> AnalyzerGroup::report()
 {
   RCLCPP_DEBUG(logger_, "report()");
-  std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> output;
+  for (auto j = 0u; j < analyzers_.size(); ++j) {
+    cached_[j] = analyzers_[j]->report();
+  }
+  collectOutput();
+  return output_;
+}
+
+double AnalyzerGroup::setPeriod(double period)
+{
+  period_ = period;
+  double shortest = period;
+  for (auto j = 0u; j < analyzers_.size(); ++j) {
+    periods_[j] = rates_[j] > 0.0 ? 1.0 / rates_[j] : period_;
+    if (groups_[j]) {
+      periods_[j] = groups_[j]->setPeriod(periods_[j]);
+    }
+    shortest = std::min(shortest, periods_[j]);
+  }
+  return shortest;
+}
+
+void AnalyzerGroup::setTick(double tick)
+{
+  for (auto j = 0u; j < analyzers_.size(); ++j) {
+    ticks_[j] = tick > 0.0 ? std::max<uint64_t>(1, std::llround(periods_[j] / tick)) : 1;
+    if (groups_[j]) {
+      groups_[j]->setTick(tick);
+    }
+  }
+}
+
+bool AnalyzerGroup::reportDue(
+  uint64_t tick, bool force,
+  std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> & due)
+{
+  RCLCPP_DEBUG(logger_, "reportDue()");
+  bool reported = analyzers_.empty();
+  for (auto j = 0u; j < analyzers_.size(); ++j) {
+    if (groups_[j]) {
+      // A group is due whenever one of its sub-analyzers is
+      if (groups_[j]->reportDue(tick, force, due)) {
+        cached_[j] = groups_[j]->getOutput();
+        reported = true;
+      }
+    } else if (force || tick % ticks_[j] == 0) {
+      cached_[j] = analyzers_[j]->report();
+      due.insert(due.end(), cached_[j].begin(), cached_[j].end());
+      reported = true;
+    }
+  }
+
+  if (!reported) {
+    return false;
+  }
+
+  auto own = collectOutput();
+  due.insert(due.end(), output_.begin() + own, output_.end());
+  return true;
+}
+
+size_t AnalyzerGroup::collectOutput()
+{
+  output_.clear();
 
   auto header_status = std::make_shared<diagnostic_msgs::msg::DiagnosticStatus>();
   header_status->name = path_;
@@ -283,13 +378,13 @@ std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> AnalyzerGro
   if (analyzers_.size() == 0) {
     header_status->level = 2;
     header_status->message = "No analyzers";
-    output.push_back(header_status);
+    output_.push_back(header_status);
 
     if (header_status->name == "" || header_status->name == "/") {
       header_status->name = "/AnalyzerGroup";
     }
 
-    return output;
+    return 0;
   }
 
   bool all_stale = true;
@@ -298,28 +393,20 @@ std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> AnalyzerGro
     std::string path = analyzers_[j]->getPath();
     std::string nice_name = analyzers_[j]->getName();
 
-    std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> processed =
-      analyzers_[j]->report();
-
-    // Do not report anything in the header values for analyzers that don't report
-    if (processed.empty()) {
-      continue;
-    }
-
     // Look through processed data for header, append it to header_status
     // Ex: Look for /Robot/Power and append (Power, OK) to header
-    for (auto i = 0u; i < processed.size(); ++i) {
-      output.push_back(processed[i]);
+    for (const auto & processed : cached_[j]) {
+      output_.push_back(processed);
 
       // Add to header status
-      if (processed[i]->name == path) {
+      if (processed->name == path) {
         diagnostic_msgs::msg::KeyValue kv;
         kv.key = nice_name;
-        kv.value = processed[i]->message;
+        kv.value = processed->message;
 
         all_stale = all_stale &&
-          (processed[i]->level == diagnostic_msgs::msg::DiagnosticStatus::STALE);
-        header_status->level = max(header_status->level, processed[i]->level);
+          (processed->level == diagnostic_msgs::msg::DiagnosticStatus::STALE);
+        header_status->level = max(header_status->level, processed->level);
         header_status->values.push_back(kv);
       }
     }
@@ -332,15 +419,16 @@ std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> AnalyzerGro
 
   header_status->message = valToMsg(header_status->level);
 
+  size_t own = output_.size();
   if (path_ != "" && path_ != "/") {  // No header if we don't have a base path
-    output.push_back(header_status);
+    output_.push_back(header_status);
   }
 
   for (auto i = 0u; i < aux_items_.size(); ++i) {
-    output.push_back(aux_items_[i]->toStatusMsg(path_, true));
+    output_.push_back(aux_items_[i]->toStatusMsg(path_, true));
   }
 
-  return output;
+  return own;
 }
 
 }  // namespace diagnostic_aggregator
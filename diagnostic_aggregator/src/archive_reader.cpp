@@ -0,0 +1,391 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/archive_reader.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace diagnostic_aggregator
+{
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace ar = archive;
+namespace fr = flight_recorder;
+
+ArchiveReader::ArchiveReader()
+: logger_(rclcpp::get_logger("ArchiveReader")),
+  fd_(-1),
+  next_block_(0),
+  cursor_(nullptr, 0),
+  remaining_(0),
+  last_stamp_(0),
+  pending_(false),
+  pending_stamp_(0)
+{
+}
+
+ArchiveReader::~ArchiveReader()
+{
+  close();
+}
+
+bool ArchiveReader::open(const std::string & file)
+{
+  close();
+
+  fd_ = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0) {
+    RCLCPP_ERROR(logger_, "Couldn't open archive '%s': %s", file.c_str(), strerror(errno));
+    return false;
+  }
+
+  struct stat st;
+  ar::FileHeader header;
+  if (fstat(fd_, &st) != 0 ||
+    pread(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+    std::memcmp(header.magic, ar::kFileMagic, sizeof(header.magic)) != 0 ||
+    header.version != ar::kVersion)
+  {
+    RCLCPP_ERROR(logger_, "'%s' is not a diagnostics archive.", file.c_str());
+    close();
+    return false;
+  }
+
+  if (!readIndex(st.st_size)) {
+    RCLCPP_WARN(logger_, "Archive '%s' has no index, scanning its blocks.", file.c_str());
+    if (!scanBlocks(st.st_size)) {
+      close();
+      return false;
+    }
+  }
+  return true;
+}
+
+void ArchiveReader::close()
+{
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  index_.clear();
+  next_block_ = 0;
+  remaining_ = 0;
+  pending_ = false;
+}
+
+bool ArchiveReader::readIndex(std::uint64_t file_size)
+{
+  ar::Footer footer;
+  if (file_size < sizeof(ar::FileHeader) + sizeof(footer) ||
+    pread(fd_, &footer, sizeof(footer), file_size - sizeof(footer)) !=
+    static_cast<ssize_t>(sizeof(footer)) ||
+    std::memcmp(footer.magic, ar::kFooterMagic, sizeof(footer.magic)) != 0 ||
+    footer.index_offset + footer.block_count * sizeof(ar::IndexEntry) + sizeof(footer) !=
+    file_size)
+  {
+    return false;
+  }
+
+  index_.resize(footer.block_count);
+  std::size_t size = index_.size() * sizeof(ar::IndexEntry);
+  if (pread(fd_, index_.data(), size, footer.index_offset) != static_cast<ssize_t>(size)) {
+    index_.clear();
+    return false;
+  }
+  return true;
+}
+
+bool ArchiveReader::scanBlocks(std::uint64_t file_size)
+{
+  index_.clear();
+  std::uint64_t offset = sizeof(ar::FileHeader);
+  ar::BlockHeader header;
+  while (offset + sizeof(header) <= file_size &&
+    pread(fd_, &header, sizeof(header), offset) == static_cast<ssize_t>(sizeof(header)) &&
+    header.magic == ar::kBlockMagic &&
+    offset + sizeof(header) + header.stored_size <= file_size)
+  {
+    ar::IndexEntry entry;
+    entry.offset = offset;
+    entry.first_stamp = header.first_stamp;
+    entry.last_stamp = header.last_stamp;
+    entry.message_count = header.message_count;
+    index_.push_back(entry);
+    offset += sizeof(header) + header.stored_size;
+  }
+  // A block that was cut off by a crash is dropped
+  return true;
+}
+
+bool ArchiveReader::getTimeRange(rclcpp::Time & first, rclcpp::Time & last) const
+{
+  if (index_.empty()) {
+    return false;
+  }
+
+  first = rclcpp::Time(index_.front().first_stamp, RCL_ROS_TIME);
+  last = rclcpp::Time(index_.back().last_stamp, RCL_ROS_TIME);
+  return true;
+}
+
+bool ArchiveReader::seek(const rclcpp::Time & stamp)
+{
+  const std::int64_t ns = stamp.nanoseconds();
+  pending_ = false;
+  remaining_ = 0;
+
+  // First block that ends at or after the requested time
+  auto it = std::lower_bound(
+    index_.begin(), index_.end(), ns, [](const ar::IndexEntry & entry, std::int64_t value) {
+      return entry.last_stamp < value;
+    });
+  next_block_ = it - index_.begin();
+
+  rclcpp::Time found;
+  while (read(pending_topic_, found, pending_msg_)) {
+    if (found.nanoseconds() >= ns) {
+      pending_stamp_ = found.nanoseconds();
+      pending_ = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ArchiveReader::read(std::string & topic, rclcpp::Time & stamp, DiagnosticArray & msg)
+{
+  if (pending_) {
+    pending_ = false;
+    topic = pending_topic_;
+    stamp = rclcpp::Time(pending_stamp_, RCL_ROS_TIME);
+    msg = pending_msg_;
+    return true;
+  }
+
+  while (remaining_ == 0) {
+    if (fd_ < 0 || next_block_ >= index_.size() || !loadBlock(next_block_++)) {
+      return false;
+    }
+  }
+
+  std::int64_t ns;
+  if (!decode(topic, ns, msg)) {
+    RCLCPP_WARN(logger_, "Corrupt message in block %zu of the archive.", next_block_ - 1);
+    remaining_ = 0;
+    return false;
+  }
+  --remaining_;
+  stamp = rclcpp::Time(ns, RCL_ROS_TIME);
+  return true;
+}
+
+bool ArchiveReader::loadBlock(std::size_t block)
+{
+  const ar::IndexEntry & entry = index_[block];
+  ar::BlockHeader header;
+  if (pread(fd_, &header, sizeof(header), entry.offset) != static_cast<ssize_t>(sizeof(header)) ||
+    header.magic != ar::kBlockMagic)
+  {
+    RCLCPP_WARN(logger_, "Block %zu of the archive is missing.", block);
+    return false;
+  }
+
+  std::vector<std::uint8_t> stored(header.stored_size);
+  if (pread(fd_, stored.data(), stored.size(), entry.offset + sizeof(header)) !=
+    static_cast<ssize_t>(stored.size()) ||
+    crc32(0L, stored.data(), stored.size()) != header.crc)
+  {
+    RCLCPP_WARN(logger_, "Block %zu of the archive is corrupt.", block);
+    return false;
+  }
+
+  if (header.compression == ar::Compression_Zlib) {
+    payload_.resize(header.raw_size);
+    uLongf size = payload_.size();
+    if (uncompress(payload_.data(), &size, stored.data(), stored.size()) != Z_OK ||
+      size != payload_.size())
+    {
+      RCLCPP_WARN(logger_, "Block %zu of the archive can't be decompressed.", block);
+      return false;
+    }
+  } else if (header.compression == ar::Compression_None) {
+    payload_.swap(stored);
+  } else {
+    RCLCPP_WARN(logger_, "Block %zu of the archive has an unknown compression.", block);
+    return false;
+  }
+
+  cursor_ = fr::RecordCursor(payload_.data(), payload_.size());
+  remaining_ = header.message_count;
+  last_stamp_ = 0;
+  topics_.clear();
+  names_.clear();
+  keys_.clear();
+  texts_.clear();
+  values_.clear();
+  states_.clear();
+  return true;
+}
+
+bool ArchiveReader::getRef(std::vector<std::string> & dictionary, std::uint64_t & id)
+{
+  if (!cursor_.getVarint(id) || id > dictionary.size()) {
+    return false;
+  }
+  if (id == dictionary.size()) {
+    dictionary.emplace_back();
+    return cursor_.getString(dictionary.back());
+  }
+  return true;
+}
+
+bool ArchiveReader::decode(std::string & topic, std::int64_t & stamp, DiagnosticArray & msg)
+{
+  std::uint64_t topic_id, delta, header_delta, frame_id, count;
+  if (!getRef(topics_, topic_id) || !cursor_.getVarint(delta) ||
+    !cursor_.getVarint(header_delta) || !getRef(texts_, frame_id) || !cursor_.getVarint(count))
+  {
+    return false;
+  }
+  if (topic_id >= states_.size()) {
+    states_.resize(topic_id + 1);
+  }
+
+  topic = topics_[topic_id];
+  stamp = last_stamp_ + ar::unzigzag(delta);
+  last_stamp_ = stamp;
+  msg.header.stamp = rclcpp::Time(stamp + ar::unzigzag(header_delta), RCL_ROS_TIME);
+  msg.header.frame_id = texts_[frame_id];
+
+  // Every status takes at least two bytes of the block
+  if (count > payload_.size() / 2) {
+    return false;
+  }
+  msg.status.resize(count);
+  for (auto & status : msg.status) {
+    if (!decodeStatus(topic_id, status)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ArchiveReader::decodeStatus(std::uint64_t topic, DiagnosticStatus & status)
+{
+  std::uint64_t name;
+  std::uint8_t flags;
+  if (!getRef(names_, name) || !cursor_.getByte(flags)) {
+    return false;
+  }
+  std::vector<ar::StatusState> & states = states_[topic];
+  if (name >= states.size()) {
+    states.resize(name + 1);
+  }
+  ar::StatusState & state = states[name];
+
+  if ((flags & ar::Status_Level) && !cursor_.getByte(state.level)) {
+    return false;
+  }
+  if ((flags & ar::Status_Message) && !getRef(texts_, state.message)) {
+    return false;
+  }
+  if ((flags & ar::Status_HardwareId) && !getRef(texts_, state.hardware_id)) {
+    return false;
+  }
+  if (flags & ar::Status_Keys) {
+    std::uint64_t count;
+    if (!cursor_.getVarint(count) || count > payload_.size() / 2) {
+      return false;
+    }
+    state.keys.resize(count);
+    for (auto & key : state.keys) {
+      if (!getRef(keys_, key)) {
+        return false;
+      }
+    }
+    state.values.assign(count, ar::ValueState());
+  }
+  if (state.message >= texts_.size() || state.hardware_id >= texts_.size()) {
+    return false;
+  }
+
+  status.name = names_[name];
+  status.level = state.level;
+  status.message = texts_[state.message];
+  status.hardware_id = texts_[state.hardware_id];
+  status.values.resize(state.keys.size());
+  for (std::size_t i = 0; i < state.keys.size(); ++i) {
+    ar::ValueState & value = state.values[i];
+    std::uint8_t type;
+    if (!cursor_.getByte(type)) {
+      return false;
+    }
+    if (type == ar::Value_Decimal) {
+      std::uint8_t scale;
+      std::uint64_t delta;
+      if (!cursor_.getByte(scale) || !cursor_.getVarint(delta)) {
+        return false;
+      }
+      std::int64_t base = value.decimal && value.scale == scale ? value.mantissa : 0;
+      value.decimal = true;
+      value.scale = scale;
+      value.mantissa = base + ar::unzigzag(delta);
+      value.text = ar::formatDecimal(value.mantissa, scale);
+    } else if (type == ar::Value_Text) {
+      std::uint64_t id;
+      if (!getRef(values_, id)) {
+        return false;
+      }
+      value.decimal = false;
+      value.text = values_[id];
+    } else if (type != ar::Value_Same) {
+      return false;
+    }
+    status.values[i].key = keys_[state.keys[i]];
+    status.values[i].value = value.text;
+  }
+  return true;
+}
+
+}  // namespace diagnostic_aggregator
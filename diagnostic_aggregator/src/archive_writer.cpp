@@ -0,0 +1,311 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/archive_writer.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace diagnostic_aggregator
+{
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace ar = archive;
+namespace fr = flight_recorder;
+
+namespace
+{
+/// Writes the reference of value, and the value itself if it is new in the block
+std::uint64_t putRef(
+  std::string & out, std::unordered_map<std::string, std::uint64_t> & dictionary,
+  const std::string & value)
+{
+  auto result = dictionary.emplace(value, dictionary.size());
+  fr::putVarint(out, result.first->second);
+  if (result.second) {
+    fr::putString(out, value);
+  }
+  return result.first->second;
+}
+}  // namespace
+
+ArchiveWriter::ArchiveWriter(std::size_t block_size)
+: logger_(rclcpp::get_logger("ArchiveWriter")),
+  fd_(-1),
+  block_size_(block_size),
+  offset_(0),
+  message_count_(0),
+  first_stamp_(0),
+  last_stamp_(0)
+{
+}
+
+ArchiveWriter::~ArchiveWriter()
+{
+  close();
+}
+
+bool ArchiveWriter::open(const std::string & file)
+{
+  close();
+
+  fd_ = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd_ < 0) {
+    RCLCPP_ERROR(logger_, "Couldn't create archive '%s': %s", file.c_str(), strerror(errno));
+    return false;
+  }
+  offset_ = 0;
+  index_.clear();
+
+  ar::FileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, ar::kFileMagic, sizeof(header.magic));
+  header.version = ar::kVersion;
+  if (!append(&header, sizeof(header))) {
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  return true;
+}
+
+bool ArchiveWriter::write(
+  const std::string & topic, const rclcpp::Time & stamp, const DiagnosticArray & msg)
+{
+  if (fd_ < 0) {
+    return false;
+  }
+
+  const std::int64_t ns = stamp.nanoseconds();
+  if (message_count_ == 0) {
+    first_stamp_ = ns;
+    last_stamp_ = 0;
+  }
+
+  std::uint64_t topic_id = putRef(block_, topics_, topic);
+  if (topic_id >= states_.size()) {
+    states_.resize(topic_id + 1);
+  }
+  fr::putVarint(block_, ar::zigzag(ns - last_stamp_));
+  fr::putVarint(block_, ar::zigzag(rclcpp::Time(msg.header.stamp).nanoseconds() - ns));
+  putRef(block_, texts_, msg.header.frame_id);
+  fr::putVarint(block_, msg.status.size());
+  for (const auto & status : msg.status) {
+    encodeStatus(topic_id, status);
+  }
+
+  last_stamp_ = ns;
+  ++message_count_;
+  if (block_.size() >= block_size_) {
+    return flush();
+  }
+  return true;
+}
+
+void ArchiveWriter::encodeStatus(std::uint64_t topic, const DiagnosticStatus & status)
+{
+  std::uint64_t name = putRef(block_, names_, status.name);
+  std::vector<ar::StatusState> & states = states_[topic];
+  if (name >= states.size()) {
+    states.resize(name + 1);
+  }
+  ar::StatusState & state = states[name];
+
+  // The flags are only known once the references are, so they are encoded separately
+  std::string fields;
+  std::uint8_t flags = 0;
+  if (status.level != state.level) {
+    flags |= ar::Status_Level;
+    fields.push_back(static_cast<char>(status.level));
+    state.level = status.level;
+  }
+
+  auto text = texts_.find(status.message);
+  if (text == texts_.end() || text->second != state.message) {
+    flags |= ar::Status_Message;
+    state.message = putRef(fields, texts_, status.message);
+  }
+  text = texts_.find(status.hardware_id);
+  if (text == texts_.end() || text->second != state.hardware_id) {
+    flags |= ar::Status_HardwareId;
+    state.hardware_id = putRef(fields, texts_, status.hardware_id);
+  }
+
+  bool same_keys = status.values.size() == state.keys.size();
+  for (std::size_t i = 0; same_keys && i < status.values.size(); ++i) {
+    auto key = keys_.find(status.values[i].key);
+    same_keys = key != keys_.end() && key->second == state.keys[i];
+  }
+  if (!same_keys) {
+    flags |= ar::Status_Keys;
+    fr::putVarint(fields, status.values.size());
+    state.keys.clear();
+    for (const auto & kv : status.values) {
+      state.keys.push_back(putRef(fields, keys_, kv.key));
+    }
+    // New keys start without a previous value
+    state.values.assign(status.values.size(), ar::ValueState());
+  }
+
+  for (std::size_t i = 0; i < status.values.size(); ++i) {
+    const std::string & value = status.values[i].value;
+    ar::ValueState & previous = state.values[i];
+    if (value == previous.text) {
+      fields.push_back(static_cast<char>(ar::Value_Same));
+      continue;
+    }
+
+    std::int64_t mantissa;
+    std::uint8_t scale;
+    if (ar::parseDecimal(value, mantissa, scale)) {
+      std::int64_t base = previous.decimal && previous.scale == scale ? previous.mantissa : 0;
+      fields.push_back(static_cast<char>(ar::Value_Decimal));
+      fields.push_back(static_cast<char>(scale));
+      fr::putVarint(fields, ar::zigzag(mantissa - base));
+      previous.decimal = true;
+      previous.scale = scale;
+      previous.mantissa = mantissa;
+    } else {
+      fields.push_back(static_cast<char>(ar::Value_Text));
+      putRef(fields, values_, value);
+      previous.decimal = false;
+    }
+    previous.text = value;
+  }
+
+  block_.push_back(static_cast<char>(flags));
+  block_.append(fields);
+}
+
+bool ArchiveWriter::flush()
+{
+  if (message_count_ == 0) {
+    return true;
+  }
+
+  ar::BlockHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.magic = ar::kBlockMagic;
+  header.raw_size = static_cast<std::uint32_t>(block_.size());
+  header.message_count = message_count_;
+  header.first_stamp = first_stamp_;
+  header.last_stamp = last_stamp_;
+
+  std::vector<Bytef> compressed(compressBound(block_.size()));
+  uLongf compressed_size = compressed.size();
+  const Bytef * payload = reinterpret_cast<const Bytef *>(block_.data());
+  if (compress2(
+      compressed.data(), &compressed_size, payload, block_.size(),
+      Z_DEFAULT_COMPRESSION) == Z_OK && compressed_size < block_.size())
+  {
+    header.compression = ar::Compression_Zlib;
+    header.stored_size = static_cast<std::uint32_t>(compressed_size);
+    payload = compressed.data();
+  } else {
+    header.compression = ar::Compression_None;
+    header.stored_size = header.raw_size;
+  }
+  header.crc = static_cast<std::uint32_t>(crc32(0L, payload, header.stored_size));
+
+  ar::IndexEntry entry;
+  entry.offset = offset_;
+  entry.first_stamp = first_stamp_;
+  entry.last_stamp = last_stamp_;
+  entry.message_count = message_count_;
+
+  bool written = append(&header, sizeof(header)) && append(payload, header.stored_size);
+  if (written) {
+    index_.push_back(entry);
+  }
+
+  // The next block starts from scratch, so it can be decoded on its own
+  block_.clear();
+  message_count_ = 0;
+  topics_.clear();
+  names_.clear();
+  keys_.clear();
+  texts_.clear();
+  values_.clear();
+  states_.clear();
+  return written;
+}
+
+bool ArchiveWriter::close()
+{
+  if (fd_ < 0) {
+    return true;
+  }
+
+  bool written = flush();
+  ar::Footer footer;
+  std::memset(&footer, 0, sizeof(footer));
+  footer.index_offset = offset_;
+  footer.block_count = index_.size();
+  std::memcpy(footer.magic, ar::kFooterMagic, sizeof(footer.magic));
+  written = written &&
+    append(index_.data(), index_.size() * sizeof(ar::IndexEntry)) &&
+    append(&footer, sizeof(footer));
+
+  ::close(fd_);
+  fd_ = -1;
+  return written;
+}
+
+bool ArchiveWriter::append(const void * data, std::size_t size)
+{
+  const char * bytes = static_cast<const char *>(data);
+  while (size > 0) {
+    ssize_t written = ::write(fd_, bytes, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      RCLCPP_ERROR(logger_, "Couldn't write archive: %s", strerror(errno));
+      return false;
+    }
+    bytes += written;
+    size -= written;
+    offset_ += written;
+  }
+  return true;
+}
+
+}  // namespace diagnostic_aggregator
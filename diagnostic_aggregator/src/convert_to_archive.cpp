@@ -0,0 +1,120 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "diagnostic_aggregator/archive_writer.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+
+#include "rosbag2_cpp/reader.hpp"
+
+/*!
+ * Converts the diagnostics topics of a rosbag2 recording into an archive.
+ *
+ * Usage: convert_to_archive BAG OUTPUT [TOPIC...]
+ * TOPIC defaults to /diagnostics and /diagnostics_agg.
+ */
+int main(int argc, char ** argv)
+{
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " BAG OUTPUT [TOPIC...]" << std::endl;
+    return 1;
+  }
+
+  std::set<std::string> topics;
+  for (int i = 3; i < argc; ++i) {
+    topics.insert(argv[i]);
+  }
+  if (topics.empty()) {
+    topics = {"/diagnostics", "/diagnostics_agg"};
+  }
+
+  rosbag2_cpp::Reader reader;
+  try {
+    reader.open(argv[1]);
+  } catch (const std::exception & e) {
+    std::cerr << "Couldn't open bag '" << argv[1] << "': " << e.what() << std::endl;
+    return 1;
+  }
+
+  diagnostic_aggregator::ArchiveWriter writer;
+  if (!writer.open(argv[2])) {
+    return 1;
+  }
+
+  rclcpp::Serialization<diagnostic_msgs::msg::DiagnosticArray> serialization;
+  diagnostic_msgs::msg::DiagnosticArray msg;
+  std::size_t messages = 0;
+  std::size_t input_size = 0;
+  while (reader.has_next()) {
+    auto bag_msg = reader.read_next();
+    if (topics.count(bag_msg->topic_name) == 0) {
+      continue;
+    }
+
+    rclcpp::SerializedMessage serialized(*bag_msg->serialized_data);
+    try {
+      serialization.deserialize_message(&serialized, &msg);
+    } catch (const std::exception & e) {
+      std::cerr << "Skipping a message on " << bag_msg->topic_name << ": " << e.what() <<
+        std::endl;
+      continue;
+    }
+    if (!writer.write(
+        bag_msg->topic_name, rclcpp::Time(bag_msg->recv_timestamp, RCL_ROS_TIME), msg))
+    {
+      return 1;
+    }
+    ++messages;
+    input_size += bag_msg->serialized_data->buffer_length;
+  }
+
+  if (!writer.close()) {
+    return 1;
+  }
+
+  std::cout << "Converted " << messages << " messages, " << input_size << " bytes serialized, " <<
+    writer.getFileSize() << " bytes archived (" <<
+    static_cast<double>(input_size) / writer.getFileSize() << "x)" << std::endl;
+  return 0;
+}
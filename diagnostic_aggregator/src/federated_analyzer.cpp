@@ -0,0 +1,185 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/federated_analyzer.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace diagnostic_aggregator
+{
+FederatedAnalyzer::FederatedAnalyzer()
+: timeout_(5, 0),
+  received_(false),
+  warned_(false)
+{
+  RCLCPP_DEBUG(rclcpp::get_logger("FederatedAnalyzer"), "constructor");
+}
+
+FederatedAnalyzer::~FederatedAnalyzer()
+{
+  RCLCPP_DEBUG(rclcpp::get_logger("FederatedAnalyzer"), "destructor");
+}
+
+bool FederatedAnalyzer::init(
+  const std::string & base_path, const std::string & name, double timeout)
+{
+  nice_name_ = name;
+  path_ = base_path + "/" + name;
+  timeout_ = rclcpp::Duration::from_seconds(timeout);
+  return true;
+}
+
+bool FederatedAnalyzer::init(
+  const std::string & base_path, const std::string & breadcrumb,
+  const rclcpp::Node::SharedPtr node)
+{
+  (void)base_path;
+  (void)breadcrumb;
+  (void)node;
+
+  RCLCPP_ERROR(
+    rclcpp::get_logger("FederatedAnalyzer"),
+    "FederatedAnalyzer was attempted to initialize with a node. "
+    "This analyzer cannot be used as a plugin.");
+  return false;
+}
+
+uint8_t FederatedAnalyzer::update(const diagnostic_msgs::msg::DiagnosticArray & msg)
+{
+  return update(msg, clock_->now());
+}
+
+uint8_t FederatedAnalyzer::update(
+  const diagnostic_msgs::msg::DiagnosticArray & msg, const rclcpp::Time & now)
+{
+  uint8_t max_level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+  for (const auto & status : msg.status) {
+    Entry & entry = statuses_[status.name];
+    if (!entry.status) {
+      entry.status = std::make_shared<diagnostic_msgs::msg::DiagnosticStatus>();
+      // Toplevel statuses of the child have no other slash than the leading one
+      entry.toplevel = status.name.find('/', 1) == std::string::npos;
+    } else {
+      if (!warned_ && now - entry.last_update > timeout_) {
+        // The status was reported stale in between, see report()
+        warned_ = true;
+        RCLCPP_WARN(
+          rclcpp::get_logger("FederatedAnalyzer"),
+          "Child aggregator '%s' sent '%s' after %.3f s, more than the federation.timeout "
+          "of %.3f s. Set the timeout above the longest period of the child.",
+          nice_name_.c_str(), status.name.c_str(), (now - entry.last_update).seconds(),
+          timeout_.seconds());
+      }
+      if (entry.status.use_count() > 1) {
+        // The last report still holds it, don't change it below its feet
+        entry.status = std::make_shared<diagnostic_msgs::msg::DiagnosticStatus>();
+      }
+    }
+    *entry.status = status;
+    entry.status->name = path_ + status.name;
+    entry.stale.reset();
+    entry.last_update = now;
+    max_level = std::max(max_level, status.level);
+  }
+  last_update_ = now;
+  received_ = true;
+  return max_level;
+}
+
+bool FederatedAnalyzer::match(const std::string & name)
+{
+  (void)name;
+  return false;
+}
+
+bool FederatedAnalyzer::analyze(const std::shared_ptr<StatusItem> item)
+{
+  (void)item;
+  return false;
+}
+
+std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> FederatedAnalyzer::report()
+{
+  RCLCPP_DEBUG(
+    rclcpp::get_logger("FederatedAnalyzer"), "Analyzer '%s' report()", nice_name_.c_str());
+  rclcpp::Time now = clock_->now();
+  bool silent = !received_ || now - last_update_ > timeout_;
+
+  auto header_status = std::make_shared<diagnostic_msgs::msg::DiagnosticStatus>();
+  header_status->name = path_;
+  header_status->level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+
+  std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> processed;
+  processed.reserve(statuses_.size() + 1);
+  bool all_stale = true;
+  for (auto & named : statuses_) {
+    Entry & entry = named.second;
+    // Statuses the child didn't send within the timeout are stale, whether the
+    // child is silent or stopped sending them
+    if (now - entry.last_update > timeout_ && !entry.stale) {
+      entry.stale = std::make_shared<diagnostic_msgs::msg::DiagnosticStatus>(*entry.status);
+      entry.stale->level = diagnostic_msgs::msg::DiagnosticStatus::STALE;
+    }
+
+    const auto & status = entry.stale ? entry.stale : entry.status;
+    processed.push_back(status);
+    if (entry.toplevel) {
+      diagnostic_msgs::msg::KeyValue kv;
+      kv.key = named.first.substr(1);
+      kv.value = status->message;
+      header_status->values.push_back(kv);
+      header_status->level = std::max(header_status->level, status->level);
+      all_stale = all_stale && status->level == diagnostic_msgs::msg::DiagnosticStatus::STALE;
+    }
+  }
+
+  if (silent) {
+    header_status->level = diagnostic_msgs::msg::DiagnosticStatus::STALE;
+    header_status->message = received_ ? "No update from child aggregator" : "No data";
+  } else {
+    // Report stale as errors unless all stale
+    if (header_status->level == diagnostic_msgs::msg::DiagnosticStatus::STALE && !all_stale) {
+      header_status->level = diagnostic_msgs::msg::DiagnosticStatus::ERROR;
+    }
+    header_status->message = valToMsg(header_status->level);
+  }
+  processed.push_back(header_status);
+
+  return processed;
+}
+
+}  // namespace diagnostic_aggregator
@@ -0,0 +1,87 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/flap_damper.hpp"
+
+#include <algorithm>
+
+namespace diagnostic_aggregator
+{
+FlapDamper::FlapDamper(double dwell, double window, int max_flaps)
+: dwell_(static_cast<std::int64_t>(dwell * 1e9)),
+  window_(static_cast<std::int64_t>(window * 1e9)),
+  max_flaps_(max_flaps > 0 ? max_flaps : 0),
+  initialized_(false),
+  flapping_(false),
+  received_(0),
+  reported_(0),
+  changed_(0),
+  total_flaps_(0)
+{
+}
+
+std::uint8_t FlapDamper::update(const rclcpp::Time & stamp, std::uint8_t level)
+{
+  std::int64_t now = stamp.nanoseconds();
+  if (!initialized_) {
+    initialized_ = true;
+    received_ = level;
+    reported_ = level;
+    changed_ = now;
+    return level;
+  }
+
+  while (!flaps_.empty() && flaps_.front() <= now - window_) {
+    flaps_.pop_front();
+  }
+  if (level != received_) {
+    received_ = level;
+    changed_ = now;
+    flaps_.push_back(now);
+    ++total_flaps_;
+  }
+
+  if (max_flaps_ > 0 && flaps_.size() >= max_flaps_) {
+    flapping_ = true;
+  } else if (flaps_.empty()) {
+    flapping_ = false;
+  }
+
+  if (level > reported_ || (!flapping_ && now - changed_ >= dwell_)) {
+    reported_ = level;
+  }
+  return reported_;
+}
+
+}  // namespace diagnostic_aggregator
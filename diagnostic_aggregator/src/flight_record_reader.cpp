@@ -0,0 +1,297 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/flight_record_reader.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace diagnostic_aggregator
+{
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace fr = flight_recorder;
+
+FlightRecordReader::FlightRecordReader()
+: logger_(rclcpp::get_logger("FlightRecordReader")),
+  fd_(-1),
+  data_(nullptr),
+  file_size_(0),
+  segment_size_(0),
+  segment_count_(0)
+{
+}
+
+FlightRecordReader::~FlightRecordReader()
+{
+  close();
+}
+
+bool FlightRecordReader::open(const std::string & file)
+{
+  close();
+
+  fd_ = ::open(file.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    RCLCPP_ERROR(logger_, "Couldn't open flight record '%s': %s", file.c_str(), strerror(errno));
+    return false;
+  }
+
+  struct stat st;
+  fr::FileHeader header;
+  if (fstat(fd_, &st) != 0 ||
+    pread(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+    std::memcmp(header.magic, fr::kFileMagic, sizeof(header.magic)) != 0 ||
+    header.version != fr::kVersion)
+  {
+    RCLCPP_ERROR(logger_, "'%s' is not a flight record.", file.c_str());
+    close();
+    return false;
+  }
+
+  segment_size_ = header.segment_size;
+  segment_count_ = header.segment_count;
+  file_size_ = sizeof(fr::FileHeader) + segment_size_ * segment_count_;
+  if (static_cast<std::uint64_t>(st.st_size) < file_size_) {
+    RCLCPP_ERROR(logger_, "Flight record '%s' is truncated.", file.c_str());
+    close();
+    return false;
+  }
+
+  void * data = mmap(nullptr, file_size_, PROT_READ, MAP_SHARED, fd_, 0);
+  if (data == MAP_FAILED) {
+    RCLCPP_ERROR(logger_, "Couldn't map flight record '%s': %s", file.c_str(), strerror(errno));
+    close();
+    return false;
+  }
+  data_ = static_cast<const std::uint8_t *>(data);
+  return true;
+}
+
+void FlightRecordReader::close()
+{
+  if (data_ != nullptr) {
+    munmap(const_cast<std::uint8_t *>(data_), file_size_);
+    data_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+const fr::SegmentHeader * FlightRecordReader::segmentHeader(std::uint64_t index) const
+{
+  return reinterpret_cast<const fr::SegmentHeader *>(
+    data_ + sizeof(fr::FileHeader) + index * segment_size_);
+}
+
+std::vector<FlightRecordReader::Segment> FlightRecordReader::getSegments() const
+{
+  std::vector<Segment> segments;
+  if (data_ == nullptr) {
+    return segments;
+  }
+
+  for (std::uint64_t i = 0; i < segment_count_; ++i) {
+    Segment segment;
+    segment.index = i;
+    std::memcpy(&segment.header, segmentHeader(i), sizeof(segment.header));
+    if (segment.header.magic == fr::kSegmentMagic && segment.header.sequence > 0) {
+      segments.push_back(segment);
+    }
+  }
+
+  // Oldest first, the keyframe stamps grow with the sequence number
+  std::sort(
+    segments.begin(), segments.end(), [](const Segment & a, const Segment & b) {
+      return a.header.sequence < b.header.sequence;
+    });
+  return segments;
+}
+
+bool FlightRecordReader::getTimeRange(rclcpp::Time & first, rclcpp::Time & last) const
+{
+  std::vector<Segment> segments = getSegments();
+  if (segments.empty()) {
+    return false;
+  }
+
+  first = rclcpp::Time(segments.front().header.first_stamp, RCL_ROS_TIME);
+  last = rclcpp::Time(segments.back().header.last_stamp, RCL_ROS_TIME);
+  return true;
+}
+
+bool FlightRecordReader::getTreeAt(const rclcpp::Time & stamp, DiagnosticArray & tree) const
+{
+  const std::int64_t ns = stamp.nanoseconds();
+  std::vector<Segment> segments = getSegments();
+
+  // Newest segment whose keyframe is not after the requested time
+  auto it = std::upper_bound(
+    segments.begin(), segments.end(), ns, [](std::int64_t value, const Segment & segment) {
+      return value < segment.header.first_stamp;
+    });
+  if (it == segments.begin()) {
+    RCLCPP_DEBUG(logger_, "Requested time is older than the flight record.");
+    return false;
+  }
+  const Segment & segment = *(--it);
+
+  // Copy the committed part, then make sure the writer didn't reuse the
+  // segment while we were copying.
+  const fr::SegmentHeader * header = segmentHeader(segment.index);
+  std::uint64_t used = std::min<std::uint64_t>(
+    header->used, segment_size_ - sizeof(fr::SegmentHeader));
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const std::uint8_t * payload = reinterpret_cast<const std::uint8_t *>(header + 1);
+  std::vector<std::uint8_t> buffer(payload, payload + used);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (header->sequence != segment.header.sequence) {
+    RCLCPP_DEBUG(logger_, "Segment was overwritten while reading.");
+    return false;
+  }
+
+  tree.status.clear();
+  tree.header.stamp = stamp;
+  return decode(buffer, ns, tree);
+}
+
+bool FlightRecordReader::decode(
+  const std::vector<std::uint8_t> & payload, std::int64_t stamp, DiagnosticArray & tree) const
+{
+  std::vector<std::string> names;
+  std::vector<DiagnosticStatus> states;
+  std::vector<bool> present;
+  bool in_keyframe = false;
+
+  std::size_t pos = 0;
+  while (pos + 5 <= payload.size()) {
+    std::uint32_t size = 0;
+    for (int i = 3; i >= 0; --i) {
+      size = (size << 8) | payload[pos + i];
+    }
+    if (size == 0 || pos + 4 + size > payload.size()) {
+      RCLCPP_WARN(logger_, "Corrupt record in flight record, stopping at offset %zu.", pos);
+      break;
+    }
+
+    fr::RecordCursor cursor(payload.data() + pos + 5, size - 1);
+    const std::uint8_t type = payload[pos + 4];
+    pos += 4 + size;
+
+    std::uint64_t id = 0;
+    std::int64_t record_stamp = 0;
+    if (type == fr::Record_KeyframeBegin) {
+      in_keyframe = true;
+      continue;
+    }
+    if (type == fr::Record_KeyframeEnd) {
+      in_keyframe = false;
+      continue;
+    }
+    if (type == fr::Record_Name) {
+      std::string name;
+      if (!cursor.getVarint(id) || !cursor.getString(name)) {
+        return false;
+      }
+      if (id >= names.size()) {
+        names.resize(id + 1);
+        states.resize(id + 1);
+        present.resize(id + 1, false);
+      }
+      names[id] = name;
+      continue;
+    }
+
+    if (!cursor.getVarint(id) || !cursor.getFixed64(record_stamp) || id >= names.size()) {
+      return false;
+    }
+    if (!in_keyframe && record_stamp > stamp) {
+      break;  // Records are ordered by time within a segment
+    }
+
+    if (type == fr::Record_Remove) {
+      present[id] = false;
+    } else if (type == fr::Record_Status) {
+      DiagnosticStatus & status = states[id];
+      std::uint8_t level, flags;
+      std::uint64_t count, changed;
+      if (!cursor.getByte(level) || !cursor.getByte(flags)) {
+        return false;
+      }
+      status.level = level;
+      if ((flags & fr::Status_Message) && !cursor.getString(status.message)) {
+        return false;
+      }
+      if ((flags & fr::Status_HardwareId) && !cursor.getString(status.hardware_id)) {
+        return false;
+      }
+      if (!cursor.getVarint(count) || !cursor.getVarint(changed)) {
+        return false;
+      }
+      status.values.resize(count);
+      for (std::uint64_t i = 0; i < changed; ++i) {
+        std::uint64_t index;
+        if (!cursor.getVarint(index) || index >= count ||
+          !cursor.getString(status.values[index].key) ||
+          !cursor.getString(status.values[index].value))
+        {
+          return false;
+        }
+      }
+      present[id] = true;
+    }
+  }
+
+  for (std::size_t id = 0; id < names.size(); ++id) {
+    if (present[id]) {
+      tree.status.push_back(states[id]);
+      tree.status.back().name = names[id];
+    }
+  }
+  return true;
+}
+
+}  // namespace diagnostic_aggregator
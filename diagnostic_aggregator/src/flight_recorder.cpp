@@ -0,0 +1,438 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/flight_recorder.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace diagnostic_aggregator
+{
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace fr = flight_recorder;
+
+FlightRecorder::FlightRecorder(
+  const std::string & file, std::uint64_t segment_size, std::uint64_t segment_count)
+: logger_(rclcpp::get_logger("FlightRecorder")),
+  segment_size_(segment_size),
+  segment_count_(segment_count),
+  fd_(-1),
+  data_(nullptr),
+  open_(false),
+  file_size_(0),
+  segment_(0),
+  sequence_(0),
+  segment_open_(false),
+  max_queue_(64),
+  busy_(false),
+  running_(true),
+  dropped_(0)
+{
+  if (segment_size_ < 4096 || segment_count_ < 2) {
+    RCLCPP_ERROR(
+      logger_, "Flight recorder needs at least 2 segments of 4096 bytes, got %lu of %lu bytes.",
+      static_cast<unsigned long>(segment_count_), static_cast<unsigned long>(segment_size_));
+    return;
+  }
+  segment_size_ -= segment_size_ % 8;
+
+  if (!open(file)) {
+    close();
+    return;
+  }
+  RCLCPP_INFO(
+    logger_, "Recording aggregated diagnostics to '%s' (%lu segments of %lu bytes).",
+    file.c_str(), static_cast<unsigned long>(segment_count_),
+    static_cast<unsigned long>(segment_size_));
+
+  open_ = true;
+  thread_ = std::thread(&FlightRecorder::run, this);
+}
+
+FlightRecorder::~FlightRecorder()
+{
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    running_ = false;
+  }
+  queue_cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  close();
+}
+
+bool FlightRecorder::open(const std::string & file)
+{
+  fd_ = ::open(file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    RCLCPP_ERROR(
+      logger_, "Couldn't open flight recorder file '%s': %s", file.c_str(), strerror(errno));
+    return false;
+  }
+
+  file_size_ = sizeof(fr::FileHeader) + segment_size_ * segment_count_;
+
+  // Continue an existing recording if it has the same geometry
+  bool reuse = false;
+  struct stat st;
+  if (fstat(fd_, &st) == 0 && static_cast<std::uint64_t>(st.st_size) == file_size_) {
+    fr::FileHeader header;
+    if (pread(fd_, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))) {
+      reuse = std::memcmp(header.magic, fr::kFileMagic, sizeof(header.magic)) == 0 &&
+        header.version == fr::kVersion && header.segment_size == segment_size_ &&
+        header.segment_count == segment_count_;
+    }
+  }
+
+  if (!reuse) {
+    if (ftruncate(fd_, 0) != 0 || ftruncate(fd_, file_size_) != 0) {
+      RCLCPP_ERROR(
+        logger_, "Couldn't resize flight recorder file '%s': %s", file.c_str(), strerror(errno));
+      return false;
+    }
+  }
+
+  void * data = mmap(nullptr, file_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (data == MAP_FAILED) {
+    RCLCPP_ERROR(
+      logger_, "Couldn't map flight recorder file '%s': %s", file.c_str(), strerror(errno));
+    return false;
+  }
+  data_ = static_cast<std::uint8_t *>(data);
+
+  if (reuse) {
+    for (std::uint64_t i = 0; i < segment_count_; ++i) {
+      const fr::SegmentHeader * header = segmentHeader(i);
+      if (header->magic == fr::kSegmentMagic && header->sequence > sequence_) {
+        sequence_ = header->sequence;
+        segment_ = i;
+      }
+    }
+    RCLCPP_INFO(
+      logger_, "Continuing flight recording '%s' after segment %lu.", file.c_str(),
+      static_cast<unsigned long>(sequence_));
+  } else {
+    fr::FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, fr::kFileMagic, sizeof(header.magic));
+    header.version = fr::kVersion;
+    header.segment_size = segment_size_;
+    header.segment_count = segment_count_;
+    std::memcpy(data_, &header, sizeof(header));
+    segment_ = segment_count_ - 1;
+  }
+
+  return true;
+}
+
+void FlightRecorder::close()
+{
+  // record() checks isOpen() from other threads, data_ is only used by the writer
+  open_ = false;
+  if (data_ != nullptr) {
+    msync(data_, file_size_, MS_SYNC);
+    munmap(data_, file_size_);
+    data_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+void FlightRecorder::record(std::shared_ptr<const DiagnosticArray> tree)
+{
+  if (!isOpen()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (queue_.size() >= max_queue_) {
+      dropped_++;
+      return;
+    }
+    queue_.push_back(std::move(tree));
+  }
+  queue_cv_.notify_one();
+}
+
+void FlightRecorder::flush()
+{
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  idle_cv_.wait(lock, [this] {return (queue_.empty() && !busy_) || !thread_.joinable();});
+}
+
+void FlightRecorder::run()
+{
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  while (true) {
+    queue_cv_.wait(lock, [this] {return !queue_.empty() || !running_;});
+    if (queue_.empty()) {
+      break;  // Only stop once everything queued is written
+    }
+
+    auto tree = std::move(queue_.front());
+    queue_.pop_front();
+    busy_ = true;
+    lock.unlock();
+
+    if (isOpen()) {
+      process(*tree);
+    }
+    tree.reset();
+
+    lock.lock();
+    busy_ = false;
+    idle_cv_.notify_all();
+  }
+  idle_cv_.notify_all();
+}
+
+void FlightRecorder::process(const DiagnosticArray & tree)
+{
+  const std::int64_t stamp = rclcpp::Time(tree.header.stamp).nanoseconds();
+
+  pending_.clear();
+  for (auto & entry : entries_) {
+    entry.seen = false;
+  }
+
+  for (const auto & status : tree.status) {
+    std::uint32_t id = getId(status.name);
+    Entry & entry = entries_[id];
+    entry.seen = true;
+
+    if (!entry.present) {
+      // Named again when it comes back, the segment of its first name may be gone
+      encodeName(pending_, id, entry.name);
+      encodeStatus(pending_, id, stamp, status, nullptr);
+    } else if (entry.status != status) {
+      encodeStatus(pending_, id, stamp, status, &entry.status);
+    } else {
+      continue;
+    }
+    entry.status = status;
+    entry.present = true;
+  }
+
+  // Items that are no longer reported, e.g. discarded stale items
+  for (std::uint32_t id = 0; id < entries_.size(); ++id) {
+    Entry & entry = entries_[id];
+    if (entry.present && !entry.seen) {
+      std::size_t start = beginRecord(pending_, fr::Record_Remove);
+      fr::putVarint(pending_, id);
+      fr::putFixed64(pending_, stamp);
+      endRecord(pending_, start);
+      entry.present = false;
+    }
+  }
+
+  if (!append(pending_, stamp)) {
+    close();
+  }
+}
+
+std::uint32_t FlightRecorder::getId(const std::string & name)
+{
+  auto it = ids_.find(name);
+  if (it != ids_.end()) {
+    return it->second;
+  }
+
+  std::uint32_t id = static_cast<std::uint32_t>(entries_.size());
+  ids_.emplace(name, id);
+  entries_.emplace_back();
+  entries_.back().name = name;
+  return id;
+}
+
+void FlightRecorder::encodeName(std::string & out, std::uint32_t id, const std::string & name)
+{
+  std::size_t start = beginRecord(out, fr::Record_Name);
+  fr::putVarint(out, id);
+  fr::putString(out, name);
+  endRecord(out, start);
+}
+
+void FlightRecorder::encodeStatus(
+  std::string & out, std::uint32_t id, std::int64_t stamp, const DiagnosticStatus & status,
+  const DiagnosticStatus * previous)
+{
+  std::size_t start = beginRecord(out, fr::Record_Status);
+  fr::putVarint(out, id);
+  fr::putFixed64(out, stamp);
+  out.push_back(static_cast<char>(status.level));
+
+  std::uint8_t flags = 0;
+  if (!previous || previous->message != status.message) {
+    flags |= fr::Status_Message;
+  }
+  if (!previous || previous->hardware_id != status.hardware_id) {
+    flags |= fr::Status_HardwareId;
+  }
+  out.push_back(static_cast<char>(flags));
+  if (flags & fr::Status_Message) {
+    fr::putString(out, status.message);
+  }
+  if (flags & fr::Status_HardwareId) {
+    fr::putString(out, status.hardware_id);
+  }
+
+  // KeyValues are diffed by position, which keeps their order and duplicate keys
+  fr::putVarint(out, status.values.size());
+  std::size_t changed = 0;
+  for (std::size_t i = 0; i < status.values.size(); ++i) {
+    if (!previous || i >= previous->values.size() || previous->values[i] != status.values[i]) {
+      changed++;
+    }
+  }
+  fr::putVarint(out, changed);
+  for (std::size_t i = 0; i < status.values.size(); ++i) {
+    if (!previous || i >= previous->values.size() || previous->values[i] != status.values[i]) {
+      fr::putVarint(out, i);
+      fr::putString(out, status.values[i].key);
+      fr::putString(out, status.values[i].value);
+    }
+  }
+  endRecord(out, start);
+}
+
+std::size_t FlightRecorder::beginRecord(std::string & out, fr::RecordType type)
+{
+  std::size_t start = out.size();
+  out.append(4, '\0');
+  out.push_back(static_cast<char>(type));
+  return start;
+}
+
+void FlightRecorder::endRecord(std::string & out, std::size_t start)
+{
+  std::uint32_t size = static_cast<std::uint32_t>(out.size() - start - 4);
+  for (int i = 0; i < 4; ++i) {
+    out[start + i] = static_cast<char>((size >> (8 * i)) & 0xff);
+  }
+}
+
+void FlightRecorder::encodeKeyframe(std::string & out, std::int64_t stamp) const
+{
+  out.clear();
+  std::size_t start = beginRecord(out, fr::Record_KeyframeBegin);
+  fr::putFixed64(out, stamp);
+  endRecord(out, start);
+
+  for (std::uint32_t id = 0; id < entries_.size(); ++id) {
+    const Entry & entry = entries_[id];
+    if (entry.present) {
+      encodeName(out, id, entry.name);
+      encodeStatus(out, id, stamp, entry.status, nullptr);
+    }
+  }
+
+  start = beginRecord(out, fr::Record_KeyframeEnd);
+  fr::putFixed64(out, stamp);
+  endRecord(out, start);
+}
+
+fr::SegmentHeader * FlightRecorder::segmentHeader(std::uint64_t index)
+{
+  return reinterpret_cast<fr::SegmentHeader *>(
+    data_ + sizeof(fr::FileHeader) + index * segment_size_);
+}
+
+bool FlightRecorder::append(const std::string & records, std::int64_t stamp)
+{
+  const std::uint64_t capacity = segment_size_ - sizeof(fr::SegmentHeader);
+  fr::SegmentHeader * header = segment_open_ ? segmentHeader(segment_) : nullptr;
+
+  if (header != nullptr && header->used + records.size() <= capacity)
+  {
+    std::uint8_t * payload = reinterpret_cast<std::uint8_t *>(header + 1);
+    std::memcpy(payload + header->used, records.data(), records.size());
+    std::atomic_thread_fence(std::memory_order_release);
+    header->last_stamp = stamp;
+    header->used += records.size();
+    return true;
+  }
+
+  // Current segment is full (or this is the first tree), the keyframe of the
+  // next segment already contains the state after this tree.
+  if (header != nullptr) {
+    msync(header, segment_size_, MS_ASYNC);
+  }
+  return startSegment((segment_ + 1) % segment_count_, stamp);
+}
+
+bool FlightRecorder::startSegment(std::uint64_t index, std::int64_t stamp)
+{
+  encodeKeyframe(keyframe_, stamp);
+  if (keyframe_.size() > segment_size_ - sizeof(fr::SegmentHeader)) {
+    RCLCPP_ERROR(
+      logger_, "Keyframe of %zu bytes does not fit into a segment of %lu bytes. "
+      "Increase flight_recorder.segment_size, recording stopped.", keyframe_.size(),
+      static_cast<unsigned long>(segment_size_));
+    return false;
+  }
+
+  fr::SegmentHeader * header = segmentHeader(index);
+  header->sequence = 0;  // Invalidate the segment while it is rewritten
+  std::atomic_thread_fence(std::memory_order_release);
+
+  std::memcpy(header + 1, keyframe_.data(), keyframe_.size());
+  header->magic = fr::kSegmentMagic;
+  header->first_stamp = stamp;
+  header->last_stamp = stamp;
+  header->used = keyframe_.size();
+  std::atomic_thread_fence(std::memory_order_release);
+  header->sequence = ++sequence_;
+
+  segment_ = index;
+  segment_open_ = true;
+  return true;
+}
+
+}  // namespace diagnostic_aggregator
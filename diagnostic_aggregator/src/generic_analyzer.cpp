@@ -114,7 +114,7 @@ bool GenericAnalyzer::init(
         rclcpp::get_logger("GenericAnalyzer"), "GenericAnalyzer '%s' found expected: %s",
         nice_name_.c_str(), pvalue.value_to_string().c_str());
       for (auto exp : pvalue.as_string_array()) {
-        auto item = std::make_shared<StatusItem>(exp);
+        auto item = std::make_shared<StatusItem>(exp, "Missing", Level_Stale, clock_);
         this->addItem(exp, item);
       }
     } else if (pname.compare("regex") == 0) {
@@ -147,6 +147,31 @@ bool GenericAnalyzer::init(
         rclcpp::get_logger("GenericAnalyzer"), "GenericAnalyzer '%s' found discard_stale: %s",
         nice_name_.c_str(), pvalue.value_to_string().c_str());
       discard_stale = pvalue.as_bool();
+    } else if (pname.compare("statistics_window") == 0) {
+      RCLCPP_DEBUG(
+        rclcpp::get_logger("GenericAnalyzer"), "GenericAnalyzer '%s' found statistics_window: %s",
+        nice_name_.c_str(), pvalue.value_to_string().c_str());
+      statistics_window_ = pvalue.as_double();
+    } else if (pname.compare("statistics_keys") == 0) {
+      RCLCPP_DEBUG(
+        rclcpp::get_logger("GenericAnalyzer"), "GenericAnalyzer '%s' found statistics_keys: %s",
+        nice_name_.c_str(), pvalue.value_to_string().c_str());
+      statistics_keys_ = pvalue.as_string_array();
+    } else if (pname.compare("flap_dwell") == 0) {
+      RCLCPP_DEBUG(
+        rclcpp::get_logger("GenericAnalyzer"), "GenericAnalyzer '%s' found flap_dwell: %s",
+        nice_name_.c_str(), pvalue.value_to_string().c_str());
+      flap_dwell_ = pvalue.as_double();
+    } else if (pname.compare("flap_window") == 0) {
+      RCLCPP_DEBUG(
+        rclcpp::get_logger("GenericAnalyzer"), "GenericAnalyzer '%s' found flap_window: %s",
+        nice_name_.c_str(), pvalue.value_to_string().c_str());
+      flap_window_ = pvalue.as_double();
+    } else if (pname.compare("flap_max") == 0) {
+      RCLCPP_DEBUG(
+        rclcpp::get_logger("GenericAnalyzer"), "GenericAnalyzer '%s' found flap_max: %s",
+        nice_name_.c_str(), pvalue.value_to_string().c_str());
+      flap_max_ = static_cast<int>(pvalue.as_int());
     }
   }
 
@@ -0,0 +1,194 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/hardware_index.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace diagnostic_aggregator
+{
+HardwareIndex::HardwareIndex()
+: timeout_(0.0)
+{
+}
+
+DiagnosticLevel HardwareIndex::Device::getLevel() const
+{
+  // Like the analyzers, some stale items are an error, all of them are stale
+  if (level_counts[Level_Stale] > 0) {
+    return level_counts[Level_Stale] == items.size() ? Level_Stale : Level_Error;
+  }
+  for (int level = Level_Error; level > Level_OK; --level) {
+    if (level_counts[level] > 0) {
+      return static_cast<DiagnosticLevel>(level);
+    }
+  }
+  return Level_OK;
+}
+
+void HardwareIndex::update(const std::shared_ptr<StatusItem> item)
+{
+  const std::string & name = item->getName();
+  const std::string & hardware_id = item->getHwId();
+  DiagnosticLevel level = item->getLevel();
+  std::int64_t updated = item->getLastUpdateTime().nanoseconds();
+
+  auto known = items_.find(name);
+  if (known != items_.end()) {
+    if (known->second.hardware_id == hardware_id) {
+      Device & device = devices_[hardware_id];
+      device.level_counts[known->second.level]--;
+      device.level_counts[level]++;
+      device.items[name] = item;
+      updates_.erase(std::make_pair(known->second.updated, name));
+      updates_.emplace(updated, name);
+      known->second.level = level;
+      known->second.updated = updated;
+      return;
+    }
+
+    // The item moved to another device
+    remove(name, known->second);
+    items_.erase(known);
+  }
+
+  if (hardware_id.empty()) {
+    return;
+  }
+
+  Device & device = devices_[hardware_id];
+  device.level_counts[level]++;
+  device.items[name] = item;
+  updates_.emplace(updated, name);
+  items_.emplace(name, Indexed{hardware_id, level, updated});
+}
+
+void HardwareIndex::expire(const rclcpp::Time & now)
+{
+  if (timeout_ <= 0) {
+    return;
+  }
+
+  const std::int64_t oldest = now.nanoseconds() - static_cast<std::int64_t>(timeout_ * 1e9);
+  while (!updates_.empty() && updates_.begin()->first < oldest) {
+    Indexed & indexed = items_.at(updates_.begin()->second);
+    Device & device = devices_[indexed.hardware_id];
+    device.level_counts[indexed.level]--;
+    device.level_counts[Level_Stale]++;
+    indexed.level = Level_Stale;
+    updates_.erase(updates_.begin());
+  }
+}
+
+void HardwareIndex::remove(const std::string & name, const Indexed & indexed)
+{
+  updates_.erase(std::make_pair(indexed.updated, name));
+  auto device = devices_.find(indexed.hardware_id);
+  if (device == devices_.end()) {
+    return;
+  }
+
+  device->second.level_counts[indexed.level]--;
+  device->second.items.erase(name);
+  if (device->second.items.empty()) {
+    devices_.erase(device);
+  }
+}
+
+std::vector<std::shared_ptr<StatusItem>> HardwareIndex::lookup(
+  const std::string & hardware_id) const
+{
+  std::vector<std::shared_ptr<StatusItem>> items;
+  auto device = devices_.find(hardware_id);
+  if (device == devices_.end()) {
+    return items;
+  }
+
+  items.reserve(device->second.items.size());
+  for (const auto & item : device->second.items) {
+    items.push_back(item.second);
+  }
+  return items;
+}
+
+std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> HardwareIndex::report(
+  const std::string & path) const
+{
+  std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> processed;
+  processed.reserve(devices_.size() + 1);
+
+  auto header_status = std::make_shared<diagnostic_msgs::msg::DiagnosticStatus>();
+  header_status->name = path;
+  header_status->level = Level_OK;
+  processed.push_back(header_status);
+
+  std::size_t stale = 0;
+  for (const auto & device : devices_) {
+    DiagnosticLevel level = device.second.getLevel();
+    header_status->level = std::max<std::uint8_t>(header_status->level, level);
+    if (level == Level_Stale) {
+      ++stale;
+    }
+
+    auto status = std::make_shared<diagnostic_msgs::msg::DiagnosticStatus>();
+    status->name = path + "/" + getOutputName(device.first);
+    status->level = level;
+    status->message = valToMsg(level);
+    status->hardware_id = device.first;
+    for (int i = Level_OK; i <= Level_Stale; ++i) {
+      diagnostic_msgs::msg::KeyValue kv;
+      kv.key = valToMsg(i);
+      kv.value = std::to_string(device.second.level_counts[i]);
+      status->values.push_back(kv);
+    }
+    processed.push_back(status);
+
+    diagnostic_msgs::msg::KeyValue kv;
+    kv.key = device.first;
+    kv.value = status->message;
+    header_status->values.push_back(kv);
+  }
+  if (stale > 0 && stale < devices_.size()) {
+    header_status->level = Level_Error;
+  }
+  header_status->message = valToMsg(header_status->level);
+
+  return processed;
+}
+
+}  // namespace diagnostic_aggregator
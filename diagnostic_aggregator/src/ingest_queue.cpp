@@ -0,0 +1,208 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/ingest_queue.hpp"
+
+#include <algorithm>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace diagnostic_aggregator
+{
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+IngestQueue::IngestQueue(std::size_t capacity, const Thresholds & coalesce, const Thresholds & shed)
+: logger_(rclcpp::get_logger("IngestQueue")),
+  capacity_(capacity),
+  coalesce_(coalesce),
+  shed_(shed),
+  stopped_(false)
+{
+}
+
+const char * IngestQueue::getModeName(Mode mode)
+{
+  switch (mode) {
+    case Mode_Normal:
+      return "Normal";
+    case Mode_Coalesce:
+      return "Coalesce";
+    case Mode_Shed:
+      return "Shed";
+  }
+  return "Unknown";
+}
+
+void IngestQueue::push(
+  const DiagnosticArray::SharedPtr & msg, std::chrono::steady_clock::time_point received)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.push_back(Entry{msg, received});
+    statistics_.depth += msg->status.size();
+    statistics_.received += msg->status.size();
+
+    // At capacity, the oldest arrays are the least useful ones
+    while (statistics_.depth > capacity_ && entries_.size() > 1) {
+      std::size_t size = entries_.front().msg->status.size();
+      statistics_.depth -= size;
+      statistics_.dropped += size;
+      entries_.pop_front();
+    }
+  }
+  pushed_.notify_one();
+}
+
+void IngestQueue::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  pushed_.notify_all();
+}
+
+double IngestQueue::getLag(std::chrono::steady_clock::time_point now) const
+{
+  if (entries_.empty()) {
+    return 0.0;
+  }
+  return std::chrono::duration<double>(now - entries_.front().received).count();
+}
+
+void IngestQueue::updateMode(std::chrono::steady_clock::time_point now)
+{
+  const std::size_t depth = statistics_.depth;
+  const double lag = getLag(now);
+  statistics_.lag = lag;
+
+  Mode mode = Mode_Normal;
+  if (depth >= shed_.depth || lag >= shed_.lag) {
+    mode = Mode_Shed;
+  } else if (depth >= coalesce_.depth || lag >= coalesce_.lag) {
+    mode = Mode_Coalesce;
+  }
+
+  if (mode < statistics_.mode) {
+    // Only relax once the load is well below the current mode
+    const Thresholds & current = statistics_.mode == Mode_Shed ? shed_ : coalesce_;
+    if (depth * 2 >= current.depth || lag * 2 >= current.lag) {
+      return;
+    }
+  }
+  if (mode != statistics_.mode) {
+    RCLCPP_WARN(
+      logger_, "Ingest mode changed from %s to %s, %zu statuses queued, lag %.3f s.",
+      getModeName(statistics_.mode), getModeName(mode), depth, lag);
+    statistics_.mode = mode;
+  }
+}
+
+bool IngestQueue::pop(Batch & batch)
+{
+  std::deque<Entry> entries;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    pushed_.wait(lock, [this] {return stopped_ || !entries_.empty();});
+    if (stopped_) {
+      return false;
+    }
+    updateMode(std::chrono::steady_clock::now());
+    entries.swap(entries_);
+    batch.mode = statistics_.mode;
+    batch.received = entries.front().received;
+    statistics_.depth = 0;
+    statistics_.lag = 0.0;
+  }
+
+  batch.arrays.clear();
+  batch.statuses.clear();
+  for (const auto & entry : entries) {
+    batch.arrays.push_back(entry.msg);
+  }
+
+  if (batch.mode == Mode_Normal) {
+    for (const auto & msg : batch.arrays) {
+      for (const auto & status : msg->status) {
+        batch.statuses.push_back(&status);
+      }
+    }
+    return true;
+  }
+
+  // Newest first, so the first status of a name is the one to keep
+  std::uint64_t coalesced = 0;
+  std::uint64_t stripped = 0;
+  std::unordered_set<std::string_view> names;
+  for (auto msg = batch.arrays.rbegin(); msg != batch.arrays.rend(); ++msg) {
+    for (auto status = (*msg)->status.rbegin(); status != (*msg)->status.rend(); ++status) {
+      if (!names.insert(status->name).second) {
+        ++coalesced;
+        continue;
+      }
+      if (batch.mode == Mode_Shed && status->level == DiagnosticStatus::OK &&
+        !status->values.empty())
+      {
+        status->values.clear();
+        ++stripped;
+      }
+      batch.statuses.push_back(&*status);
+    }
+  }
+  std::reverse(batch.statuses.begin(), batch.statuses.end());
+
+  if (batch.mode == Mode_Shed) {
+    std::stable_partition(
+      batch.statuses.begin(), batch.statuses.end(), [](const DiagnosticStatus * status) {
+        return status->level != DiagnosticStatus::OK;
+      });
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  statistics_.coalesced += coalesced;
+  statistics_.stripped += stripped;
+  return true;
+}
+
+IngestQueue::Statistics IngestQueue::getStatistics() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  Statistics statistics = statistics_;
+  statistics.lag = getLag(std::chrono::steady_clock::now());
+  return statistics;
+}
+
+}  // namespace diagnostic_aggregator
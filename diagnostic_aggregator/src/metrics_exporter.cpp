@@ -0,0 +1,353 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/metrics_exporter.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace diagnostic_aggregator
+{
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+const char * const kLevelNames[] = {"ok", "warn", "error", "stale"};
+
+/// Label values escape backslash, double quote and line feed
+void appendLabel(std::string & out, const std::string & value)
+{
+  for (char c : value) {
+    switch (c) {
+      case '\\':
+        out += "\\\\";
+        break;
+      case '"':
+        out += "\\\"";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      default:
+        out += c;
+    }
+  }
+}
+
+std::string sample(const char * metric, const std::string & name, int value)
+{
+  std::string line = metric;
+  line += "{name=\"";
+  appendLabel(line, name);
+  line += "\"} ";
+  line += std::to_string(value);
+  line += '\n';
+  return line;
+}
+
+bool sendAll(int fd, struct iovec * iov, int count)
+{
+  while (count > 0) {
+    struct msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = iov;
+    message.msg_iovlen = count;
+    // A scraper that hangs up early must not raise SIGPIPE in the aggregator
+    ssize_t sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+    if (sent < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    while (count > 0 && static_cast<size_t>(sent) >= iov->iov_len) {
+      sent -= iov->iov_len;
+      ++iov;
+      --count;
+    }
+    if (count > 0) {
+      iov->iov_base = static_cast<char *>(iov->iov_base) + sent;
+      iov->iov_len -= sent;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+MetricsExporter::MetricsExporter(const std::string & address, int port)
+: logger_(rclcpp::get_logger("MetricsExporter")),
+  listen_fd_(-1),
+  port_(port),
+  running_(true),
+  generation_(0),
+  section_(std::make_shared<const std::string>()),
+  toplevel_level_(DiagnosticStatus::STALE),
+  duration_(0.0),
+  publications_(0),
+  received_(0),
+  scrapes_(0),
+  rebuilds_(0)
+{
+  struct sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+    RCLCPP_ERROR(logger_, "Invalid metrics address '%s'.", address.c_str());
+    return;
+  }
+
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    RCLCPP_ERROR(logger_, "Couldn't create metrics socket: %s", strerror(errno));
+    return;
+  }
+  int reuse = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  if (bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 ||
+    listen(fd, 16) != 0)
+  {
+    RCLCPP_ERROR(
+      logger_, "Couldn't listen for metrics on %s:%d: %s", address.c_str(), port,
+      strerror(errno));
+    ::close(fd);
+    return;
+  }
+  socklen_t length = sizeof(addr);
+  getsockname(fd, reinterpret_cast<struct sockaddr *>(&addr), &length);
+  port_ = ntohs(addr.sin_port);
+  listen_fd_ = fd;
+
+  RCLCPP_INFO(
+    logger_, "Serving diagnostics metrics on http://%s:%d/metrics", address.c_str(), port_);
+  thread_ = std::thread(&MetricsExporter::run, this);
+}
+
+MetricsExporter::~MetricsExporter()
+{
+  running_ = false;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (listen_fd_ >= 0) {
+    ::close(listen_fd_);
+  }
+}
+
+void MetricsExporter::update(
+  const std::vector<std::shared_ptr<DiagnosticStatus>> & tree, std::uint8_t toplevel_level,
+  double duration)
+{
+  ++publications_;
+  toplevel_level_ = toplevel_level;
+  duration_ = duration;
+
+  // Only statuses that are new or changed their level are formatted again
+  bool changed = false;
+  ++generation_;
+  for (const auto & status : tree) {
+    auto result = series_.emplace(status->name, Series());
+    Series & series = result.first->second;
+    if (result.second || series.level != status->level) {
+      series.level = status->level;
+      series.level_line = sample("diagnostics_level", status->name, status->level);
+      series.stale_line = sample(
+        "diagnostics_stale", status->name, status->level == DiagnosticStatus::STALE);
+      changed = true;
+    }
+    series.generation = generation_;
+  }
+  for (auto it = series_.begin(); it != series_.end(); ) {
+    if (it->second.generation != generation_) {
+      it = series_.erase(it);
+      changed = true;
+    } else {
+      ++it;
+    }
+  }
+
+  if (!changed) {
+    return;
+  }
+
+  size_t size = 0;
+  std::uint64_t items[4] = {0, 0, 0, 0};
+  for (const auto & series : series_) {
+    size += series.second.level_line.size() + series.second.stale_line.size();
+    ++items[series.second.level < 4 ? series.second.level : DiagnosticStatus::STALE];
+  }
+
+  auto section = std::make_shared<std::string>();
+  section->reserve(size + 1024);
+  *section +=
+    "# HELP diagnostics_level Level of an aggregated status, 0 OK, 1 WARN, 2 ERROR, 3 STALE.\n"
+    "# TYPE diagnostics_level gauge\n";
+  for (const auto & series : series_) {
+    *section += series.second.level_line;
+  }
+  *section +=
+    "# HELP diagnostics_stale Whether an aggregated status is stale.\n"
+    "# TYPE diagnostics_stale gauge\n";
+  for (const auto & series : series_) {
+    *section += series.second.stale_line;
+  }
+  *section +=
+    "# HELP diagnostics_items Number of aggregated statuses per level.\n"
+    "# TYPE diagnostics_items gauge\n";
+  for (int level = 0; level < 4; ++level) {
+    *section += "diagnostics_items{level=\"";
+    *section += kLevelNames[level];
+    *section += "\"} ";
+    *section += std::to_string(items[level]);
+    *section += '\n';
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(section_mutex_);
+    section_ = section;
+  }
+  ++rebuilds_;
+}
+
+std::string MetricsExporter::counters() const
+{
+  char buffer[1024];
+  int size = std::snprintf(
+    buffer, sizeof(buffer),
+    "# HELP diagnostics_toplevel_level Level published on /diagnostics_toplevel_state.\n"
+    "# TYPE diagnostics_toplevel_level gauge\n"
+    "diagnostics_toplevel_level %u\n"
+    "# HELP diagnostics_aggregator_publish_duration_seconds Duration of the last publication.\n"
+    "# TYPE diagnostics_aggregator_publish_duration_seconds gauge\n"
+    "diagnostics_aggregator_publish_duration_seconds %.9f\n"
+    "# TYPE diagnostics_aggregator_publications counter\n"
+    "diagnostics_aggregator_publications_total %llu\n"
+    "# TYPE diagnostics_aggregator_received_statuses counter\n"
+    "diagnostics_aggregator_received_statuses_total %llu\n"
+    "# TYPE diagnostics_aggregator_scrapes counter\n"
+    "diagnostics_aggregator_scrapes_total %llu\n"
+    "# TYPE diagnostics_aggregator_exposition_rebuilds counter\n"
+    "diagnostics_aggregator_exposition_rebuilds_total %llu\n"
+    "# EOF\n",
+    static_cast<unsigned>(toplevel_level_.load()), duration_.load(),
+    static_cast<unsigned long long>(publications_.load()),  // NOLINT(runtime/int)
+    static_cast<unsigned long long>(received_.load()),  // NOLINT(runtime/int)
+    static_cast<unsigned long long>(scrapes_.load()),  // NOLINT(runtime/int)
+    static_cast<unsigned long long>(rebuilds_.load()));  // NOLINT(runtime/int)
+  return std::string(buffer, size);
+}
+
+void MetricsExporter::run()
+{
+  struct pollfd pfd;
+  pfd.fd = listen_fd_;
+  pfd.events = POLLIN;
+  while (running_) {
+    // Wake up regularly to notice the shutdown
+    if (poll(&pfd, 1, 200) <= 0) {
+      continue;
+    }
+    int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      continue;
+    }
+    serve(fd);
+    ::close(fd);
+  }
+}
+
+void MetricsExporter::serve(int fd)
+{
+  struct timeval timeout = {1, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  // Only the request line matters, the headers are read and ignored
+  char request[4096];
+  size_t size = 0;
+  while (size < sizeof(request) - 1) {
+    ssize_t received = recv(fd, request + size, sizeof(request) - 1 - size, 0);
+    if (received <= 0) {
+      return;
+    }
+    size += received;
+    request[size] = '\0';
+    if (std::strstr(request, "\r\n\r\n") != nullptr || std::strstr(request, "\n\n") != nullptr) {
+      break;
+    }
+  }
+  request[size] = '\0';
+
+  bool metrics = std::strncmp(request, "GET /metrics ", 13) == 0 ||
+    std::strncmp(request, "GET /metrics?", 13) == 0;
+  if (!metrics) {
+    static const char kNotFound[] =
+      "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    struct iovec iov = {const_cast<char *>(kNotFound), sizeof(kNotFound) - 1};
+    sendAll(fd, &iov, 1);
+    return;
+  }
+
+  ++scrapes_;
+  std::shared_ptr<const std::string> section;
+  {
+    std::lock_guard<std::mutex> lock(section_mutex_);
+    section = section_;
+  }
+  std::string tail = counters();
+  std::string head =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+    "Content-Length: " + std::to_string(section->size() + tail.size()) + "\r\n"
+    "Connection: close\r\n\r\n";
+  struct iovec iov[3] = {
+    {const_cast<char *>(head.data()), head.size()},
+    {const_cast<char *>(section->data()), section->size()},
+    {const_cast<char *>(tail.data()), tail.size()}};
+  sendAll(fd, iov, 3);
+}
+
+}  // namespace diagnostic_aggregator
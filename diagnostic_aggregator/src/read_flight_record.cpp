@@ -0,0 +1,93 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "diagnostic_aggregator/flight_record_reader.hpp"
+#include "diagnostic_aggregator/status_item.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+/*!
+ * Prints the aggregated tree stored in a flight record at the given time.
+ *
+ * Usage: read_flight_record FILE [SECONDS]
+ * SECONDS is the time since epoch, the newest recorded tree is printed if omitted.
+ */
+int main(int argc, char ** argv)
+{
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " FILE [SECONDS]" << std::endl;
+    return 1;
+  }
+
+  diagnostic_aggregator::FlightRecordReader reader;
+  if (!reader.open(argv[1])) {
+    return 1;
+  }
+
+  rclcpp::Time first, last;
+  if (!reader.getTimeRange(first, last)) {
+    std::cerr << "Flight record is empty." << std::endl;
+    return 1;
+  }
+  std::cout << std::fixed << "Recorded: " << first.seconds() << " - " << last.seconds() <<
+    std::endl;
+
+  rclcpp::Time stamp = last;
+  if (argc > 2) {
+    stamp = rclcpp::Time(static_cast<int64_t>(std::atof(argv[2]) * 1e9), RCL_ROS_TIME);
+  }
+
+  diagnostic_msgs::msg::DiagnosticArray tree;
+  if (!reader.getTreeAt(stamp, tree)) {
+    std::cerr << "No data at " << stamp.seconds() << std::endl;
+    return 1;
+  }
+
+  std::cout << "Tree at " << stamp.seconds() << ":" << std::endl;
+  for (const auto & status : tree.status) {
+    std::cout << status.name << ": " << diagnostic_aggregator::valToMsg(status.level) << ", " <<
+      status.message << std::endl;
+    for (const auto & kv : status.values) {
+      std::cout << "    " << kv.key << ": " << kv.value << std::endl;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,196 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "diagnostic_aggregator/aggregator.hpp"
+#include "diagnostic_aggregator/archive_reader.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+
+#include "rcl/time.h"
+
+#include "rclcpp/rclcpp.hpp"
+
+using diagnostic_aggregator::PhaseTimes;
+
+namespace
+{
+double micros(std::chrono::nanoseconds duration)
+{
+  return duration.count() / 1e3;
+}
+
+void printPhase(
+  const char * name, std::chrono::nanoseconds duration, std::uint64_t count, const char * per)
+{
+  std::cout << "  " << name << ": " << duration.count() / 1e9 << " s";
+  if (count > 0) {
+    std::cout << ", " << micros(duration) / count << " us per " << per;
+  }
+  std::cout << std::endl;
+}
+}  // namespace
+
+/*!
+ * Replays the /diagnostics messages of an archive into an Aggregator, on a
+ * simulated clock that follows the recorded time, and prints the time spent in
+ * each phase of the aggregator.
+ *
+ * Usage: replay_diagnostics ARCHIVE [--speed FACTOR] [--csv FILE] [--topic TOPIC]
+ *          --ros-args --params-file analyzers.yaml
+ * FACTOR is the speed-up over the recorded time, 0 (default) replays as fast
+ * as possible. The CSV file gets the phase times of every publication. TOPIC
+ * is the recorded input of the aggregator, /diagnostics by default.
+ */
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  std::vector<std::string> args = rclcpp::remove_ros_arguments(argc, argv);
+
+  std::string archive_file;
+  std::string csv_file;
+  std::string input_topic = "/diagnostics";
+  double speed = 0.0;
+  for (std::size_t i = 1; i < args.size(); ++i) {
+    if (args[i] == "--speed" && i + 1 < args.size()) {
+      speed = std::atof(args[++i].c_str());
+    } else if (args[i] == "--csv" && i + 1 < args.size()) {
+      csv_file = args[++i];
+    } else if (args[i] == "--topic" && i + 1 < args.size()) {
+      input_topic = args[++i];
+    } else if (archive_file.empty()) {
+      archive_file = args[i];
+    }
+  }
+  if (archive_file.empty() || speed < 0) {
+    std::cerr << "Usage: " << args[0] << " ARCHIVE [--speed FACTOR] [--csv FILE] [--topic TOPIC]" <<
+      std::endl;
+    return 1;
+  }
+
+  diagnostic_aggregator::ArchiveReader reader;
+  rclcpp::Time first, last;
+  if (!reader.open(archive_file)) {
+    return 1;
+  }
+  if (!reader.getTimeRange(first, last)) {
+    std::cerr << "Archive is empty." << std::endl;
+    return 1;
+  }
+
+  // The analyzers and the incoming items run on the recorded time
+  auto clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  if (rcl_enable_ros_time_override(clock->get_clock_handle()) != RCL_RET_OK ||
+    rcl_set_ros_time_override(clock->get_clock_handle(), first.nanoseconds()) != RCL_RET_OK)
+  {
+    std::cerr << "Couldn't simulate the clock." << std::endl;
+    return 1;
+  }
+
+  auto agg = std::make_shared<diagnostic_aggregator::Aggregator>(clock);
+  const std::int64_t period = static_cast<std::int64_t>(agg->getPublishPeriod() * 1e9);
+  agg->enablePhaseTimes(true);
+
+  std::ofstream csv;
+  if (!csv_file.empty()) {
+    csv.open(csv_file);
+    csv << "time,ingest_us,match_us,report_us,publish_us,arrays,statuses" << std::endl;
+  }
+  PhaseTimes previous;
+  auto publish = [&](std::int64_t stamp) {
+      rcl_set_ros_time_override(clock->get_clock_handle(), stamp);
+      agg->publishData();
+      if (csv.is_open()) {
+        PhaseTimes times = agg->getPhaseTimes();
+        csv << stamp / 1e9 << "," << micros(times.ingest - previous.ingest) << "," <<
+          micros(times.match - previous.match) << "," << micros(times.report - previous.report) <<
+          "," << micros(times.publish - previous.publish) << "," <<
+          times.arrays - previous.arrays << "," << times.statuses - previous.statuses << std::endl;
+        previous = times;
+      }
+    };
+
+  std::string topic;
+  rclcpp::Time stamp;
+  diagnostic_msgs::msg::DiagnosticArray msg;
+  std::int64_t next_tick = first.nanoseconds() + period;
+  std::uint64_t skipped = 0;
+  auto wall_start = std::chrono::steady_clock::now();
+  while (rclcpp::ok() && reader.read(topic, stamp, msg)) {
+    if (topic != input_topic) {
+      ++skipped;
+      continue;
+    }
+
+    // Publications that were due before this message
+    const std::int64_t ns = stamp.nanoseconds();
+    for (; next_tick <= ns; next_tick += period) {
+      publish(next_tick);
+    }
+
+    if (speed > 0) {
+      std::this_thread::sleep_until(
+        wall_start + std::chrono::nanoseconds(
+          static_cast<std::int64_t>((ns - first.nanoseconds()) / speed)));
+    }
+    rcl_set_ros_time_override(clock->get_clock_handle(), ns);
+    agg->diagCallback(std::make_shared<diagnostic_msgs::msg::DiagnosticArray>(msg));
+  }
+  publish(next_tick);
+  std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wall_start;
+
+  PhaseTimes times = agg->getPhaseTimes();
+  double recorded = (last - first).seconds();
+  std::cout << "Replayed " << recorded << " s of recording in " << wall.count() << " s (" <<
+    recorded / wall.count() << "x)" << std::endl;
+  std::cout << "  " << times.arrays << " arrays, " << times.statuses << " statuses, " <<
+    times.publications << " publications, " << skipped << " messages of other topics skipped" <<
+    std::endl;
+  printPhase("ingest", times.ingest, times.statuses, "status");
+  printPhase("match", times.match, times.statuses, "status");
+  printPhase("report", times.report, times.publications, "publication");
+  printPhase("publish", times.publish, times.publications, "publication");
+
+  agg.reset();
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,196 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/snapshot_reader.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace diagnostic_aggregator
+{
+SnapshotReader::SnapshotReader()
+: header_(nullptr),
+  data_(nullptr),
+  region_size_(0)
+{
+}
+
+SnapshotReader::~SnapshotReader()
+{
+  close();
+}
+
+bool SnapshotReader::open(const std::string & name)
+{
+  close();
+
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+    static_cast<std::uint64_t>(st.st_size) < sizeof(snapshot::RegionHeader))
+  {
+    ::close(fd);
+    return false;
+  }
+  region_size_ = st.st_size;
+  void * region = mmap(nullptr, region_size_, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (region == MAP_FAILED) {
+    return false;
+  }
+
+  auto header = static_cast<const snapshot::RegionHeader *>(region);
+  if (std::memcmp(header->magic, snapshot::kRegionMagic, sizeof(header->magic)) != 0 ||
+    header->version != snapshot::kVersion ||
+    header->capacity > region_size_ - sizeof(snapshot::RegionHeader))
+  {
+    munmap(region, region_size_);
+    return false;
+  }
+
+  header_ = header;
+  data_ = static_cast<const char *>(region) + sizeof(snapshot::RegionHeader);
+  return true;
+}
+
+void SnapshotReader::close()
+{
+  if (header_ != nullptr) {
+    munmap(const_cast<snapshot::RegionHeader *>(header_), region_size_);
+    header_ = nullptr;
+    data_ = nullptr;
+  }
+}
+
+std::uint64_t SnapshotReader::getSequence() const
+{
+  return header_ ? header_->sequence.load(std::memory_order_acquire) : 0;
+}
+
+bool SnapshotReader::read(Snapshot & snapshot, int max_retries) const
+{
+  if (header_ == nullptr) {
+    return false;
+  }
+
+  for (int attempt = 0; attempt < max_retries; ++attempt) {
+    if (attempt > 0) {
+      // The writer is busy, give it the time to finish
+      std::this_thread::yield();
+    }
+
+    std::uint64_t sequence = header_->sequence.load(std::memory_order_acquire);
+    if (sequence & 1) {
+      continue;
+    }
+
+    std::uint64_t size = header_->size;
+    std::uint32_t status_count = header_->status_count;
+    std::uint32_t value_count = header_->value_count;
+    std::int64_t stamp = header_->stamp;
+    if (size > header_->capacity) {
+      continue;
+    }
+    if (snapshot.storage_.size() * 8 < size) {
+      snapshot.storage_.resize((size + 7) / 8);
+    }
+    std::memcpy(snapshot.storage_.data(), data_, size);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header_->sequence.load(std::memory_order_relaxed) != sequence) {
+      continue;
+    }
+
+    snapshot.data_ = std::string_view(
+      reinterpret_cast<const char *>(snapshot.storage_.data()), size);
+    snapshot.sequence_ = sequence;
+    snapshot.stamp_ = stamp;
+    snapshot.status_count_ = status_count;
+    if (!validate(snapshot, value_count)) {
+      snapshot.status_count_ = 0;
+      return false;
+    }
+    return true;
+  }
+  return false;
+}
+
+bool SnapshotReader::validate(const Snapshot & snapshot, std::uint32_t value_count) const
+{
+  // The copy is consistent, but don't trust the writer with the bounds
+  std::uint64_t size = snapshot.data_.size();
+  std::uint64_t tables = snapshot.status_count_ * sizeof(snapshot::StatusRecord) +
+    static_cast<std::uint64_t>(value_count) * sizeof(snapshot::ValueRecord);
+  if (tables > size) {
+    return false;
+  }
+  auto in_bounds = [size](std::uint32_t offset, std::uint32_t length) {
+      return static_cast<std::uint64_t>(offset) + length <= size;
+    };
+
+  auto records = reinterpret_cast<const snapshot::StatusRecord *>(snapshot.data_.data());
+  auto values = reinterpret_cast<const snapshot::ValueRecord *>(
+    records + snapshot.status_count_);
+  for (std::size_t i = 0; i < snapshot.status_count_; ++i) {
+    const snapshot::StatusRecord & record = records[i];
+    if (!in_bounds(record.name_offset, record.name_size) ||
+      !in_bounds(record.message_offset, record.message_size) ||
+      !in_bounds(record.hardware_id_offset, record.hardware_id_size) ||
+      static_cast<std::uint64_t>(record.first_value) + record.value_count > value_count)
+    {
+      return false;
+    }
+  }
+  for (std::uint32_t i = 0; i < value_count; ++i) {
+    if (!in_bounds(values[i].key_offset, values[i].key_size) ||
+      !in_bounds(values[i].value_offset, values[i].value_size))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace diagnostic_aggregator
@@ -0,0 +1,196 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/snapshot_writer.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace diagnostic_aggregator
+{
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+SnapshotWriter::SnapshotWriter(const std::string & name, std::uint64_t capacity)
+: logger_(rclcpp::get_logger("SnapshotWriter")),
+  name_(name),
+  capacity_(capacity - capacity % 8),
+  region_size_(sizeof(snapshot::RegionHeader) + capacity_),
+  header_(nullptr),
+  data_(nullptr),
+  overflow_warned_(false)
+{
+  // Offsets in the region are 32 bit
+  if (capacity_ < 4096 || capacity_ > UINT32_MAX) {
+    RCLCPP_ERROR(
+      logger_, "Snapshot capacity must be between 4096 bytes and 4 GiB, got %lu bytes.",
+      static_cast<unsigned long>(capacity));
+    return;
+  }
+
+  int fd = shm_open(name_.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    RCLCPP_ERROR(
+      logger_, "Couldn't open shared memory '%s': %s", name_.c_str(), strerror(errno));
+    return;
+  }
+  if (ftruncate(fd, region_size_) != 0) {
+    RCLCPP_ERROR(
+      logger_, "Couldn't resize shared memory '%s': %s", name_.c_str(), strerror(errno));
+    ::close(fd);
+    return;
+  }
+  void * region = mmap(nullptr, region_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (region == MAP_FAILED) {
+    RCLCPP_ERROR(
+      logger_, "Couldn't map shared memory '%s': %s", name_.c_str(), strerror(errno));
+    return;
+  }
+
+  // A previous writer may have left a region behind, take it over with an
+  // odd sequence so readers ignore it until the first snapshot is written
+  auto header = static_cast<snapshot::RegionHeader *>(region);
+  std::memset(header->magic, 0, sizeof(header->magic));
+  std::uint64_t sequence = header->sequence.load(std::memory_order_relaxed);
+  header->sequence.store((sequence | 1) + 2, std::memory_order_relaxed);
+  header->version = snapshot::kVersion;
+  header->reserved = 0;
+  header->capacity = capacity_;
+  header->size = 0;
+  header->stamp = 0;
+  header->status_count = 0;
+  header->value_count = 0;
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(header->magic, snapshot::kRegionMagic, sizeof(header->magic));
+
+  header_ = header;
+  data_ = static_cast<char *>(region) + sizeof(snapshot::RegionHeader);
+  RCLCPP_INFO(
+    logger_, "Exporting aggregated diagnostics to shared memory '%s' (%lu bytes).",
+    name_.c_str(), static_cast<unsigned long>(capacity_));
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+  if (header_ != nullptr) {
+    munmap(header_, region_size_);
+    shm_unlink(name_.c_str());
+  }
+}
+
+bool SnapshotWriter::write(
+  const std::vector<std::shared_ptr<DiagnosticStatus>> & statuses, const rclcpp::Time & stamp)
+{
+  if (header_ == nullptr) {
+    return false;
+  }
+
+  // Size the snapshot first, so a tree that doesn't fit leaves the old one intact
+  std::uint64_t value_count = 0;
+  std::uint64_t string_size = 0;
+  for (const auto & status : statuses) {
+    std::size_t values = std::min<std::size_t>(status->values.size(), UINT16_MAX);
+    value_count += values;
+    string_size += status->name.size() + status->message.size() + status->hardware_id.size();
+    for (std::size_t i = 0; i < values; ++i) {
+      string_size += status->values[i].key.size() + status->values[i].value.size();
+    }
+  }
+  std::uint64_t size = statuses.size() * sizeof(snapshot::StatusRecord) +
+    value_count * sizeof(snapshot::ValueRecord) + string_size;
+  if (size > capacity_) {
+    if (!overflow_warned_) {
+      RCLCPP_WARN(
+        logger_, "Aggregated tree of %lu bytes doesn't fit into shared memory '%s' of %lu bytes.",
+        static_cast<unsigned long>(size), name_.c_str(), static_cast<unsigned long>(capacity_));
+      overflow_warned_ = true;
+    }
+    return false;
+  }
+
+  // Odd while writing, the sequence is already odd before the first snapshot
+  std::uint64_t sequence = header_->sequence.load(std::memory_order_relaxed) | 1;
+  header_->sequence.store(sequence, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  auto records = reinterpret_cast<snapshot::StatusRecord *>(data_);
+  auto value_records = reinterpret_cast<snapshot::ValueRecord *>(records + statuses.size());
+  std::uint32_t offset = static_cast<std::uint32_t>(
+    reinterpret_cast<char *>(value_records + value_count) - data_);
+  auto append = [this, &offset](const std::string & value, std::uint32_t & at,
+      std::uint32_t & length) {
+      std::memcpy(data_ + offset, value.data(), value.size());
+      at = offset;
+      length = static_cast<std::uint32_t>(value.size());
+      offset += length;
+    };
+
+  std::uint32_t value_index = 0;
+  for (std::size_t i = 0; i < statuses.size(); ++i) {
+    const DiagnosticStatus & status = *statuses[i];
+    snapshot::StatusRecord & record = records[i];
+    append(status.name, record.name_offset, record.name_size);
+    append(status.message, record.message_offset, record.message_size);
+    append(status.hardware_id, record.hardware_id_offset, record.hardware_id_size);
+    record.level = status.level;
+    record.reserved = 0;
+    record.first_value = value_index;
+    record.value_count = static_cast<std::uint16_t>(
+      std::min<std::size_t>(status.values.size(), UINT16_MAX));
+    for (std::uint16_t j = 0; j < record.value_count; ++j, ++value_index) {
+      snapshot::ValueRecord & value = value_records[value_index];
+      append(status.values[j].key, value.key_offset, value.key_size);
+      append(status.values[j].value, value.value_offset, value.value_size);
+    }
+  }
+
+  header_->size = size;
+  header_->stamp = stamp.nanoseconds();
+  header_->status_count = static_cast<std::uint32_t>(statuses.size());
+  header_->value_count = static_cast<std::uint32_t>(value_count);
+  header_->sequence.store(sequence + 1, std::memory_order_release);
+  return true;
+}
+
+}  // namespace diagnostic_aggregator
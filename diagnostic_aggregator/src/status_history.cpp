@@ -0,0 +1,162 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/status_history.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace diagnostic_aggregator
+{
+namespace
+{
+std::uint64_t pack(std::int64_t stamp, std::uint8_t level)
+{
+  return (static_cast<std::uint64_t>(stamp / 1000) << 8) | level;
+}
+
+std::int64_t runStart(std::uint64_t run)
+{
+  return static_cast<std::int64_t>(run >> 8) * 1000;
+}
+
+std::uint8_t runLevel(std::uint64_t run)
+{
+  return static_cast<std::uint8_t>(run & 0xff);
+}
+}  // namespace
+
+StatusHistory::StatusHistory(std::size_t max_transitions)
+: max_transitions_(std::max<std::size_t>(max_transitions, 1))
+{
+}
+
+void StatusHistory::record(const diagnostic_msgs::msg::DiagnosticArray & tree)
+{
+  std::int64_t stamp = static_cast<std::int64_t>(tree.header.stamp.sec) * 1000000000LL +
+    tree.header.stamp.nanosec;
+  if (stamp < 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto & status : tree.status) {
+    Track & track = tracks_[status.name];
+    if (!track.runs.empty() && runLevel(track.back()) == status.level) {
+      continue;
+    }
+
+    if (track.runs.size() < max_transitions_) {
+      track.runs.push_back(pack(stamp, status.level));
+    } else {
+      track.runs[track.head] = pack(stamp, status.level);
+      track.head = (track.head + 1) % track.runs.size();
+    }
+  }
+}
+
+std::vector<StatusHistory::Transition> StatusHistory::query(
+  const std::string & path, std::int64_t start, std::int64_t end) const
+{
+  std::string prefix = path;
+  while (!prefix.empty() && prefix.back() == '/') {
+    prefix.pop_back();
+  }
+
+  std::vector<Transition> transitions;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (prefix.empty()) {
+    collect(tracks_.begin(), tracks_.end(), start, end, transitions);
+  } else {
+    // The subtree is the status named prefix plus the range of names starting
+    // with prefix + '/', which ends before prefix + ('/' + 1).
+    auto exact = tracks_.find(prefix);
+    if (exact != tracks_.end()) {
+      collect(exact, std::next(exact), start, end, transitions);
+    }
+    collect(
+      tracks_.lower_bound(prefix + '/'), tracks_.lower_bound(prefix + static_cast<char>('/' + 1)),
+      start, end, transitions);
+  }
+
+  std::stable_sort(
+    transitions.begin(), transitions.end(),
+    [](const Transition & a, const Transition & b) {return a.stamp < b.stamp;});
+  return transitions;
+}
+
+void StatusHistory::collect(
+  Index::const_iterator begin, Index::const_iterator end, std::int64_t start,
+  std::int64_t stop, std::vector<Transition> & out) const
+{
+  for (auto it = begin; it != end; ++it) {
+    const Track & track = it->second;
+    if (track.runs.empty()) {
+      continue;
+    }
+
+    // First run starting after start, the run before it covers start
+    std::size_t low = 0;
+    std::size_t high = track.runs.size();
+    while (low < high) {
+      std::size_t mid = low + (high - low) / 2;
+      if (runStart(track.at(mid)) <= start) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    if (low > 0) {
+      --low;
+    }
+
+    for (std::size_t i = low; i < track.runs.size(); ++i) {
+      std::uint64_t run = track.at(i);
+      if (runStart(run) > stop) {
+        break;
+      }
+      out.push_back(Transition{it->first, runStart(run), runLevel(run)});
+    }
+  }
+}
+
+std::size_t StatusHistory::getStatusCount() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tracks_.size();
+}
+
+}  // namespace diagnostic_aggregator
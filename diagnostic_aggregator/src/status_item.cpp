@@ -36,8 +36,14 @@
 
 #include "diagnostic_aggregator/status_item.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace diagnostic_aggregator
 {
@@ -45,8 +51,11 @@ using std::string;
 
 using rclcpp::get_logger;
 
-StatusItem::StatusItem(const diagnostic_msgs::msg::DiagnosticStatus * status)
-: clock_(new rclcpp::Clock())
+StatusItem::StatusItem(
+  const diagnostic_msgs::msg::DiagnosticStatus * status, rclcpp::Clock::SharedPtr clock)
+: clock_(clock ? clock : std::make_shared<rclcpp::Clock>()),
+  numbers_parsed_(false),
+  statistics_window_(0.0)
 {
   level_ = valToLevel(status->level);
   name_ = status->name;
@@ -59,8 +68,12 @@ StatusItem::StatusItem(const diagnostic_msgs::msg::DiagnosticStatus * status)
   update_time_ = clock_->now();
 }
 
-StatusItem::StatusItem(const string item_name, const string message, const DiagnosticLevel level)
-: clock_(new rclcpp::Clock())
+StatusItem::StatusItem(
+  const string item_name, const string message, const DiagnosticLevel level,
+  rclcpp::Clock::SharedPtr clock)
+: clock_(clock ? clock : std::make_shared<rclcpp::Clock>()),
+  numbers_parsed_(false),
+  statistics_window_(0.0)
 {
   RCLCPP_DEBUG(rclcpp::get_logger("StatusItem"), "StatusItem constructor from string");
   name_ = item_name;
@@ -96,12 +109,143 @@ bool StatusItem::update(const diagnostic_msgs::msg::DiagnosticStatus * status)
   message_ = status->message;
   hw_id_ = status->hardware_id;
   values_ = status->values;
+  numbers_parsed_ = false;
 
   update_time_ = clock_->now();
 
+  if (statistics_) {
+    addStatistics();
+  }
+
   return true;
 }
 
+std::shared_ptr<StatusItem> StatusItem::withLevel(
+  const DiagnosticLevel level, const std::string & message) const
+{
+  auto item = std::make_shared<StatusItem>(*this);
+  item->level_ = level;
+  item->message_ = message;
+  return item;
+}
+
+bool StatusItem::getNumber(const std::string & key, double & value) const
+{
+  for (unsigned int i = 0; i < values_.size(); ++i) {
+    if (values_[i].key == key) {
+      parseNumbers();
+      if (std::isnan(numbers_[i])) {
+        return false;
+      }
+      value = numbers_[i];
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void StatusItem::parseNumbers() const
+{
+  if (numbers_parsed_) {
+    return;
+  }
+
+  numbers_.resize(values_.size());
+  for (unsigned int i = 0; i < values_.size(); ++i) {
+    // A number, optionally surrounded by whitespace
+    const char * first = values_[i].value.data();
+    const char * last = first + values_[i].value.size();
+    while (first != last && std::isspace(static_cast<unsigned char>(*first))) {
+      ++first;
+    }
+    while (last != first && std::isspace(static_cast<unsigned char>(*(last - 1)))) {
+      --last;
+    }
+
+    double number = std::numeric_limits<double>::quiet_NaN();
+    auto result = std::from_chars(first, last, number);
+    if (result.ec != std::errc() || result.ptr != last) {
+      number = std::numeric_limits<double>::quiet_NaN();
+    }
+    numbers_[i] = number;
+  }
+  numbers_parsed_ = true;
+}
+
+void StatusItem::trackStatistics(
+  double window, const std::vector<std::string> & keys, const StatusItem * previous)
+{
+  if (statistics_ || window <= 0) {
+    return;
+  }
+
+  statistics_window_ = window;
+  statistics_keys_ = keys;
+  if (previous && previous->statistics_) {
+    statistics_ = previous->statistics_;
+  } else {
+    statistics_ = std::make_shared<std::map<std::string, WindowStatistics>>();
+  }
+
+  addStatistics();
+}
+
+void StatusItem::addStatistics()
+{
+  parseNumbers();
+  for (unsigned int i = 0; i < values_.size(); ++i) {
+    if (std::isnan(numbers_[i])) {
+      continue;
+    }
+    if (!statistics_keys_.empty() &&
+      std::find(statistics_keys_.begin(), statistics_keys_.end(), values_[i].key) ==
+      statistics_keys_.end())
+    {
+      continue;
+    }
+
+    auto it = statistics_->find(values_[i].key);
+    if (it == statistics_->end()) {
+      it = statistics_->emplace(values_[i].key, WindowStatistics(statistics_window_)).first;
+    }
+    it->second.add(update_time_, numbers_[i]);
+  }
+}
+
+const WindowStatistics * StatusItem::getStatistics(const std::string & key) const
+{
+  if (!statistics_) {
+    return nullptr;
+  }
+
+  auto it = statistics_->find(key);
+  if (it == statistics_->end()) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+void StatusItem::dampFlaps(
+  double dwell, double window, int max_flaps, const StatusItem * previous)
+{
+  if (flap_damper_ || (dwell <= 0 && max_flaps <= 0)) {
+    return;
+  }
+
+  if (previous && previous->flap_damper_) {
+    flap_damper_ = previous->flap_damper_;
+  } else {
+    flap_damper_ = std::make_shared<FlapDamper>(dwell, window, max_flaps);
+  }
+
+  auto level = static_cast<DiagnosticLevel>(flap_damper_->update(update_time_, level_));
+  if (level != level_) {
+    level_ = level;
+    message_ = previous && previous->level_ == level ? previous->message_ : valToMsg(level);
+  }
+}
+
 std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus> StatusItem::toStatusMsg(
   const std::string & path, bool stale) const
 {
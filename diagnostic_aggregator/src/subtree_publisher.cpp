@@ -0,0 +1,190 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/subtree_publisher.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace diagnostic_aggregator
+{
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+void SubtreeIndex::build(const DiagnosticArray & tree)
+{
+  tree_ = &tree;
+  order_.resize(tree.status.size());
+  for (std::uint32_t i = 0; i < order_.size(); ++i) {
+    order_[i] = i;
+  }
+  std::sort(
+    order_.begin(), order_.end(), [&tree](std::uint32_t a, std::uint32_t b) {
+      return tree.status[a].name < tree.status[b].name;
+    });
+}
+
+void SubtreeIndex::cut(const std::string & path, std::vector<DiagnosticStatus> & out) const
+{
+  if (!tree_) {
+    return;
+  }
+
+  std::string prefix = path;
+  while (!prefix.empty() && prefix.back() == '/') {
+    prefix.pop_back();
+  }
+
+  // The status named prefix, then the names starting with prefix + '/',
+  // which end before prefix + ('/' + 1)
+  auto less = [this](std::uint32_t index, const std::string & name) {
+      return tree_->status[index].name < name;
+    };
+  auto begin = std::lower_bound(order_.begin(), order_.end(), prefix, less);
+  auto end = std::lower_bound(
+    begin, order_.end(), prefix + static_cast<char>('/' + 1), less);
+  for (auto it = begin; it != end; ++it) {
+    const std::string & name = tree_->status[*it].name;
+    if (name.size() == prefix.size() || name[prefix.size()] == '/') {
+      out.push_back(tree_->status[*it]);
+    }
+  }
+}
+
+SubtreePublisher::SubtreePublisher(rclcpp::Node::SharedPtr node, double idle_timeout)
+: node_(node),
+  clock_(node->get_clock()),
+  idle_timeout_(idle_timeout),
+  next_id_(0)
+{
+}
+
+std::string SubtreePublisher::subscribe(const std::string & path, double max_rate)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  rclcpp::Time now = clock_->now();
+  for (auto & subtree : subtrees_) {
+    if (subtree.path == path && subtree.max_rate == max_rate) {
+      subtree.last_subscribed = now;
+      return subtree.topic;
+    }
+  }
+
+  Subtree subtree;
+  subtree.path = path;
+  subtree.max_rate = max_rate;
+  subtree.publisher =
+    node_->create_publisher<DiagnosticArray>("~/subtree_" + std::to_string(next_id_++), 1);
+  subtree.topic = subtree.publisher->get_topic_name();
+  subtree.last_published = rclcpp::Time(0, 0, clock_->get_clock_type());
+  subtree.last_subscribed = now;
+  subtrees_.push_back(subtree);
+
+  RCLCPP_INFO(
+    rclcpp::get_logger("SubtreePublisher"), "Publishing '%s' at up to %f Hz on %s", path.c_str(),
+    max_rate, subtree.topic.c_str());
+  return subtree.topic;
+}
+
+void SubtreePublisher::publish(const DiagnosticArray & tree)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (subtrees_.empty()) {
+    return;
+  }
+
+  rclcpp::Time now = clock_->now();
+  bool indexed = false;
+  for (auto & cut : cuts_) {
+    cut.second.done = false;
+  }
+
+  for (auto it = subtrees_.begin(); it != subtrees_.end(); ) {
+    Subtree & subtree = *it;
+    if (subtree.publisher->get_subscription_count() > 0) {
+      subtree.last_subscribed = now;
+    } else if ((now - subtree.last_subscribed).seconds() > idle_timeout_) {
+      RCLCPP_INFO(
+        rclcpp::get_logger("SubtreePublisher"), "Removing %s without subscribers",
+        subtree.topic.c_str());
+      it = subtrees_.erase(it);
+      continue;
+    }
+
+    if (subtree.max_rate > 0 &&
+      (now - subtree.last_published).seconds() < 1.0 / subtree.max_rate)
+    {
+      ++it;
+      continue;
+    }
+
+    if (!indexed) {
+      index_.build(tree);
+      indexed = true;
+    }
+
+    // Cut every path only once per output
+    Cut & cut = cuts_[subtree.path];
+    if (!cut.done) {
+      cut.tree.header = tree.header;
+      cut.tree.status.clear();
+      index_.cut(subtree.path, cut.tree.status);
+      cut.done = true;
+    }
+
+    subtree.publisher->publish(cut.tree);
+    subtree.last_published = now;
+    ++it;
+  }
+
+  // Forget cuts of paths no longer subscribed
+  for (auto it = cuts_.begin(); it != cuts_.end(); ) {
+    bool used = std::any_of(
+      subtrees_.begin(), subtrees_.end(), [&it](const Subtree & subtree) {
+        return subtree.path == it->first;
+      });
+    it = used ? std::next(it) : cuts_.erase(it);
+  }
+}
+
+std::size_t SubtreePublisher::getTopicCount() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return subtrees_.size();
+}
+
+}  // namespace diagnostic_aggregator
@@ -0,0 +1,183 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/threshold_analyzer.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+PLUGINLIB_EXPORT_CLASS(diagnostic_aggregator::ThresholdAnalyzer, diagnostic_aggregator::Analyzer)
+
+namespace diagnostic_aggregator
+{
+ThresholdAnalyzer::ThresholdAnalyzer()
+: reevaluate_(false)
+{
+}
+
+ThresholdAnalyzer::~ThresholdAnalyzer() {}
+
+bool ThresholdAnalyzer::init(
+  const std::string & base_path, const std::string & breadcrumb,
+  const rclcpp::Node::SharedPtr n)
+{
+  if (!GenericAnalyzer::init(base_path, breadcrumb, n)) {
+    return false;
+  }
+
+  std::map<std::string, rclcpp::Parameter> parameters;
+  if (!n->get_parameters(breadcrumb, parameters)) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger("ThresholdAnalyzer"),
+      "Couldn't retrieve parameters for threshold analyzer at prefix '%s'.", breadcrumb.c_str());
+    return false;
+  }
+
+  auto param = parameters.find("rules");
+  if (param == parameters.end()) {
+    RCLCPP_WARN(
+      rclcpp::get_logger("ThresholdAnalyzer"),
+      "ThresholdAnalyzer '%s' has no rules, it behaves like a GenericAnalyzer.",
+      nice_name_.c_str());
+    return true;
+  }
+
+  std::vector<std::string> sources;
+  if (!getParamVals(param->second, sources)) {
+    return false;
+  }
+
+  for (const auto & source : sources) {
+    ThresholdRule rule;
+    std::string error;
+    if (!rule.compile(source, error)) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger("ThresholdAnalyzer"), "ThresholdAnalyzer '%s' has an invalid rule: %s",
+        nice_name_.c_str(), error.c_str());
+      return false;
+    }
+    reevaluate_ = reevaluate_ || rule.getDuration() > 0 || rule.usesAge();
+    rules_.push_back(std::move(rule));
+  }
+
+  RCLCPP_DEBUG(
+    rclcpp::get_logger("ThresholdAnalyzer"), "ThresholdAnalyzer '%s' compiled %zu rule(s).",
+    nice_name_.c_str(), rules_.size());
+  return true;
+}
+
+bool ThresholdAnalyzer::apply(Tracked & tracked, const rclcpp::Time & now)
+{
+  const StatusItem & item = *tracked.item;
+  double age = (now - item.getLastUpdateTime()).seconds();
+
+  DiagnosticLevel level = item.getLevel();
+  const ThresholdRule * applied = nullptr;
+  for (std::size_t i = 0; i < rules_.size(); ++i) {
+    const ThresholdRule & rule = rules_[i];
+    if (!rule.test(item, age)) {
+      tracked.since[i] = -1;
+      continue;
+    }
+
+    if (tracked.since[i] < 0) {
+      tracked.since[i] = now.nanoseconds();
+    }
+    const std::int64_t duration = static_cast<std::int64_t>(rule.getDuration() * 1e9);
+    if (now.nanoseconds() - tracked.since[i] < duration) {
+      continue;
+    }
+    if (rule.getLevel() > level) {
+      level = rule.getLevel();
+      applied = &rule;
+    }
+  }
+
+  bool changed = applied != tracked.applied;
+  tracked.applied = applied;
+  return changed;
+}
+
+std::shared_ptr<StatusItem> ThresholdAnalyzer::result(const Tracked & tracked) const
+{
+  if (!tracked.applied) {
+    return tracked.item;
+  }
+  return tracked.item->withLevel(tracked.applied->getLevel(), tracked.applied->getDescription());
+}
+
+bool ThresholdAnalyzer::analyze(const std::shared_ptr<StatusItem> item)
+{
+  if (rules_.empty()) {
+    return GenericAnalyzer::analyze(item);
+  }
+
+  Tracked & tracked = tracked_[item->getName()];
+  if (statistics_window_ > 0) {
+    // Before copies are made, so they share the statistics
+    item->trackStatistics(statistics_window_, statistics_keys_, tracked.item.get());
+  }
+  tracked.item = item;
+  tracked.since.resize(rules_.size(), -1);
+  apply(tracked, clock_->now());
+  return GenericAnalyzer::analyze(result(tracked));
+}
+
+std::vector<std::shared_ptr<diagnostic_msgs::msg::DiagnosticStatus>> ThresholdAnalyzer::report()
+{
+  if (reevaluate_) {
+    rclcpp::Time now = clock_->now();
+    for (auto & tracked : tracked_) {
+      if (apply(tracked.second, now)) {
+        GenericAnalyzer::analyze(result(tracked.second));
+      }
+    }
+  }
+
+  auto processed = GenericAnalyzer::report();
+
+  // Forget the items discarded as stale, so they aren't analyzed again
+  for (auto it = tracked_.begin(); it != tracked_.end(); ) {
+    if (hasItem(it->first)) {
+      ++it;
+    } else {
+      it = tracked_.erase(it);
+    }
+  }
+  return processed;
+}
+
+}  // namespace diagnostic_aggregator
@@ -0,0 +1,694 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/threshold_rule.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace diagnostic_aggregator
+{
+/*!
+ *\brief Parses a rule into a syntax tree and emits its bytecode.
+ */
+class ThresholdRuleCompiler
+{
+public:
+  ThresholdRuleCompiler(ThresholdRule & rule, const std::string & source)
+  : rule_(rule), source_(source), pos_(0)
+  {
+  }
+
+  bool compile(std::string & error);
+
+private:
+  using Op = ThresholdRule::Op;
+  using Field = ThresholdRule::Field;
+
+  struct Token
+  {
+    enum Type {End, Number, Identifier, Key, String, Operator};
+    Type type = End;
+    std::string text;
+    double value = 0.0;
+    std::size_t pos = 0;
+  };
+
+  struct Node
+  {
+    enum Kind {Number, String, Key, Level, Age, Message, HardwareId, Name, Unary, Binary};
+    Kind kind;
+    Op op = Op::Number;
+    double value = 0.0;
+    std::string text;
+    std::unique_ptr<Node> lhs;
+    std::unique_ptr<Node> rhs;
+  };
+
+  bool next();
+  bool isOperator(const char * text) const
+  {
+    return token_.type == Token::Operator && token_.text == text;
+  }
+  bool isWord(const char * text) const
+  {
+    return token_.type == Token::Identifier && token_.text == text;
+  }
+  bool fail(const std::string & message);
+
+  std::unique_ptr<Node> parseOr();
+  std::unique_ptr<Node> parseAnd();
+  std::unique_ptr<Node> parseNot();
+  std::unique_ptr<Node> parseComparison();
+  std::unique_ptr<Node> parseSum();
+  std::unique_ptr<Node> parseProduct();
+  std::unique_ptr<Node> parseUnary();
+  std::unique_ptr<Node> parsePrimary();
+  std::unique_ptr<Node> makeBinary(Op op, std::unique_ptr<Node> lhs, std::unique_ptr<Node> rhs);
+
+  bool emit(const Node & node);
+  bool emitStringComparison(Op op, const Node & field, const Node & literal);
+  std::uint32_t keyIndex(const std::string & key);
+
+  ThresholdRule & rule_;
+  const std::string & source_;
+  std::size_t pos_;
+  Token token_;
+  std::string error_;
+};
+
+bool ThresholdRuleCompiler::fail(const std::string & message)
+{
+  if (error_.empty()) {
+    error_ = message + " at position " + std::to_string(token_.pos) + " of '" + source_ + "'";
+  }
+  return false;
+}
+
+bool ThresholdRuleCompiler::next()
+{
+  while (pos_ < source_.size() && std::isspace(static_cast<unsigned char>(source_[pos_]))) {
+    ++pos_;
+  }
+
+  token_ = Token();
+  token_.pos = pos_;
+  if (pos_ >= source_.size()) {
+    return true;
+  }
+
+  char c = source_[pos_];
+  if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+    auto result = std::from_chars(
+      source_.data() + pos_, source_.data() + source_.size(), token_.value);
+    if (result.ec != std::errc()) {
+      return fail("Invalid number");
+    }
+    token_.type = Token::Number;
+    pos_ = result.ptr - source_.data();
+    return true;
+  }
+
+  if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+    std::size_t end = pos_;
+    while (end < source_.size() &&
+      (std::isalnum(static_cast<unsigned char>(source_[end])) || source_[end] == '_'))
+    {
+      ++end;
+    }
+    token_.type = Token::Identifier;
+    token_.text = source_.substr(pos_, end - pos_);
+    pos_ = end;
+    return true;
+  }
+
+  if (c == '`' || c == '\'' || c == '"') {
+    std::size_t end = source_.find(c, pos_ + 1);
+    if (end == std::string::npos) {
+      return fail("Unterminated quote");
+    }
+    token_.type = c == '`' ? Token::Key : Token::String;
+    token_.text = source_.substr(pos_ + 1, end - pos_ - 1);
+    pos_ = end + 1;
+    return true;
+  }
+
+  static const char * const operators[] = {
+    "<=", ">=", "==", "!=", "&&", "||", "<", ">", "!", "+", "-", "*", "/", "(", ")"};
+  for (const char * op : operators) {
+    std::size_t length = std::char_traits<char>::length(op);
+    if (source_.compare(pos_, length, op) == 0) {
+      token_.type = Token::Operator;
+      token_.text = op;
+      pos_ += length;
+      return true;
+    }
+  }
+
+  return fail(std::string("Unexpected character '") + c + "'");
+}
+
+std::unique_ptr<ThresholdRuleCompiler::Node> ThresholdRuleCompiler::makeBinary(
+  Op op, std::unique_ptr<Node> lhs, std::unique_ptr<Node> rhs)
+{
+  if (!lhs || !rhs) {
+    return nullptr;
+  }
+  auto node = std::make_unique<Node>();
+  node->kind = Node::Binary;
+  node->op = op;
+  node->lhs = std::move(lhs);
+  node->rhs = std::move(rhs);
+  return node;
+}
+
+std::unique_ptr<ThresholdRuleCompiler::Node> ThresholdRuleCompiler::parseOr()
+{
+  auto node = parseAnd();
+  while (node && (isOperator("||") || isWord("or"))) {
+    if (!next()) {
+      return nullptr;
+    }
+    node = makeBinary(Op::Or, std::move(node), parseAnd());
+  }
+  return node;
+}
+
+std::unique_ptr<ThresholdRuleCompiler::Node> ThresholdRuleCompiler::parseAnd()
+{
+  auto node = parseNot();
+  while (node && (isOperator("&&") || isWord("and"))) {
+    if (!next()) {
+      return nullptr;
+    }
+    node = makeBinary(Op::And, std::move(node), parseNot());
+  }
+  return node;
+}
+
+std::unique_ptr<ThresholdRuleCompiler::Node> ThresholdRuleCompiler::parseNot()
+{
+  // Binds looser than comparisons, "not a > b" is "not (a > b)"
+  if (!isOperator("!") && !isWord("not")) {
+    return parseComparison();
+  }
+  if (!next()) {
+    return nullptr;
+  }
+  auto operand = parseNot();
+  if (!operand) {
+    return nullptr;
+  }
+  auto node = std::make_unique<Node>();
+  node->kind = Node::Unary;
+  node->op = Op::Not;
+  node->lhs = std::move(operand);
+  return node;
+}
+
+std::unique_ptr<ThresholdRuleCompiler::Node> ThresholdRuleCompiler::parseComparison()
+{
+  auto node = parseSum();
+  if (!node || token_.type != Token::Operator) {
+    return node;
+  }
+
+  Op op;
+  if (token_.text == "<") {
+    op = Op::Lt;
+  } else if (token_.text == "<=") {
+    op = Op::Le;
+  } else if (token_.text == ">") {
+    op = Op::Gt;
+  } else if (token_.text == ">=") {
+    op = Op::Ge;
+  } else if (token_.text == "==") {
+    op = Op::Eq;
+  } else if (token_.text == "!=") {
+    op = Op::Ne;
+  } else {
+    return node;
+  }
+  if (!next()) {
+    return nullptr;
+  }
+  return makeBinary(op, std::move(node), parseSum());
+}
+
+std::unique_ptr<ThresholdRuleCompiler::Node> ThresholdRuleCompiler::parseSum()
+{
+  auto node = parseProduct();
+  while (node && (isOperator("+") || isOperator("-"))) {
+    Op op = isOperator("+") ? Op::Add : Op::Sub;
+    if (!next()) {
+      return nullptr;
+    }
+    node = makeBinary(op, std::move(node), parseProduct());
+  }
+  return node;
+}
+
+std::unique_ptr<ThresholdRuleCompiler::Node> ThresholdRuleCompiler::parseProduct()
+{
+  auto node = parseUnary();
+  while (node && (isOperator("*") || isOperator("/"))) {
+    Op op = isOperator("*") ? Op::Mul : Op::Div;
+    if (!next()) {
+      return nullptr;
+    }
+    node = makeBinary(op, std::move(node), parseUnary());
+  }
+  return node;
+}
+
+std::unique_ptr<ThresholdRuleCompiler::Node> ThresholdRuleCompiler::parseUnary()
+{
+  if (isOperator("-")) {
+    if (!next()) {
+      return nullptr;
+    }
+    auto operand = parseUnary();
+    if (!operand) {
+      return nullptr;
+    }
+    auto node = std::make_unique<Node>();
+    node->kind = Node::Unary;
+    node->op = Op::Neg;
+    node->lhs = std::move(operand);
+    return node;
+  }
+  return parsePrimary();
+}
+
+std::unique_ptr<ThresholdRuleCompiler::Node> ThresholdRuleCompiler::parsePrimary()
+{
+  if (isOperator("(")) {
+    if (!next()) {
+      return nullptr;
+    }
+    auto node = parseOr();
+    if (!node) {
+      return nullptr;
+    }
+    if (!isOperator(")")) {
+      fail("Expected ')'");
+      return nullptr;
+    }
+    if (!next()) {
+      return nullptr;
+    }
+    return node;
+  }
+
+  auto node = std::make_unique<Node>();
+  node->text = token_.text;
+  node->value = token_.value;
+  switch (token_.type) {
+    case Token::Number:
+      node->kind = Node::Number;
+      break;
+    case Token::String:
+      node->kind = Node::String;
+      break;
+    case Token::Key:
+      node->kind = Node::Key;
+      break;
+    case Token::Identifier:
+      if (token_.text == "level") {
+        node->kind = Node::Level;
+      } else if (token_.text == "age") {
+        node->kind = Node::Age;
+      } else if (token_.text == "message") {
+        node->kind = Node::Message;
+      } else if (token_.text == "hardware_id") {
+        node->kind = Node::HardwareId;
+      } else if (token_.text == "name") {
+        node->kind = Node::Name;
+      } else if (token_.text == "OK") {
+        node->kind = Node::Number;
+        node->value = Level_OK;
+      } else if (token_.text == "WARN") {
+        node->kind = Node::Number;
+        node->value = Level_Warn;
+      } else if (token_.text == "ERROR") {
+        node->kind = Node::Number;
+        node->value = Level_Error;
+      } else if (token_.text == "STALE") {
+        node->kind = Node::Number;
+        node->value = Level_Stale;
+      } else if (token_.text == "and" || token_.text == "or" || token_.text == "not" ||
+        token_.text == "for")
+      {
+        fail("Unexpected '" + token_.text + "'");
+        return nullptr;
+      } else {
+        node->kind = Node::Key;
+      }
+      break;
+    default:
+      fail(token_.type == Token::End ? "Unexpected end" : "Unexpected '" + token_.text + "'");
+      return nullptr;
+  }
+
+  if (!next()) {
+    return nullptr;
+  }
+  return node;
+}
+
+std::uint32_t ThresholdRuleCompiler::keyIndex(const std::string & key)
+{
+  auto it = std::find(rule_.keys_.begin(), rule_.keys_.end(), key);
+  if (it != rule_.keys_.end()) {
+    return static_cast<std::uint32_t>(it - rule_.keys_.begin());
+  }
+  rule_.keys_.push_back(key);
+  return static_cast<std::uint32_t>(rule_.keys_.size() - 1);
+}
+
+bool ThresholdRuleCompiler::emitStringComparison(Op op, const Node & field, const Node & literal)
+{
+  ThresholdRule::Instruction instruction{
+    op == Op::Eq ? Op::StringEq : Op::StringNe, Field::None,
+    static_cast<std::uint32_t>(rule_.strings_.size()), 0, 0.0};
+  switch (field.kind) {
+    case Node::Key:
+      instruction.field = Field::Key;
+      instruction.key = keyIndex(field.text);
+      break;
+    case Node::Message:
+      instruction.field = Field::Message;
+      break;
+    case Node::HardwareId:
+      instruction.field = Field::HardwareId;
+      break;
+    case Node::Name:
+      instruction.field = Field::Name;
+      break;
+    default:
+      error_ = "Only KeyValues, message, hardware_id and name can be compared to a string in '" +
+        source_ + "'";
+      return false;
+  }
+  rule_.strings_.push_back(literal.text);
+  rule_.code_.push_back(instruction);
+  return true;
+}
+
+bool ThresholdRuleCompiler::emit(const Node & node)
+{
+  ThresholdRule::Instruction instruction{node.op, Field::None, 0, 0, node.value};
+  switch (node.kind) {
+    case Node::Number:
+      instruction.op = Op::Number;
+      break;
+    case Node::Key:
+      instruction.op = Op::Key;
+      instruction.index = keyIndex(node.text);
+      break;
+    case Node::Level:
+      instruction.op = Op::Level;
+      break;
+    case Node::Age:
+      instruction.op = Op::Age;
+      rule_.uses_age_ = true;
+      break;
+    case Node::String:
+    case Node::Message:
+    case Node::HardwareId:
+    case Node::Name:
+      error_ = "Strings can only be compared with == or != in '" + source_ + "'";
+      return false;
+    case Node::Unary:
+      if (!emit(*node.lhs)) {
+        return false;
+      }
+      break;
+    case Node::Binary:
+      if (node.op == Op::Eq || node.op == Op::Ne) {
+        if (node.rhs->kind == Node::String) {
+          return emitStringComparison(node.op, *node.lhs, *node.rhs);
+        }
+        if (node.lhs->kind == Node::String) {
+          return emitStringComparison(node.op, *node.rhs, *node.lhs);
+        }
+      }
+      if (!emit(*node.lhs) || !emit(*node.rhs)) {
+        return false;
+      }
+      break;
+  }
+  rule_.code_.push_back(instruction);
+  return true;
+}
+
+bool ThresholdRuleCompiler::compile(std::string & error)
+{
+  rule_.code_.clear();
+  rule_.keys_.clear();
+  rule_.strings_.clear();
+  rule_.uses_age_ = false;
+  rule_.duration_ = 0.0;
+
+  if (!next()) {
+    error = error_;
+    return false;
+  }
+
+  if (isWord("OK")) {
+    rule_.level_ = Level_OK;
+  } else if (isWord("WARN")) {
+    rule_.level_ = Level_Warn;
+  } else if (isWord("ERROR")) {
+    rule_.level_ = Level_Error;
+  } else if (isWord("STALE")) {
+    rule_.level_ = Level_Stale;
+  } else {
+    fail("Expected OK, WARN, ERROR or STALE");
+    error = error_;
+    return false;
+  }
+  if (!next() || !isWord("if")) {
+    fail("Expected 'if'");
+    error = error_;
+    return false;
+  }
+  if (!next()) {
+    error = error_;
+    return false;
+  }
+  std::size_t condition_start = token_.pos;
+
+  auto condition = parseOr();
+  if (condition && isWord("for")) {
+    if (!next()) {
+      condition.reset();
+    } else if (token_.type != Token::Number) {
+      fail("Expected duration in seconds after 'for'");
+      condition.reset();
+    } else {
+      rule_.duration_ = token_.value;
+      if (next() && isWord("s")) {
+        next();
+      }
+    }
+  }
+  if (condition && token_.type != Token::End) {
+    fail("Unexpected '" + token_.text + "'");
+    condition.reset();
+  }
+  if (!condition || !emit(*condition)) {
+    error = error_;
+    return false;
+  }
+
+  // Simulate the stack to size it once
+  std::size_t depth = 0;
+  std::size_t max_depth = 0;
+  for (const auto & instruction : rule_.code_) {
+    switch (instruction.op) {
+      case Op::Number:
+      case Op::Key:
+      case Op::Level:
+      case Op::Age:
+      case Op::StringEq:
+      case Op::StringNe:
+        ++depth;
+        break;
+      case Op::Neg:
+      case Op::Not:
+        break;
+      default:
+        --depth;
+        break;
+    }
+    max_depth = std::max(max_depth, depth);
+  }
+  rule_.stack_.assign(max_depth, 0.0);
+
+  rule_.description_ = source_.substr(condition_start);
+  return true;
+}
+
+namespace
+{
+inline bool truth(double value)
+{
+  return value != 0.0 && !std::isnan(value);
+}
+}  // namespace
+
+ThresholdRule::ThresholdRule()
+: level_(Level_OK),
+  duration_(0.0),
+  uses_age_(false)
+{
+}
+
+bool ThresholdRule::compile(const std::string & source, std::string & error)
+{
+  ThresholdRuleCompiler compiler(*this, source);
+  return compiler.compile(error);
+}
+
+bool ThresholdRule::test(const StatusItem & item, double age) const
+{
+  if (code_.empty()) {
+    return false;
+  }
+
+  double * sp = stack_.data();
+  for (const Instruction & instruction : code_) {
+    switch (instruction.op) {
+      case Op::Number:
+        *sp++ = instruction.value;
+        break;
+      case Op::Key: {
+          double value;
+          *sp++ = item.getNumber(keys_[instruction.index], value) ?
+            value : std::numeric_limits<double>::quiet_NaN();
+          break;
+        }
+      case Op::Level:
+        *sp++ = item.getLevel();
+        break;
+      case Op::Age:
+        *sp++ = age;
+        break;
+      case Op::Neg:
+        sp[-1] = -sp[-1];
+        break;
+      case Op::Not:
+        sp[-1] = truth(sp[-1]) ? 0.0 : 1.0;
+        break;
+      case Op::StringEq:
+      case Op::StringNe: {
+          const std::string * value = nullptr;
+          switch (instruction.field) {
+            case Field::Key:
+              value = item.findValue(keys_[instruction.key]);
+              break;
+            case Field::Message:
+              value = &item.getMessage();
+              break;
+            case Field::HardwareId:
+              value = &item.getHwId();
+              break;
+            case Field::Name:
+              value = &item.getName();
+              break;
+            case Field::None:
+              break;
+          }
+          bool equal = value && *value == strings_[instruction.index];
+          *sp++ = (equal == (instruction.op == Op::StringEq)) ? 1.0 : 0.0;
+          break;
+        }
+      default: {
+          double rhs = *--sp;
+          double & lhs = sp[-1];
+          switch (instruction.op) {
+            case Op::Add:
+              lhs += rhs;
+              break;
+            case Op::Sub:
+              lhs -= rhs;
+              break;
+            case Op::Mul:
+              lhs *= rhs;
+              break;
+            case Op::Div:
+              lhs /= rhs;
+              break;
+            case Op::Lt:
+              lhs = lhs < rhs;
+              break;
+            case Op::Le:
+              lhs = lhs <= rhs;
+              break;
+            case Op::Gt:
+              lhs = lhs > rhs;
+              break;
+            case Op::Ge:
+              lhs = lhs >= rhs;
+              break;
+            case Op::Eq:
+              lhs = lhs == rhs;
+              break;
+            case Op::Ne:
+              lhs = lhs != rhs;
+              break;
+            case Op::And:
+              lhs = truth(lhs) && truth(rhs);
+              break;
+            case Op::Or:
+              lhs = truth(lhs) || truth(rhs);
+              break;
+            default:
+              break;
+          }
+          break;
+        }
+    }
+  }
+  return truth(stack_[0]);
+}
+
+}  // namespace diagnostic_aggregator
@@ -0,0 +1,99 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "diagnostic_aggregator/window_statistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace diagnostic_aggregator
+{
+WindowStatistics::WindowStatistics(double window)
+: window_(static_cast<std::int64_t>(window * 1e9)),
+  sum_(0.0)
+{
+}
+
+void WindowStatistics::add(const rclcpp::Time & stamp, double value)
+{
+  std::int64_t now = stamp.nanoseconds();
+
+  while (!samples_.empty() && samples_.front().first <= now - window_) {
+    sum_ -= samples_.front().second;
+    samples_.pop_front();
+  }
+  while (!min_.empty() && min_.front().first <= now - window_) {
+    min_.pop_front();
+  }
+  while (!max_.empty() && max_.front().first <= now - window_) {
+    max_.pop_front();
+  }
+  if (samples_.empty()) {
+    // Don't carry rounding errors over
+    sum_ = 0.0;
+  }
+
+  samples_.emplace_back(now, value);
+  sum_ += value;
+
+  while (!min_.empty() && min_.back().second >= value) {
+    min_.pop_back();
+  }
+  min_.emplace_back(now, value);
+  while (!max_.empty() && max_.back().second <= value) {
+    max_.pop_back();
+  }
+  max_.emplace_back(now, value);
+}
+
+double WindowStatistics::percentile(double p) const
+{
+  if (samples_.empty()) {
+    return 0.0;
+  }
+
+  scratch_.clear();
+  for (const auto & sample : samples_) {
+    scratch_.push_back(sample.second);
+  }
+
+  p = std::min(std::max(p, 0.0), 1.0);
+  std::size_t rank = static_cast<std::size_t>(std::ceil(p * scratch_.size()));
+  std::size_t index = rank > 0 ? rank - 1 : 0;
+  std::nth_element(scratch_.begin(), scratch_.begin() + index, scratch_.end());
+  return scratch_[index];
+}
+
+}  // namespace diagnostic_aggregator
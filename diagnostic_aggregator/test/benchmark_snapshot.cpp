@@ -0,0 +1,159 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/*
+ * Compares reading the aggregated tree from the shared-memory snapshot with
+ * deserializing it, as every subscriber of /diagnostics_agg does per tick.
+ * The transport of the subscription isn't included, so the gap to a real
+ * subscription is even larger.
+ * Not run as a test, run it manually: benchmark_snapshot [ITERATIONS]
+ */
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/snapshot_reader.hpp"
+#include "diagnostic_aggregator/snapshot_writer.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+#include "diagnostic_msgs/msg/key_value.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/serialization.hpp"
+
+using diagnostic_aggregator::Snapshot;
+using diagnostic_aggregator::SnapshotReader;
+using diagnostic_aggregator::SnapshotWriter;
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+std::vector<std::shared_ptr<DiagnosticStatus>> makeTree(int count)
+{
+  std::vector<std::shared_ptr<DiagnosticStatus>> tree;
+  for (int i = 0; i < count; ++i) {
+    auto status = std::make_shared<DiagnosticStatus>();
+    status->name = "/Robot/Sensors/Group " + std::to_string(i / 10) + "/Item " +
+      std::to_string(i);
+    status->level = DiagnosticStatus::OK;
+    status->message = "OK";
+    status->hardware_id = "device_" + std::to_string(i / 10);
+    for (const char * key : {"Voltage", "Current", "Temperature", "Frequency", "Errors"}) {
+      diagnostic_msgs::msg::KeyValue kv;
+      kv.key = key;
+      kv.value = std::to_string(40.0 + (i % 50));
+      status->values.push_back(kv);
+    }
+    tree.push_back(status);
+  }
+  return tree;
+}
+
+template<class F>
+double microsecondsPer(int iterations, F && f)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    f(i);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 10000;
+  std::string name = "/benchmark_snapshot_" + std::to_string(getpid());
+  rclcpp::Time stamp(0, 0, RCL_ROS_TIME);
+
+  for (int count : {100, 1000}) {
+    auto tree = makeTree(count);
+    SnapshotWriter writer(name, 16 * 1024 * 1024);
+    if (!writer.write(tree, stamp)) {
+      std::fprintf(stderr, "Couldn't export the snapshot\n");
+      return 1;
+    }
+    SnapshotReader reader;
+    if (!reader.open(name)) {
+      std::fprintf(stderr, "Couldn't open the snapshot\n");
+      return 1;
+    }
+
+    DiagnosticArray array;
+    for (const auto & status : tree) {
+      array.status.push_back(*status);
+    }
+    rclcpp::Serialization<DiagnosticArray> serialization;
+    rclcpp::SerializedMessage serialized;
+    serialization.serialize_message(&array, &serialized);
+
+    // Every reader looks at all levels and names, like a dashboard would
+    size_t visited = 0;
+    double write = microsecondsPer(
+      iterations, [&](int) {
+        writer.write(tree, stamp);
+      });
+    Snapshot snapshot;
+    double read = microsecondsPer(
+      iterations, [&](int) {
+        reader.read(snapshot);
+        for (size_t i = 0; i < snapshot.size(); ++i) {
+          visited += snapshot[i].getLevel() + snapshot[i].getName().size();
+        }
+      });
+    double deserialize = microsecondsPer(
+      iterations, [&](int) {
+        DiagnosticArray received;
+        serialization.deserialize_message(&serialized, &received);
+        for (const auto & status : received.status) {
+          visited += status.level + status.name.size();
+        }
+      });
+
+    std::printf("%d statuses, %zu bytes serialized (%zu)\n", count, serialized.size(), visited);
+    std::printf("  snapshot write (aggregator): %8.2f us/tree\n", write);
+    std::printf("  snapshot read:               %8.2f us/tree\n", read);
+    std::printf("  deserialize (subscriber):    %8.2f us/tree\n", deserialize);
+  }
+  return 0;
+}
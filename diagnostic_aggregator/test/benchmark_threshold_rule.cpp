@@ -0,0 +1,151 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/*
+ * Measures the cost of evaluating ThresholdAnalyzer rules per item.
+ * Not run as a test, run it manually: benchmark_threshold_rule [ITERATIONS]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/status_item.hpp"
+#include "diagnostic_aggregator/threshold_rule.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+#include "diagnostic_msgs/msg/key_value.hpp"
+
+using diagnostic_aggregator::StatusItem;
+using diagnostic_aggregator::ThresholdRule;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+DiagnosticStatus makeStatus(int i)
+{
+  DiagnosticStatus status;
+  status.name = "motor: Left";
+  status.level = DiagnosticStatus::OK;
+  status.message = "OK";
+  status.hardware_id = "motor_1";
+  const char * keys[] = {
+    "Voltage", "Current", "Position", "Velocity", "Effort", "Mode", "Errors", "Temperature",
+    "Actual frequency", "Target frequency"};
+  for (const char * key : keys) {
+    diagnostic_msgs::msg::KeyValue kv;
+    kv.key = key;
+    kv.value = std::to_string(40.0 + (i % 50));
+    status.values.push_back(kv);
+  }
+  return status;
+}
+
+template<class F>
+double nanosecondsPer(int iterations, F && f)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    f(i);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+  const char * sources[] = {
+    "ERROR if Temperature > 80 for 5",
+    "WARN if Temperature > 60",
+    "WARN if `Actual frequency` < 0.9 * `Target frequency` || age > 2",
+    "ERROR if message == 'Disconnected'"};
+  std::vector<ThresholdRule> rules;
+  for (const char * source : sources) {
+    ThresholdRule rule;
+    std::string error;
+    if (!rule.compile(source, error)) {
+      std::fprintf(stderr, "%s\n", error.c_str());
+      return 1;
+    }
+    rules.push_back(rule);
+  }
+
+  std::vector<DiagnosticStatus> statuses;
+  for (int i = 0; i < 64; ++i) {
+    statuses.push_back(makeStatus(i));
+  }
+  std::vector<std::unique_ptr<StatusItem>> items;
+  for (const auto & status : statuses) {
+    items.push_back(std::make_unique<StatusItem>(&status));
+  }
+
+  int fired = 0;
+  auto evaluate = [&](const StatusItem & item) {
+      for (const auto & rule : rules) {
+        fired += rule.test(item, 0.5);
+      }
+    };
+
+  // Values are parsed on the first evaluation after an update, so this
+  // includes parsing the ten values of every new item.
+  double update = nanosecondsPer(
+    iterations / 10, [&](int i) {
+      StatusItem item(&statuses[i % statuses.size()]);
+      evaluate(item);
+    });
+  // Repeated evaluation of the same items, as on report
+  double steady = nanosecondsPer(
+    iterations, [&](int i) {
+      evaluate(*items[i % items.size()]);
+    });
+  double compile = nanosecondsPer(
+    iterations / 100, [&](int i) {
+      ThresholdRule rule;
+      std::string error;
+      rule.compile(sources[i % 4], error);
+    });
+
+  std::printf("%zu rules, %zu values per item (%d fired)\n", rules.size(),
+    statuses[0].values.size(), fired);
+  std::printf("new item, parse and evaluate: %8.1f ns/item\n", update);
+  std::printf("evaluate parsed item:         %8.1f ns/item\n", steady);
+  std::printf("compile (once at init):       %8.1f ns/rule\n", compile);
+  return 0;
+}
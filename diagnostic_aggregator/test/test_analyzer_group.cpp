@@ -0,0 +1,194 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/analyzer.hpp"
+#include "diagnostic_aggregator/analyzer_group.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+using diagnostic_aggregator::Analyzer;
+using diagnostic_aggregator::AnalyzerGroup;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+/// Reports a single status with a fixed level and counts its reports
+class CountingAnalyzer : public Analyzer
+{
+public:
+  CountingAnalyzer(const std::string & path, unsigned char level)
+  : path_(path), level_(level), reports_(0) {}
+
+  bool init(const std::string &, const std::string &, const rclcpp::Node::SharedPtr)
+  {
+    return true;
+  }
+  bool match(const std::string &) {return false;}
+  bool analyze(const std::shared_ptr<diagnostic_aggregator::StatusItem>) {return false;}
+
+  std::vector<std::shared_ptr<DiagnosticStatus>> report()
+  {
+    ++reports_;
+    auto status = std::make_shared<DiagnosticStatus>();
+    status->name = path_;
+    status->level = level_;
+    return {status};
+  }
+
+  std::string getPath() const {return path_;}
+  std::string getName() const {return path_.substr(path_.rfind('/') + 1);}
+
+  std::string path_;
+  unsigned char level_;
+  int reports_;
+};
+
+std::vector<std::string> names(const std::vector<std::shared_ptr<DiagnosticStatus>> & statuses)
+{
+  std::vector<std::string> out;
+  for (const auto & status : statuses) {
+    out.push_back(status->name);
+  }
+  return out;
+}
+
+class AnalyzerGroupSchedule : public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+    node_ = std::make_shared<rclcpp::Node>("test_analyzer_group");
+    // Without analyzer parameters init fails, but sets up the path of the group
+    group_.init("/Robot", "", node_);
+    fast_ = std::make_shared<CountingAnalyzer>("/Robot/Fast", DiagnosticStatus::OK);
+    slow_ = std::make_shared<CountingAnalyzer>("/Robot/Slow", DiagnosticStatus::ERROR);
+    std::shared_ptr<Analyzer> fast = fast_, slow = slow_;
+    group_.addAnalyzer(fast, 10.0);
+    group_.addAnalyzer(slow, 0.2);
+  }
+
+  rclcpp::Node::SharedPtr node_;
+  AnalyzerGroup group_;
+  std::shared_ptr<CountingAnalyzer> fast_, slow_;
+};
+}  // namespace
+
+TEST_F(AnalyzerGroupSchedule, reportsOnlyDueAnalyzers)
+{
+  EXPECT_DOUBLE_EQ(0.1, group_.setPeriod(1.0));
+  group_.setTick(0.1);
+
+  std::vector<std::shared_ptr<DiagnosticStatus>> due;
+  ASSERT_TRUE(group_.reportDue(0, false, due));
+  EXPECT_EQ((std::vector<std::string>{"/Robot/Fast", "/Robot/Slow", "/Robot"}), names(due));
+
+  for (uint64_t tick = 1; tick < 50; ++tick) {
+    due.clear();
+    ASSERT_TRUE(group_.reportDue(tick, false, due));
+    EXPECT_EQ((std::vector<std::string>{"/Robot/Fast", "/Robot"}), names(due));
+    // The cached error of the slow analyzer still counts for the header
+    EXPECT_EQ(DiagnosticStatus::ERROR, due.back()->level);
+  }
+  EXPECT_EQ(50, fast_->reports_);
+  EXPECT_EQ(1, slow_->reports_);
+  EXPECT_EQ(
+    (std::vector<std::string>{"/Robot/Fast", "/Robot/Slow", "/Robot"}),
+    names(group_.getOutput()));
+
+  due.clear();
+  ASSERT_TRUE(group_.reportDue(50, false, due));
+  EXPECT_EQ(2, slow_->reports_);
+
+  due.clear();
+  ASSERT_TRUE(group_.reportDue(51, true, due));
+  EXPECT_EQ(3, slow_->reports_);
+}
+
+TEST_F(AnalyzerGroupSchedule, nestedGroupsInheritTheirPeriod)
+{
+  auto sub = std::make_shared<AnalyzerGroup>();
+  sub->init("/Robot/Inventory", "", node_);
+  auto part = std::make_shared<CountingAnalyzer>("/Robot/Inventory/Parts", DiagnosticStatus::OK);
+  std::shared_ptr<Analyzer> analyzer = part;
+  sub->addAnalyzer(analyzer);
+  analyzer = sub;
+  group_.addAnalyzer(analyzer, 0.5);
+
+  EXPECT_DOUBLE_EQ(0.1, group_.setPeriod(1.0));
+  group_.setTick(0.1);
+
+  std::vector<std::shared_ptr<DiagnosticStatus>> due;
+  for (uint64_t tick = 0; tick < 40; ++tick) {
+    group_.reportDue(tick, false, due);
+  }
+  EXPECT_EQ(2, part->reports_);
+
+  // Nothing below the subgroup is due, so it doesn't report its header either
+  due.clear();
+  EXPECT_FALSE(sub->reportDue(41, false, due));
+  EXPECT_TRUE(due.empty());
+}
+
+TEST_F(AnalyzerGroupSchedule, roundsPeriodsToTicks)
+{
+  std::shared_ptr<Analyzer> medium =
+    std::make_shared<CountingAnalyzer>("/Robot/Medium", DiagnosticStatus::OK);
+  group_.addAnalyzer(medium, 3.0);
+  group_.setPeriod(1.0);
+  group_.setTick(0.1);
+
+  std::vector<std::shared_ptr<DiagnosticStatus>> due;
+  for (uint64_t tick = 0; tick < 30; ++tick) {
+    group_.reportDue(tick, false, due);
+  }
+  // 1/3 s is closest to 3 ticks
+  EXPECT_EQ(10, std::static_pointer_cast<CountingAnalyzer>(medium)->reports_);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  rclcpp::init(argc, argv);
+  int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
@@ -0,0 +1,296 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/archive_format.hpp"
+#include "diagnostic_aggregator/archive_reader.hpp"
+#include "diagnostic_aggregator/archive_writer.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+#include "diagnostic_msgs/msg/key_value.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+using diagnostic_aggregator::ArchiveReader;
+using diagnostic_aggregator::ArchiveWriter;
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+using diagnostic_msgs::msg::KeyValue;
+
+namespace
+{
+struct Recorded
+{
+  std::string topic;
+  rclcpp::Time stamp;
+  DiagnosticArray msg;
+};
+
+std::string archiveFile(const std::string & test)
+{
+  return "/tmp/test_archive_" + test + "_" + std::to_string(getpid()) + ".darc";
+}
+
+KeyValue makeValue(const std::string & key, const std::string & value)
+{
+  KeyValue kv;
+  kv.key = key;
+  kv.value = value;
+  return kv;
+}
+
+/// A stream like the one of a robot: slowly changing values, few level changes
+std::vector<Recorded> makeStream(std::size_t messages, std::size_t statuses)
+{
+  std::vector<Recorded> stream;
+  for (std::size_t m = 0; m < messages; ++m) {
+    Recorded recorded;
+    recorded.topic = m % 2 ? "/diagnostics_agg" : "/diagnostics";
+    recorded.stamp = rclcpp::Time(1000000000000LL + m * 500000000LL, RCL_ROS_TIME);
+    recorded.msg.header.stamp = rclcpp::Time(recorded.stamp.nanoseconds() - 1000, RCL_ROS_TIME);
+    for (std::size_t s = 0; s < statuses; ++s) {
+      DiagnosticStatus status;
+      status.name = recorded.topic + "/Robot/Sensors/Device " + std::to_string(s);
+      status.hardware_id = "device_" + std::to_string(s);
+      status.level = (m / 50 + s) % 7 == 0 ? DiagnosticStatus::WARN : DiagnosticStatus::OK;
+      status.message = status.level ? "Temperature high" : "OK";
+      status.values.push_back(makeValue("Temperature", std::to_string(40 + (m + s) % 10) + ".5"));
+      status.values.push_back(makeValue("Frames", std::to_string(m * 30 + s)));
+      status.values.push_back(makeValue("Voltage", m % 3 ? "12.04" : "11.98"));
+      status.values.push_back(makeValue("Mode", s % 2 ? "active" : "standby"));
+      status.values.push_back(makeValue("Firmware", "v1.2.3"));
+      recorded.msg.status.push_back(status);
+    }
+    stream.push_back(recorded);
+  }
+  return stream;
+}
+
+/// Bytes of the strings and levels of a message, less than any serialization needs
+std::size_t rawSize(const DiagnosticArray & msg)
+{
+  std::size_t size = 0;
+  for (const auto & status : msg.status) {
+    size += 1 + status.name.size() + status.message.size() + status.hardware_id.size();
+    for (const auto & kv : status.values) {
+      size += kv.key.size() + kv.value.size();
+    }
+  }
+  return size;
+}
+
+void expectEqual(const Recorded & expected, const Recorded & actual)
+{
+  EXPECT_EQ(expected.topic, actual.topic);
+  EXPECT_EQ(expected.stamp.nanoseconds(), actual.stamp.nanoseconds());
+  EXPECT_EQ(
+    rclcpp::Time(expected.msg.header.stamp).nanoseconds(),
+    rclcpp::Time(actual.msg.header.stamp).nanoseconds());
+  EXPECT_EQ(expected.msg.header.frame_id, actual.msg.header.frame_id);
+  ASSERT_EQ(expected.msg.status.size(), actual.msg.status.size());
+  for (std::size_t i = 0; i < expected.msg.status.size(); ++i) {
+    const auto & a = expected.msg.status[i];
+    const auto & b = actual.msg.status[i];
+    EXPECT_EQ(a.name, b.name);
+    EXPECT_EQ(a.level, b.level);
+    EXPECT_EQ(a.message, b.message);
+    EXPECT_EQ(a.hardware_id, b.hardware_id);
+    ASSERT_EQ(a.values.size(), b.values.size()) << a.name;
+    for (std::size_t j = 0; j < a.values.size(); ++j) {
+      EXPECT_EQ(a.values[j].key, b.values[j].key);
+      EXPECT_EQ(a.values[j].value, b.values[j].value);
+    }
+  }
+}
+
+std::vector<Recorded> writeAndReadBack(
+  const std::string & file, const std::vector<Recorded> & stream, std::size_t block_size)
+{
+  ArchiveWriter writer(block_size);
+  EXPECT_TRUE(writer.open(file));
+  for (const auto & recorded : stream) {
+    EXPECT_TRUE(writer.write(recorded.topic, recorded.stamp, recorded.msg));
+  }
+  EXPECT_TRUE(writer.close());
+
+  std::vector<Recorded> result;
+  ArchiveReader reader;
+  EXPECT_TRUE(reader.open(file));
+  Recorded recorded;
+  while (reader.read(recorded.topic, recorded.stamp, recorded.msg)) {
+    result.push_back(recorded);
+  }
+  return result;
+}
+}  // namespace
+
+TEST(Archive, Decimals)
+{
+  using diagnostic_aggregator::archive::formatDecimal;
+  using diagnostic_aggregator::archive::parseDecimal;
+  std::int64_t mantissa;
+  std::uint8_t scale;
+  for (std::string text : {"0", "7", "-12", "0.5", "-0.05", "12.340", "999999999999999999"}) {
+    ASSERT_TRUE(parseDecimal(text, mantissa, scale)) << text;
+    EXPECT_EQ(text, formatDecimal(mantissa, scale));
+  }
+  // Everything that wouldn't be reproduced exactly is kept as text
+  for (std::string text : {"", "-", "007", "-0", "-0.0", ".5", "5.", "1e5", "nan", "1.2.3", "+1",
+      "1 ", "9999999999999999999"})
+  {
+    EXPECT_FALSE(parseDecimal(text, mantissa, scale)) << text;
+  }
+}
+
+TEST(Archive, RoundTrip)
+{
+  std::vector<Recorded> stream = makeStream(400, 20);
+
+  // Keys, values and statuses that come and go
+  stream[10].msg.status[3].values.pop_back();
+  stream[11].msg.status[3].values.push_back(makeValue("New key", "-0.25"));
+  stream[12].msg.status[3].values[1].value = "not a number";
+  stream[13].msg.status[3].values[1].value = "";
+  stream[14].msg.status[3].values[1].value = "0042";
+  stream[20].msg.status.erase(stream[20].msg.status.begin() + 5);
+  stream[30].msg.status[0].level = DiagnosticStatus::STALE;
+  stream[31].msg.header.frame_id = "base_link";
+  stream[40].msg.status.clear();
+
+  // Small blocks, so many block boundaries are crossed
+  std::string file = archiveFile("round_trip");
+  std::vector<Recorded> result = writeAndReadBack(file, stream, 4096);
+  ASSERT_EQ(stream.size(), result.size());
+  for (std::size_t i = 0; i < stream.size(); ++i) {
+    SCOPED_TRACE(i);
+    expectEqual(stream[i], result[i]);
+  }
+
+  ArchiveReader reader;
+  ASSERT_TRUE(reader.open(file));
+  EXPECT_GT(reader.getBlockCount(), 3u);
+  rclcpp::Time first, last;
+  ASSERT_TRUE(reader.getTimeRange(first, last));
+  EXPECT_EQ(stream.front().stamp.nanoseconds(), first.nanoseconds());
+  EXPECT_EQ(stream.back().stamp.nanoseconds(), last.nanoseconds());
+  std::remove(file.c_str());
+}
+
+TEST(Archive, Seek)
+{
+  std::vector<Recorded> stream = makeStream(400, 20);
+  std::string file = archiveFile("seek");
+  writeAndReadBack(file, stream, 4096);
+
+  ArchiveReader reader;
+  ASSERT_TRUE(reader.open(file));
+  Recorded recorded;
+  for (std::size_t i : {0, 1, 123, 250, 399}) {
+    SCOPED_TRACE(i);
+    // Between two messages, the later one is found
+    ASSERT_TRUE(reader.seek(rclcpp::Time(stream[i].stamp.nanoseconds() - 1, RCL_ROS_TIME)));
+    ASSERT_TRUE(reader.read(recorded.topic, recorded.stamp, recorded.msg));
+    expectEqual(stream[i], recorded);
+    if (i + 1 < stream.size()) {
+      ASSERT_TRUE(reader.read(recorded.topic, recorded.stamp, recorded.msg));
+      expectEqual(stream[i + 1], recorded);
+    }
+  }
+  EXPECT_FALSE(reader.seek(rclcpp::Time(stream.back().stamp.nanoseconds() + 1, RCL_ROS_TIME)));
+  std::remove(file.c_str());
+}
+
+TEST(Archive, WithoutIndex)
+{
+  std::vector<Recorded> stream = makeStream(100, 10);
+  std::string file = archiveFile("without_index");
+  writeAndReadBack(file, stream, 2048);
+
+  std::size_t blocks;
+  {
+    ArchiveReader reader;
+    ASSERT_TRUE(reader.open(file));
+    blocks = reader.getBlockCount();
+  }
+
+  // Cut off the index and the footer, as if the writer crashed
+  FILE * f = std::fopen(file.c_str(), "rb");
+  ASSERT_NE(nullptr, f);
+  std::fseek(f, 0, SEEK_END);
+  long size = std::ftell(f);  // NOLINT(runtime/int)
+  std::fclose(f);
+  ASSERT_EQ(0, truncate(file.c_str(), size - 32 - blocks * 32 - 1));
+
+  // Every complete block is still found
+  ArchiveReader reader;
+  ASSERT_TRUE(reader.open(file));
+  EXPECT_EQ(blocks - 1, reader.getBlockCount());
+  Recorded recorded;
+  std::size_t count = 0;
+  while (reader.read(recorded.topic, recorded.stamp, recorded.msg)) {
+    expectEqual(stream[count++], recorded);
+  }
+  EXPECT_GT(count, 0u);
+  EXPECT_LT(count, stream.size());
+  std::remove(file.c_str());
+}
+
+TEST(Archive, Size)
+{
+  std::vector<Recorded> stream = makeStream(2000, 50);
+  std::size_t raw = 0;
+  for (const auto & recorded : stream) {
+    raw += rawSize(recorded.msg);
+  }
+
+  std::string file = archiveFile("size");
+  ArchiveWriter writer;
+  ASSERT_TRUE(writer.open(file));
+  for (const auto & recorded : stream) {
+    ASSERT_TRUE(writer.write(recorded.topic, recorded.stamp, recorded.msg));
+  }
+  ASSERT_TRUE(writer.close());
+
+  double ratio = static_cast<double>(raw) / writer.getFileSize();
+  EXPECT_GT(ratio, 20.0);
+  std::remove(file.c_str());
+}
@@ -0,0 +1,163 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/aggregator.hpp"
+#include "diagnostic_aggregator/snapshot_reader.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+using diagnostic_aggregator::Aggregator;
+using diagnostic_aggregator::CriticalLatency;
+using diagnostic_aggregator::Snapshot;
+using diagnostic_aggregator::SnapshotReader;
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+/// The aggregator exports its tree to this shared memory, see main()
+const std::string kSnapshotName = "/test_critical_latency_" + std::to_string(getpid());
+
+DiagnosticStatus makeStatus(const std::string & name, unsigned char level)
+{
+  DiagnosticStatus status;
+  status.name = name;
+  status.level = level;
+  return status;
+}
+
+/// Level of the status whose name ends with suffix, -1 if there is none
+int findLevel(const Snapshot & snapshot, const std::string & suffix)
+{
+  for (std::size_t i = 0; i < snapshot.size(); ++i) {
+    std::string name(snapshot[i].getName());
+    if (name.size() >= suffix.size() &&
+      name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+    {
+      return snapshot[i].getLevel();
+    }
+  }
+  return -1;
+}
+}  // namespace
+
+TEST(CriticalLatency, ErrorFirst)
+{
+  Aggregator agg;
+  SnapshotReader reader;
+  ASSERT_TRUE(reader.open(kSnapshotName));
+  Snapshot snapshot;
+
+  auto msg = std::make_shared<DiagnosticArray>();
+  msg->status.push_back(makeStatus("/motor", DiagnosticStatus::OK));
+  agg.diagCallback(msg);
+  agg.publishData();
+  EXPECT_EQ(0u, agg.getCriticalLatency().reports);
+
+  // The error arrives behind many OK statuses, and is reported before they
+  // are analyzed
+  msg = std::make_shared<DiagnosticArray>();
+  for (int i = 0; i < 1000; ++i) {
+    msg->status.push_back(makeStatus("/sensor_" + std::to_string(i), DiagnosticStatus::OK));
+  }
+  msg->status.push_back(makeStatus("/motor", DiagnosticStatus::ERROR));
+  agg.diagCallback(msg);
+
+  ASSERT_TRUE(reader.read(snapshot));
+  EXPECT_EQ(DiagnosticStatus::ERROR, findLevel(snapshot, "motor"));
+  EXPECT_EQ(-1, findLevel(snapshot, "sensor_0"));
+
+  CriticalLatency latency = agg.getCriticalLatency();
+  EXPECT_EQ(1u, latency.reports);
+  EXPECT_GT(latency.max.count(), 0);
+  EXPECT_EQ(latency.max, latency.total);
+
+  // The next publication has the rest
+  agg.publishData();
+  ASSERT_TRUE(reader.read(snapshot));
+  EXPECT_EQ(DiagnosticStatus::OK, findLevel(snapshot, "sensor_0"));
+  EXPECT_EQ(DiagnosticStatus::ERROR, findLevel(snapshot, "motor"));
+}
+
+TEST(CriticalLatency, NewestStatusWins)
+{
+  Aggregator agg;
+  SnapshotReader reader;
+  ASSERT_TRUE(reader.open(kSnapshotName));
+  Snapshot snapshot;
+
+  auto msg = std::make_shared<DiagnosticArray>();
+  msg->status.push_back(makeStatus("/wheel", DiagnosticStatus::OK));
+  agg.diagCallback(msg);
+  agg.publishData();
+
+  // A batch of several arrays of the ingest queue holds their statuses in
+  // order, like this array. The warning goes first, the older OK must not
+  // overwrite it afterwards.
+  msg = std::make_shared<DiagnosticArray>();
+  msg->status.push_back(makeStatus("/wheel", DiagnosticStatus::OK));
+  msg->status.push_back(makeStatus("/wheel", DiagnosticStatus::WARN));
+  agg.diagCallback(msg);
+
+  ASSERT_TRUE(reader.read(snapshot));
+  EXPECT_EQ(DiagnosticStatus::WARN, findLevel(snapshot, "wheel"));
+  EXPECT_EQ(1u, agg.getCriticalLatency().reports);
+
+  agg.publishData();
+  ASSERT_TRUE(reader.read(snapshot));
+  EXPECT_EQ(DiagnosticStatus::WARN, findLevel(snapshot, "wheel"));
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  std::string snapshot_param = "snapshot.name:=" + kSnapshotName;
+  std::vector<const char *> args(argv, argv + argc);
+  args.insert(args.end(), {"--ros-args", "-p", "critical:=true", "-p", snapshot_param.c_str()});
+  rclcpp::init(static_cast<int>(args.size()), args.data());
+  int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
@@ -0,0 +1,175 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/federated_analyzer.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+using diagnostic_aggregator::FederatedAnalyzer;
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+DiagnosticStatus makeStatus(const std::string & name, unsigned char level)
+{
+  DiagnosticStatus status;
+  status.name = name;
+  status.level = level;
+  status.message = diagnostic_aggregator::valToMsg(level);
+  return status;
+}
+
+DiagnosticArray makeTree()
+{
+  DiagnosticArray tree;
+  tree.status.push_back(makeStatus("/Sensors/Lidar", DiagnosticStatus::OK));
+  tree.status.push_back(makeStatus("/Sensors/Camera", DiagnosticStatus::WARN));
+  tree.status.push_back(makeStatus("/Sensors", DiagnosticStatus::WARN));
+  tree.status.push_back(makeStatus("/Motors", DiagnosticStatus::OK));
+  return tree;
+}
+
+const DiagnosticStatus * find(
+  const std::vector<std::shared_ptr<DiagnosticStatus>> & statuses, const std::string & name)
+{
+  for (const auto & status : statuses) {
+    if (status->name == name) {
+      return status.get();
+    }
+  }
+  return nullptr;
+}
+
+rclcpp::Time now()
+{
+  return rclcpp::Clock().now();
+}
+}  // namespace
+
+TEST(FederatedAnalyzer, reportsChildTreeBelowPrefix)
+{
+  FederatedAnalyzer analyzer;
+  ASSERT_TRUE(analyzer.init("/Fleet", "robot1", 5.0));
+  EXPECT_FALSE(analyzer.match("/Sensors/Lidar"));
+  EXPECT_EQ("/Fleet/robot1", analyzer.getPath());
+
+  EXPECT_EQ(DiagnosticStatus::WARN, analyzer.update(makeTree()));
+  auto processed = analyzer.report();
+  ASSERT_EQ(5u, processed.size());
+  ASSERT_NE(nullptr, find(processed, "/Fleet/robot1/Sensors/Lidar"));
+  EXPECT_EQ(DiagnosticStatus::WARN, find(processed, "/Fleet/robot1/Sensors/Camera")->level);
+
+  // The header only summarizes the toplevel statuses of the child
+  const DiagnosticStatus * header = find(processed, "/Fleet/robot1");
+  ASSERT_NE(nullptr, header);
+  EXPECT_EQ(DiagnosticStatus::WARN, header->level);
+  ASSERT_EQ(2u, header->values.size());
+  EXPECT_EQ("Motors", header->values[0].key);
+  EXPECT_EQ("Sensors", header->values[1].key);
+}
+
+TEST(FederatedAnalyzer, mergesDeltas)
+{
+  FederatedAnalyzer analyzer;
+  analyzer.init("/Fleet", "robot1", 5.0);
+  analyzer.update(makeTree());
+  auto before = analyzer.report();
+
+  DiagnosticArray delta;
+  delta.status.push_back(makeStatus("/Sensors/Camera", DiagnosticStatus::ERROR));
+  delta.status.push_back(makeStatus("/Sensors", DiagnosticStatus::ERROR));
+  EXPECT_EQ(DiagnosticStatus::ERROR, analyzer.update(delta));
+
+  auto processed = analyzer.report();
+  EXPECT_EQ(4u, analyzer.getStatusCount());
+  EXPECT_EQ(DiagnosticStatus::ERROR, find(processed, "/Fleet/robot1/Sensors/Camera")->level);
+  EXPECT_EQ(DiagnosticStatus::OK, find(processed, "/Fleet/robot1/Motors")->level);
+  EXPECT_EQ(DiagnosticStatus::ERROR, find(processed, "/Fleet/robot1")->level);
+
+  // Statuses handed out by the previous report are left untouched
+  EXPECT_EQ(DiagnosticStatus::WARN, find(before, "/Fleet/robot1/Sensors/Camera")->level);
+}
+
+TEST(FederatedAnalyzer, marksStatusesTheChildNoLongerSendsStale)
+{
+  FederatedAnalyzer analyzer;
+  analyzer.init("/Fleet", "robot1", 5.0);
+  analyzer.update(makeTree(), now() - rclcpp::Duration(10, 0));
+
+  DiagnosticArray update;
+  update.status.push_back(makeStatus("/Motors", DiagnosticStatus::OK));
+  analyzer.update(update);
+
+  auto processed = analyzer.report();
+  EXPECT_EQ(4u, analyzer.getStatusCount());
+  EXPECT_EQ(DiagnosticStatus::STALE, find(processed, "/Fleet/robot1/Sensors")->level);
+  EXPECT_EQ(DiagnosticStatus::STALE, find(processed, "/Fleet/robot1/Sensors/Camera")->level);
+  EXPECT_EQ("Warning", find(processed, "/Fleet/robot1/Sensors/Camera")->message);
+  EXPECT_EQ(DiagnosticStatus::OK, find(processed, "/Fleet/robot1/Motors")->level);
+  // Some stale toplevel statuses are an error, like in the analyzers
+  EXPECT_EQ(DiagnosticStatus::ERROR, find(processed, "/Fleet/robot1")->level);
+
+  // Sending them again brings them back
+  analyzer.update(makeTree());
+  processed = analyzer.report();
+  EXPECT_EQ(DiagnosticStatus::WARN, find(processed, "/Fleet/robot1/Sensors/Camera")->level);
+  EXPECT_EQ(DiagnosticStatus::WARN, find(processed, "/Fleet/robot1")->level);
+}
+
+TEST(FederatedAnalyzer, silentChildIsStale)
+{
+  FederatedAnalyzer analyzer;
+  analyzer.init("/Fleet", "robot1", 5.0);
+  auto processed = analyzer.report();
+  ASSERT_EQ(1u, processed.size());
+  EXPECT_EQ(DiagnosticStatus::STALE, processed[0]->level);
+
+  analyzer.update(makeTree(), now() - rclcpp::Duration(10, 0));
+  processed = analyzer.report();
+  // The last known tree is kept, stale
+  EXPECT_EQ(5u, processed.size());
+  EXPECT_EQ(DiagnosticStatus::STALE, find(processed, "/Fleet/robot1")->level);
+  EXPECT_EQ(DiagnosticStatus::STALE, find(processed, "/Fleet/robot1/Sensors/Lidar")->level);
+  EXPECT_EQ(DiagnosticStatus::STALE, find(processed, "/Fleet/robot1/Motors")->level);
+}
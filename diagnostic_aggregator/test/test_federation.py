@@ -0,0 +1,114 @@
+import time
+import unittest
+
+from diagnostic_msgs.msg import DiagnosticArray, DiagnosticStatus
+from launch import LaunchDescription
+from launch_ros.actions import Node
+from launch_testing.actions import ReadyToTest
+import pytest
+import rclpy
+
+ROBOTS = ['robot1', 'robot2']
+TOPICS = ['/diagnostics', '/diagnostics_agg', '/diagnostics_toplevel_state']
+
+
+@pytest.mark.launch_test
+def generate_test_description():
+    ld = LaunchDescription()
+
+    # One aggregator per robot, each in its own process with its own topics
+    for robot in ROBOTS:
+        ld.add_action(Node(
+            package='diagnostic_aggregator',
+            executable='aggregator_node',
+            name=robot + '_aggregator',
+            parameters=[{'sensors.type': 'diagnostic_aggregator/GenericAnalyzer'},
+                        {'sensors.path': 'Sensors'},
+                        {'sensors.startswith': ['sensor']}],
+            remappings=[(topic, '/' + robot + topic) for topic in TOPICS]))
+
+    # The base station aggregator federates the robots next to its own analyzers
+    ld.add_action(Node(
+        package='diagnostic_aggregator',
+        executable='aggregator_node',
+        name='fleet_aggregator',
+        parameters=[{'path': 'Fleet'},
+                    {'base.type': 'diagnostic_aggregator/GenericAnalyzer'},
+                    {'base.path': 'Base'},
+                    {'base.startswith': ['base']},
+                    {'federation.children': ROBOTS}]))
+
+    ld.add_action(ReadyToTest())
+    return ld
+
+
+class TestFederation(unittest.TestCase):
+
+    @ classmethod
+    def setUpClass(cls):
+        rclpy.init()
+
+    @ classmethod
+    def tearDownClass(cls):
+        rclpy.shutdown()
+
+    def setUp(self):
+        self.node = rclpy.create_node('test_federation')
+        self.publishers = {
+            robot: self.node.create_publisher(
+                DiagnosticArray, '/' + robot + '/diagnostics', 10)
+            for robot in ROBOTS}
+        self.base_publisher = self.node.create_publisher(DiagnosticArray, '/diagnostics', 10)
+        self.subscriber = self.node.create_subscription(
+            DiagnosticArray, '/diagnostics_agg', self.callback, 10)
+        self.received = {}
+        self.camera_level = {robot: DiagnosticStatus.OK for robot in ROBOTS}
+
+    def tearDown(self):
+        self.node.destroy_node()
+
+    def callback(self, msg):
+        for status in msg.status:
+            self.received[status.name] = status.level
+
+    def publish(self):
+        for robot, publisher in self.publishers.items():
+            msg = DiagnosticArray()
+            msg.header.stamp = self.node.get_clock().now().to_msg()
+            msg.status = [
+                DiagnosticStatus(level=DiagnosticStatus.OK, name='sensor_lidar', message='OK'),
+                DiagnosticStatus(
+                    level=self.camera_level[robot], name='sensor_camera', message='camera')]
+            publisher.publish(msg)
+        msg = DiagnosticArray()
+        msg.header.stamp = self.node.get_clock().now().to_msg()
+        msg.status = [DiagnosticStatus(level=DiagnosticStatus.OK, name='base_power', message='OK')]
+        self.base_publisher.publish(msg)
+
+    def wait_for(self, name, level, timeout=20.0):
+        end = time.time() + timeout
+        while time.time() < end:
+            self.publish()
+            rclpy.spin_once(self.node, timeout_sec=0.1)
+            if self.received.get(name) == level:
+                return True
+        return False
+
+    def test_children_are_federated(self):
+        for robot in ROBOTS:
+            name = '/Fleet/' + robot + '/Sensors/sensor_lidar'
+            assert self.wait_for(name, DiagnosticStatus.OK), \
+                f"'{name}' not received from the fleet aggregator"
+        assert self.wait_for('/Fleet/robot1', DiagnosticStatus.OK), \
+            'Header of robot1 not received'
+
+    def test_child_levels_reach_toplevel(self):
+        self.camera_level['robot2'] = DiagnosticStatus.ERROR
+        assert self.wait_for('/Fleet/robot2/Sensors/sensor_camera', DiagnosticStatus.ERROR), \
+            'Error of robot2 not federated'
+        assert self.wait_for('/Fleet/robot2', DiagnosticStatus.ERROR), \
+            'Header of robot2 does not reflect its error'
+        assert self.wait_for('/Fleet', DiagnosticStatus.ERROR), \
+            'Fleet header does not reflect the error of robot2'
+        assert self.wait_for('/Fleet/robot1', DiagnosticStatus.OK), \
+            'Error of robot2 leaked into robot1'
@@ -0,0 +1,333 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/aggregator.hpp"
+#include "diagnostic_aggregator/flight_record_reader.hpp"
+#include "diagnostic_aggregator/flight_recorder.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+#include "rcl/time.h"
+
+#include "rclcpp/rclcpp.hpp"
+
+using diagnostic_aggregator::Aggregator;
+using diagnostic_aggregator::FlightRecorder;
+using diagnostic_aggregator::FlightRecordReader;
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+DiagnosticStatus makeStatus(
+  const std::string & name, unsigned char level, const std::string & message,
+  const std::string & value = "")
+{
+  DiagnosticStatus status;
+  status.name = name;
+  status.level = level;
+  status.message = message;
+  status.hardware_id = "hw";
+  if (!value.empty()) {
+    diagnostic_msgs::msg::KeyValue kv;
+    kv.key = "Value";
+    kv.value = value;
+    status.values.push_back(kv);
+  }
+  return status;
+}
+
+std::shared_ptr<DiagnosticArray> makeTree(
+  double seconds, const std::vector<DiagnosticStatus> & statuses)
+{
+  auto tree = std::make_shared<DiagnosticArray>();
+  tree->header.stamp = rclcpp::Time(static_cast<int64_t>(seconds * 1e9), RCL_ROS_TIME);
+  tree->status = statuses;
+  return tree;
+}
+
+rclcpp::Time at(double seconds)
+{
+  return rclcpp::Time(static_cast<int64_t>(seconds * 1e9), RCL_ROS_TIME);
+}
+
+std::string tempFile(const std::string & name)
+{
+  std::string file = testing::TempDir() + name;
+  std::remove(file.c_str());
+  return file;
+}
+
+/// The aggregator records to this file, see main()
+const std::string kRatesFile = testing::TempDir() + "flight_recorder_rates.rec";
+
+/// True if tree has a status whose name ends with suffix
+bool contains(const DiagnosticArray & tree, const std::string & suffix)
+{
+  for (const auto & status : tree.status) {
+    if (status.name.size() >= suffix.size() &&
+      status.name.compare(status.name.size() - suffix.size(), suffix.size(), suffix) == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+TEST(FlightRecorder, rebuildsTreeAtTime)
+{
+  std::string file = tempFile("flight_recorder_rebuild.rec");
+  {
+    FlightRecorder recorder(file, 64 * 1024, 4);
+    ASSERT_TRUE(recorder.isOpen());
+    recorder.record(
+      makeTree(
+        1.0, {makeStatus("/Robot/A", DiagnosticStatus::OK, "OK", "1"),
+          makeStatus("/Robot/B", DiagnosticStatus::WARN, "Warning", "2")}));
+    recorder.record(
+      makeTree(
+        2.0, {makeStatus("/Robot/A", DiagnosticStatus::ERROR, "Error", "3"),
+          makeStatus("/Robot/B", DiagnosticStatus::WARN, "Warning", "2")}));
+    recorder.record(makeTree(3.0, {makeStatus("/Robot/A", DiagnosticStatus::OK, "OK")}));
+    recorder.flush();
+    EXPECT_EQ(0u, recorder.getDroppedCount());
+  }
+
+  FlightRecordReader reader;
+  ASSERT_TRUE(reader.open(file));
+
+  rclcpp::Time first, last;
+  ASSERT_TRUE(reader.getTimeRange(first, last));
+  EXPECT_EQ(at(1.0).nanoseconds(), first.nanoseconds());
+  EXPECT_EQ(at(3.0).nanoseconds(), last.nanoseconds());
+
+  DiagnosticArray tree;
+  EXPECT_FALSE(reader.getTreeAt(at(0.5), tree));
+
+  ASSERT_TRUE(reader.getTreeAt(at(1.5), tree));
+  ASSERT_EQ(2u, tree.status.size());
+  EXPECT_EQ("/Robot/A", tree.status[0].name);
+  EXPECT_EQ(DiagnosticStatus::OK, tree.status[0].level);
+  EXPECT_EQ("1", tree.status[0].values.at(0).value);
+  EXPECT_EQ("/Robot/B", tree.status[1].name);
+  EXPECT_EQ("Warning", tree.status[1].message);
+  EXPECT_EQ("hw", tree.status[1].hardware_id);
+
+  ASSERT_TRUE(reader.getTreeAt(at(2.0), tree));
+  ASSERT_EQ(2u, tree.status.size());
+  EXPECT_EQ(DiagnosticStatus::ERROR, tree.status[0].level);
+  EXPECT_EQ("Error", tree.status[0].message);
+  EXPECT_EQ("3", tree.status[0].values.at(0).value);
+
+  ASSERT_TRUE(reader.getTreeAt(at(10.0), tree));
+  ASSERT_EQ(1u, tree.status.size());
+  EXPECT_EQ("/Robot/A", tree.status[0].name);
+  EXPECT_TRUE(tree.status[0].values.empty());
+
+  std::remove(file.c_str());
+}
+
+TEST(FlightRecorder, ringOverwritesOldestSegment)
+{
+  std::string file = tempFile("flight_recorder_ring.rec");
+  {
+    FlightRecorder recorder(file, 4096, 3);
+    ASSERT_TRUE(recorder.isOpen());
+    for (int i = 0; i < 1000; ++i) {
+      recorder.record(
+        makeTree(
+          i, {makeStatus("/Robot/Counter", DiagnosticStatus::OK, "OK", std::to_string(i)),
+            makeStatus("/Robot/Static", DiagnosticStatus::OK, "OK", "static")}));
+      recorder.flush();
+    }
+  }
+
+  FlightRecordReader reader;
+  ASSERT_TRUE(reader.open(file));
+
+  rclcpp::Time first, last;
+  ASSERT_TRUE(reader.getTimeRange(first, last));
+  EXPECT_GT(first.nanoseconds(), at(0.0).nanoseconds());
+  EXPECT_EQ(at(999.0).nanoseconds(), last.nanoseconds());
+
+  DiagnosticArray tree;
+  EXPECT_FALSE(reader.getTreeAt(at(0.0), tree));
+
+  // Every time still covered by the ring is rebuilt from its own segment
+  for (double t = first.seconds(); t <= 999.0; t += 1.0) {
+    ASSERT_TRUE(reader.getTreeAt(at(t), tree));
+    ASSERT_EQ(2u, tree.status.size());
+    EXPECT_EQ(std::to_string(static_cast<int>(t)), tree.status[0].values.at(0).value);
+    EXPECT_EQ("static", tree.status[1].values.at(0).value);
+  }
+
+  std::remove(file.c_str());
+}
+
+TEST(FlightRecorder, namesStatusesComingBackInLaterSegments)
+{
+  std::string file = tempFile("flight_recorder_come_back.rec");
+  {
+    FlightRecorder recorder(file, 4096, 3);
+    ASSERT_TRUE(recorder.isOpen());
+    recorder.record(
+      makeTree(
+        0.0, {makeStatus("/Robot/Counter", DiagnosticStatus::OK, "OK", "0"),
+          makeStatus("/Robot/Flaky", DiagnosticStatus::WARN, "Warning")}));
+    // The flaky status goes away for long enough that its name is only in
+    // overwritten segments
+    for (int i = 1; i < 500; ++i) {
+      recorder.record(
+        makeTree(i, {makeStatus("/Robot/Counter", DiagnosticStatus::OK, "OK", std::to_string(i))}));
+      recorder.flush();
+    }
+    recorder.record(
+      makeTree(
+        500.0, {makeStatus("/Robot/Counter", DiagnosticStatus::OK, "OK", "500"),
+          makeStatus("/Robot/Flaky", DiagnosticStatus::ERROR, "Error")}));
+    recorder.flush();
+  }
+
+  FlightRecordReader reader;
+  ASSERT_TRUE(reader.open(file));
+
+  rclcpp::Time first, last;
+  ASSERT_TRUE(reader.getTimeRange(first, last));
+  EXPECT_GT(first.nanoseconds(), at(0.0).nanoseconds());
+
+  DiagnosticArray tree;
+  ASSERT_TRUE(reader.getTreeAt(at(500.0), tree));
+  ASSERT_EQ(2u, tree.status.size());
+  EXPECT_EQ("/Robot/Counter", tree.status[0].name);
+  EXPECT_EQ("/Robot/Flaky", tree.status[1].name);
+  EXPECT_EQ(DiagnosticStatus::ERROR, tree.status[1].level);
+
+  std::remove(file.c_str());
+}
+
+TEST(FlightRecorder, continuesExistingFile)
+{
+  std::string file = tempFile("flight_recorder_continue.rec");
+  {
+    FlightRecorder recorder(file, 8192, 4);
+    recorder.record(makeTree(1.0, {makeStatus("/Robot/Old", DiagnosticStatus::OK, "OK")}));
+    recorder.flush();
+  }
+  {
+    FlightRecorder recorder(file, 8192, 4);
+    recorder.record(makeTree(5.0, {makeStatus("/Robot/New", DiagnosticStatus::WARN, "Warn")}));
+    recorder.flush();
+  }
+
+  FlightRecordReader reader;
+  ASSERT_TRUE(reader.open(file));
+
+  DiagnosticArray tree;
+  ASSERT_TRUE(reader.getTreeAt(at(2.0), tree));
+  ASSERT_EQ(1u, tree.status.size());
+  EXPECT_EQ("/Robot/Old", tree.status[0].name);
+
+  ASSERT_TRUE(reader.getTreeAt(at(5.0), tree));
+  ASSERT_EQ(1u, tree.status.size());
+  EXPECT_EQ("/Robot/New", tree.status[0].name);
+
+  std::remove(file.c_str());
+}
+
+TEST(FlightRecorder, recordsWholeTreeOfPartialPublications)
+{
+  auto clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(clock->get_clock_handle()));
+  const std::int64_t start = 1000000000000LL;
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(clock->get_clock_handle(), start));
+  std::remove(kRatesFile.c_str());
+
+  // The fast group is due every tick, the slow group and the root every
+  // fourth tick, see main()
+  std::vector<std::int64_t> stamps;
+  {
+    Aggregator agg(clock);
+    auto msg = std::make_shared<DiagnosticArray>();
+    msg->status.push_back(makeStatus("fast_sensor", DiagnosticStatus::OK, "OK"));
+    msg->status.push_back(makeStatus("slow_sensor", DiagnosticStatus::WARN, "Warning"));
+    msg->status.push_back(makeStatus("other_sensor", DiagnosticStatus::OK, "OK"));
+    agg.diagCallback(msg);
+    for (int i = 0; i < 8; ++i) {
+      stamps.push_back(start + i * 250000000LL);
+      ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(clock->get_clock_handle(), stamps.back()));
+      agg.publishData();
+    }
+  }  // Writes the rest of the recording
+
+  FlightRecordReader reader;
+  ASSERT_TRUE(reader.open(kRatesFile));
+
+  // Statuses of subtrees that aren't due are not recorded as removed
+  DiagnosticArray tree;
+  for (std::int64_t stamp : stamps) {
+    ASSERT_TRUE(reader.getTreeAt(rclcpp::Time(stamp, RCL_ROS_TIME), tree));
+    EXPECT_TRUE(contains(tree, "/Fast/fast_sensor")) << stamp;
+    EXPECT_TRUE(contains(tree, "/Slow/slow_sensor")) << stamp;
+    EXPECT_TRUE(contains(tree, "other_sensor")) << stamp;
+  }
+
+  std::remove(kRatesFile.c_str());
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  std::string file_param = "flight_recorder.file:=" + kRatesFile;
+  std::vector<const char *> args(argv, argv + argc);
+  args.insert(
+    args.end(), {"--ros-args", "-p", file_param.c_str(),
+      "-p", "fast.type:=diagnostic_aggregator/GenericAnalyzer", "-p", "fast.path:=Fast",
+      "-p", "fast.startswith:=[fast]", "-p", "fast.pub_rate:=4.0",
+      "-p", "slow.type:=diagnostic_aggregator/GenericAnalyzer", "-p", "slow.path:=Slow",
+      "-p", "slow.startswith:=[slow]"});
+  rclcpp::init(static_cast<int>(args.size()), args.data());
+  int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
@@ -0,0 +1,263 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/aggregator.hpp"
+#include "diagnostic_aggregator/flight_record_reader.hpp"
+#include "diagnostic_aggregator/hardware_index.hpp"
+#include "diagnostic_aggregator/status_item.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+#include "rcl/time.h"
+
+#include "rclcpp/rclcpp.hpp"
+
+using diagnostic_aggregator::Aggregator;
+using diagnostic_aggregator::FlightRecordReader;
+using diagnostic_aggregator::HardwareIndex;
+using diagnostic_aggregator::StatusItem;
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+std::shared_ptr<StatusItem> makeItem(
+  const std::string & name, const std::string & hardware_id, unsigned char level,
+  rclcpp::Clock::SharedPtr clock = nullptr)
+{
+  DiagnosticStatus status;
+  status.name = name;
+  status.hardware_id = hardware_id;
+  status.level = level;
+  return std::make_shared<StatusItem>(&status, clock);
+}
+
+const std::int64_t kSecond = 1000000000LL;
+
+void setTime(const rclcpp::Clock::SharedPtr & clock, std::int64_t stamp)
+{
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(clock->get_clock_handle(), stamp));
+}
+
+/// The aggregator records its publications to this file, see main()
+const std::string kRecordFile = testing::TempDir() + "hardware_index.rec";
+
+/// Level of the status named name in tree, -1 if there is none
+int findLevel(const DiagnosticArray & tree, const std::string & name)
+{
+  for (const auto & status : tree.status) {
+    if (status.name == name) {
+      return status.level;
+    }
+  }
+  return -1;
+}
+}  // namespace
+
+TEST(HardwareIndex, looksUpItemsByDevice)
+{
+  HardwareIndex index;
+  index.update(makeItem("lidar: Connection", "lidar_1", DiagnosticStatus::OK));
+  index.update(makeItem("lidar: Frequency", "lidar_1", DiagnosticStatus::WARN));
+  index.update(makeItem("camera: Frequency", "camera_1", DiagnosticStatus::OK));
+  index.update(makeItem("cpu: Load", "", DiagnosticStatus::OK));
+
+  EXPECT_EQ(2u, index.getDeviceCount());
+  auto items = index.lookup("lidar_1");
+  ASSERT_EQ(2u, items.size());
+  EXPECT_EQ("lidar: Connection", items[0]->getName());
+  EXPECT_EQ("lidar: Frequency", items[1]->getName());
+  EXPECT_EQ(diagnostic_aggregator::Level_Warn, items[1]->getLevel());
+
+  index.update(makeItem("lidar: Frequency", "lidar_1", DiagnosticStatus::ERROR));
+  items = index.lookup("lidar_1");
+  ASSERT_EQ(2u, items.size());
+  EXPECT_EQ(diagnostic_aggregator::Level_Error, items[1]->getLevel());
+
+  EXPECT_TRUE(index.lookup("unknown").empty());
+  EXPECT_TRUE(index.lookup("").empty());
+}
+
+TEST(HardwareIndex, movesItemsBetweenDevices)
+{
+  HardwareIndex index;
+  index.update(makeItem("lidar: Frequency", "lidar_1", DiagnosticStatus::ERROR));
+  index.update(makeItem("lidar: Frequency", "lidar_2", DiagnosticStatus::OK));
+
+  EXPECT_TRUE(index.lookup("lidar_1").empty());
+  ASSERT_EQ(1u, index.lookup("lidar_2").size());
+  EXPECT_EQ(1u, index.getDeviceCount());
+
+  index.update(makeItem("lidar: Frequency", "", DiagnosticStatus::OK));
+  EXPECT_EQ(0u, index.getDeviceCount());
+}
+
+TEST(HardwareIndex, rollsUpLevels)
+{
+  HardwareIndex index;
+  index.update(makeItem("lidar: Connection", "lidar_1", DiagnosticStatus::OK));
+  index.update(makeItem("lidar: Frequency", "lidar_1", DiagnosticStatus::ERROR));
+  index.update(makeItem("camera: Frequency", "camera/front", DiagnosticStatus::WARN));
+
+  auto report = index.report("/Robot/Devices");
+  ASSERT_EQ(3u, report.size());
+  EXPECT_EQ("/Robot/Devices", report[0]->name);
+  EXPECT_EQ(DiagnosticStatus::ERROR, report[0]->level);
+  EXPECT_EQ("/Robot/Devices/camera front", report[1]->name);
+  EXPECT_EQ(DiagnosticStatus::WARN, report[1]->level);
+  EXPECT_EQ("/Robot/Devices/lidar_1", report[2]->name);
+  EXPECT_EQ(DiagnosticStatus::ERROR, report[2]->level);
+  ASSERT_EQ(4u, report[2]->values.size());
+  EXPECT_EQ("OK", report[2]->values[0].key);
+  EXPECT_EQ("1", report[2]->values[0].value);
+  EXPECT_EQ("Error", report[2]->values[2].key);
+  EXPECT_EQ("1", report[2]->values[2].value);
+
+  // Recovery lowers the rollup level again
+  index.update(makeItem("lidar: Frequency", "lidar_1", DiagnosticStatus::OK));
+  report = index.report("/Robot/Devices");
+  EXPECT_EQ(DiagnosticStatus::WARN, report[0]->level);
+  EXPECT_EQ(DiagnosticStatus::OK, report[2]->level);
+  EXPECT_EQ("2", report[2]->values[0].value);
+}
+
+TEST(HardwareIndex, expiresItemsNotUpdated)
+{
+  auto clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(clock->get_clock_handle()));
+  setTime(clock, 1000 * kSecond);
+
+  HardwareIndex index;
+  index.setTimeout(5.0);
+  index.update(makeItem("lidar: Connection", "lidar_1", DiagnosticStatus::OK, clock));
+  index.update(makeItem("lidar: Frequency", "lidar_1", DiagnosticStatus::OK, clock));
+  index.update(makeItem("camera: Frequency", "camera_1", DiagnosticStatus::WARN, clock));
+  index.expire(clock->now());
+  EXPECT_EQ(DiagnosticStatus::WARN, index.report("/Robot/Devices")[0]->level);
+
+  // The camera stops publishing, the lidar only publishes one of its items
+  setTime(clock, 1004 * kSecond);
+  index.update(makeItem("lidar: Frequency", "lidar_1", DiagnosticStatus::OK, clock));
+  setTime(clock, 1008 * kSecond);
+  index.expire(clock->now());
+  auto report = index.report("/Robot/Devices");
+  ASSERT_EQ(3u, report.size());
+  EXPECT_EQ(DiagnosticStatus::ERROR, report[0]->level);
+  EXPECT_EQ("/Robot/Devices/camera_1", report[1]->name);
+  EXPECT_EQ(DiagnosticStatus::STALE, report[1]->level);
+  EXPECT_EQ("0", report[1]->values[1].value);
+  EXPECT_EQ("1", report[1]->values[3].value);
+  EXPECT_EQ(DiagnosticStatus::ERROR, report[2]->level);
+  EXPECT_EQ("1", report[2]->values[0].value);
+  EXPECT_EQ("1", report[2]->values[3].value);
+
+  // Expired items can still be looked up, and count again once updated
+  ASSERT_EQ(1u, index.lookup("camera_1").size());
+  index.update(makeItem("camera: Frequency", "camera_1", DiagnosticStatus::OK, clock));
+  index.update(makeItem("lidar: Connection", "lidar_1", DiagnosticStatus::OK, clock));
+  index.expire(clock->now());
+  report = index.report("/Robot/Devices");
+  EXPECT_EQ(DiagnosticStatus::OK, report[0]->level);
+  EXPECT_EQ(DiagnosticStatus::OK, report[1]->level);
+  EXPECT_EQ("0", report[1]->values[3].value);
+  EXPECT_EQ("2", report[2]->values[0].value);
+
+  // Without a timeout nothing expires
+  HardwareIndex never;
+  never.update(makeItem("camera: Frequency", "camera_1", DiagnosticStatus::OK, clock));
+  setTime(clock, 2000 * kSecond);
+  never.expire(clock->now());
+  EXPECT_EQ(DiagnosticStatus::OK, never.report("/Robot/Devices")[1]->level);
+}
+
+TEST(HardwareIndex, rollsUpDampedLevels)
+{
+  auto clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(clock->get_clock_handle()));
+  setTime(clock, 1000 * kSecond);
+  std::remove(kRecordFile.c_str());
+
+  {
+    Aggregator agg(clock);
+    auto msg = std::make_shared<DiagnosticArray>();
+    DiagnosticStatus status;
+    status.name = "motor: Temperature";
+    status.hardware_id = "motor_1";
+    status.level = DiagnosticStatus::ERROR;
+    msg->status.push_back(status);
+    agg.diagCallback(msg);
+    agg.publishData();
+
+    // The motors hold the error for 10 s, see main(), so does the rollup
+    setTime(clock, 1001 * kSecond);
+    msg = std::make_shared<DiagnosticArray>();
+    status.level = DiagnosticStatus::OK;
+    msg->status.push_back(status);
+    agg.diagCallback(msg);
+    agg.publishData();
+  }  // Writes the rest of the recording
+
+  FlightRecordReader reader;
+  ASSERT_TRUE(reader.open(kRecordFile));
+  DiagnosticArray tree;
+  ASSERT_TRUE(reader.getTreeAt(rclcpp::Time(1001 * kSecond, RCL_ROS_TIME), tree));
+  EXPECT_EQ(DiagnosticStatus::ERROR, findLevel(tree, "/Motors/motor: Temperature"));
+  EXPECT_EQ(DiagnosticStatus::ERROR, findLevel(tree, "/Devices/motor_1"));
+
+  std::remove(kRecordFile.c_str());
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  std::string file_param = "flight_recorder.file:=" + kRecordFile;
+  std::vector<const char *> args(argv, argv + argc);
+  args.insert(
+    args.end(), {"--ros-args", "-p", file_param.c_str(), "-p", "hardware_rollup.path:=Devices",
+      "-p", "motors.type:=diagnostic_aggregator/GenericAnalyzer", "-p", "motors.path:=Motors",
+      "-p", "motors.startswith:=[motor]", "-p", "motors.flap_dwell:=10.0"});
+  rclcpp::init(static_cast<int>(args.size()), args.data());
+  int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
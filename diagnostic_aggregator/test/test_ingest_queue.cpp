@@ -0,0 +1,200 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "diagnostic_aggregator/ingest_queue.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+using diagnostic_aggregator::IngestQueue;
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+/// An array of one status of each given name, with one KeyValue
+DiagnosticArray::SharedPtr makeArray(
+  const std::vector<std::string> & names, unsigned char level, const std::string & value)
+{
+  auto msg = std::make_shared<DiagnosticArray>();
+  for (const auto & name : names) {
+    DiagnosticStatus status;
+    status.name = name;
+    status.level = level;
+    diagnostic_msgs::msg::KeyValue kv;
+    kv.key = "Value";
+    kv.value = value;
+    status.values.push_back(kv);
+    msg->status.push_back(status);
+  }
+  return msg;
+}
+
+std::vector<std::string> names(const IngestQueue::Batch & batch)
+{
+  std::vector<std::string> result;
+  for (const auto * status : batch.statuses) {
+    result.push_back(status->name);
+  }
+  return result;
+}
+
+const IngestQueue::Thresholds kCoalesce{4, 10.0};
+const IngestQueue::Thresholds kShed{8, 20.0};
+}  // namespace
+
+TEST(IngestQueue, normal)
+{
+  IngestQueue queue(100, kCoalesce, kShed);
+  queue.push(makeArray({"a", "b"}, DiagnosticStatus::OK, "1"));
+  queue.push(makeArray({"a"}, DiagnosticStatus::WARN, "2"));
+
+  IngestQueue::Batch batch;
+  ASSERT_TRUE(queue.pop(batch));
+  EXPECT_EQ(IngestQueue::Mode_Normal, batch.mode);
+  EXPECT_EQ(2u, batch.arrays.size());
+  EXPECT_EQ((std::vector<std::string>{"a", "b", "a"}), names(batch));
+  EXPECT_EQ(1u, batch.statuses[0]->values.size());
+
+  IngestQueue::Statistics statistics = queue.getStatistics();
+  EXPECT_EQ(0u, statistics.depth);
+  EXPECT_EQ(3u, statistics.received);
+  EXPECT_EQ(0u, statistics.coalesced);
+}
+
+TEST(IngestQueue, coalesce)
+{
+  IngestQueue queue(100, kCoalesce, kShed);
+  queue.push(makeArray({"a", "b"}, DiagnosticStatus::OK, "1"));
+  queue.push(makeArray({"a", "c"}, DiagnosticStatus::WARN, "2"));
+  queue.push(makeArray({"a"}, DiagnosticStatus::OK, "3"));
+
+  // Only the latest status of every name, in the order they were received
+  IngestQueue::Batch batch;
+  ASSERT_TRUE(queue.pop(batch));
+  EXPECT_EQ(IngestQueue::Mode_Coalesce, batch.mode);
+  EXPECT_EQ((std::vector<std::string>{"b", "c", "a"}), names(batch));
+  EXPECT_EQ("3", batch.statuses[2]->values[0].value);
+  EXPECT_EQ(1u, batch.statuses[0]->values.size());
+  EXPECT_EQ(2u, queue.getStatistics().coalesced);
+}
+
+TEST(IngestQueue, shed)
+{
+  IngestQueue queue(100, kCoalesce, kShed);
+  queue.push(makeArray({"a", "b", "c", "d"}, DiagnosticStatus::OK, "1"));
+  queue.push(makeArray({"e", "f"}, DiagnosticStatus::ERROR, "2"));
+  queue.push(makeArray({"b", "g"}, DiagnosticStatus::WARN, "3"));
+
+  // Non-OK first, and the OK statuses without their KeyValues
+  IngestQueue::Batch batch;
+  ASSERT_TRUE(queue.pop(batch));
+  EXPECT_EQ(IngestQueue::Mode_Shed, batch.mode);
+  EXPECT_EQ((std::vector<std::string>{"e", "f", "b", "g", "a", "c", "d"}), names(batch));
+  EXPECT_EQ(1u, batch.statuses[0]->values.size());
+  EXPECT_TRUE(batch.statuses[4]->values.empty());
+
+  IngestQueue::Statistics statistics = queue.getStatistics();
+  EXPECT_EQ(1u, statistics.coalesced);
+  EXPECT_EQ(3u, statistics.stripped);
+}
+
+TEST(IngestQueue, lag)
+{
+  IngestQueue queue(100, kCoalesce, kShed);
+  auto now = std::chrono::steady_clock::now();
+  queue.push(makeArray({"a"}, DiagnosticStatus::OK, "1"), now - std::chrono::seconds(15));
+  queue.push(makeArray({"a"}, DiagnosticStatus::OK, "2"), now);
+
+  IngestQueue::Batch batch;
+  ASSERT_TRUE(queue.pop(batch));
+  EXPECT_EQ(IngestQueue::Mode_Coalesce, batch.mode);
+  EXPECT_EQ(1u, batch.statuses.size());
+}
+
+TEST(IngestQueue, hysteresis)
+{
+  IngestQueue queue(100, kCoalesce, kShed);
+  IngestQueue::Batch batch;
+  queue.push(makeArray({"a", "b", "c", "d"}, DiagnosticStatus::OK, "1"));
+  ASSERT_TRUE(queue.pop(batch));
+  EXPECT_EQ(IngestQueue::Mode_Coalesce, batch.mode);
+
+  // Below the threshold, but not below half of it
+  queue.push(makeArray({"a", "b"}, DiagnosticStatus::OK, "1"));
+  ASSERT_TRUE(queue.pop(batch));
+  EXPECT_EQ(IngestQueue::Mode_Coalesce, batch.mode);
+
+  queue.push(makeArray({"a"}, DiagnosticStatus::OK, "1"));
+  ASSERT_TRUE(queue.pop(batch));
+  EXPECT_EQ(IngestQueue::Mode_Normal, batch.mode);
+  EXPECT_EQ(IngestQueue::Mode_Normal, queue.getStatistics().mode);
+}
+
+TEST(IngestQueue, capacity)
+{
+  IngestQueue queue(3, IngestQueue::Thresholds{100, 10.0}, IngestQueue::Thresholds{200, 20.0});
+  queue.push(makeArray({"a", "b"}, DiagnosticStatus::OK, "1"));
+  queue.push(makeArray({"c", "d"}, DiagnosticStatus::OK, "2"));
+
+  // The oldest array is dropped
+  IngestQueue::Batch batch;
+  ASSERT_TRUE(queue.pop(batch));
+  EXPECT_EQ((std::vector<std::string>{"c", "d"}), names(batch));
+  EXPECT_EQ(2u, queue.getStatistics().dropped);
+}
+
+TEST(IngestQueue, stop)
+{
+  IngestQueue queue(100, kCoalesce, kShed);
+  std::thread consumer([&queue] {
+      IngestQueue::Batch batch;
+      while (queue.pop(batch)) {
+      }
+    });
+  queue.push(makeArray({"a"}, DiagnosticStatus::OK, "1"));
+  queue.stop();
+  consumer.join();
+
+  IngestQueue::Batch batch;
+  EXPECT_FALSE(queue.pop(batch));
+}
@@ -0,0 +1,176 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/metrics_exporter.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+using diagnostic_aggregator::MetricsExporter;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+/// Sends a GET request to the exporter and returns the whole response
+std::string get(int port, const std::string & path)
+{
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return "";
+  }
+  std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  send(fd, request.data(), request.size(), 0);
+
+  std::string response;
+  char buffer[4096];
+  ssize_t received;
+  while ((received = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, received);
+  }
+  close(fd);
+  return response;
+}
+
+std::shared_ptr<DiagnosticStatus> makeStatus(const std::string & name, unsigned char level)
+{
+  auto status = std::make_shared<DiagnosticStatus>();
+  status->name = name;
+  status->level = level;
+  return status;
+}
+
+bool contains(const std::string & text, const std::string & part)
+{
+  return text.find(part) != std::string::npos;
+}
+}  // namespace
+
+TEST(MetricsExporter, ServesLevels)
+{
+  MetricsExporter exporter("127.0.0.1", 0);
+  ASSERT_TRUE(exporter.isOpen());
+  ASSERT_GT(exporter.getPort(), 0);
+
+  std::vector<std::shared_ptr<DiagnosticStatus>> tree = {
+    makeStatus("/Robot", DiagnosticStatus::WARN),
+    makeStatus("/Robot/Motor", DiagnosticStatus::WARN),
+    makeStatus("/Robot/Camera \"left\"", DiagnosticStatus::STALE)};
+  exporter.countReceived(5);
+  exporter.update(tree, DiagnosticStatus::WARN, 0.001);
+
+  std::string response = get(exporter.getPort(), "/metrics");
+  EXPECT_EQ(0u, response.find("HTTP/1.1 200 OK\r\n"));
+  EXPECT_TRUE(contains(response, "Content-Type: application/openmetrics-text"));
+  EXPECT_TRUE(contains(response, "# TYPE diagnostics_level gauge\n"));
+  EXPECT_TRUE(contains(response, "diagnostics_level{name=\"/Robot\"} 1\n"));
+  EXPECT_TRUE(contains(response, "diagnostics_level{name=\"/Robot/Motor\"} 1\n"));
+  EXPECT_TRUE(contains(response, "diagnostics_level{name=\"/Robot/Camera \\\"left\\\"\"} 3\n"));
+  EXPECT_TRUE(contains(response, "diagnostics_stale{name=\"/Robot\"} 0\n"));
+  EXPECT_TRUE(contains(response, "diagnostics_stale{name=\"/Robot/Camera \\\"left\\\"\"} 1\n"));
+  EXPECT_TRUE(contains(response, "diagnostics_items{level=\"warn\"} 2\n"));
+  EXPECT_TRUE(contains(response, "diagnostics_items{level=\"stale\"} 1\n"));
+  EXPECT_TRUE(contains(response, "diagnostics_toplevel_level 1\n"));
+  EXPECT_TRUE(contains(response, "diagnostics_aggregator_publications_total 1\n"));
+  EXPECT_TRUE(contains(response, "diagnostics_aggregator_received_statuses_total 5\n"));
+  EXPECT_TRUE(contains(response, "diagnostics_aggregator_scrapes_total 1\n"));
+
+  // The exposition ends with the EOF marker
+  std::string eof = "# EOF\n";
+  ASSERT_GE(response.size(), eof.size());
+  EXPECT_EQ(eof, response.substr(response.size() - eof.size()));
+
+  // The body matches the announced length
+  size_t header_end = response.find("\r\n\r\n");
+  ASSERT_NE(std::string::npos, header_end);
+  std::string body = response.substr(header_end + 4);
+  EXPECT_TRUE(contains(response, "Content-Length: " + std::to_string(body.size()) + "\r\n"));
+}
+
+TEST(MetricsExporter, UnknownPath)
+{
+  MetricsExporter exporter("127.0.0.1", 0);
+  ASSERT_TRUE(exporter.isOpen());
+  EXPECT_EQ(0u, get(exporter.getPort(), "/").find("HTTP/1.1 404 Not Found\r\n"));
+  EXPECT_EQ(0u, get(exporter.getPort(), "/metricsfoo").find("HTTP/1.1 404 Not Found\r\n"));
+}
+
+TEST(MetricsExporter, RebuildsOnlyOnChange)
+{
+  MetricsExporter exporter("127.0.0.1", 0);
+  ASSERT_TRUE(exporter.isOpen());
+
+  std::vector<std::shared_ptr<DiagnosticStatus>> tree = {
+    makeStatus("/Robot", DiagnosticStatus::OK),
+    makeStatus("/Robot/Motor", DiagnosticStatus::OK)};
+  exporter.update(tree, DiagnosticStatus::OK, 0.001);
+  EXPECT_EQ(1u, exporter.getRebuildCount());
+
+  // Same levels, the section is kept
+  for (int i = 0; i < 10; ++i) {
+    exporter.update(tree, DiagnosticStatus::OK, 0.001);
+  }
+  EXPECT_EQ(1u, exporter.getRebuildCount());
+  std::string response = get(exporter.getPort(), "/metrics");
+  EXPECT_TRUE(contains(response, "diagnostics_aggregator_publications_total 11\n"));
+
+  // A level change rebuilds it
+  tree[1]->level = DiagnosticStatus::ERROR;
+  exporter.update(tree, DiagnosticStatus::ERROR, 0.001);
+  EXPECT_EQ(2u, exporter.getRebuildCount());
+  response = get(exporter.getPort(), "/metrics");
+  EXPECT_TRUE(contains(response, "diagnostics_level{name=\"/Robot/Motor\"} 2\n"));
+
+  // So does a status that disappears
+  tree.pop_back();
+  exporter.update(tree, DiagnosticStatus::OK, 0.001);
+  EXPECT_EQ(3u, exporter.getRebuildCount());
+  response = get(exporter.getPort(), "/metrics");
+  EXPECT_FALSE(contains(response, "/Robot/Motor"));
+  EXPECT_TRUE(contains(response, "diagnostics_items{level=\"ok\"} 1\n"));
+}
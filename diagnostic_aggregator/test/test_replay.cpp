@@ -0,0 +1,151 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/aggregator.hpp"
+#include "diagnostic_aggregator/snapshot_reader.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+#include "rcl/time.h"
+
+#include "rclcpp/rclcpp.hpp"
+
+using diagnostic_aggregator::Aggregator;
+using diagnostic_aggregator::PhaseTimes;
+using diagnostic_aggregator::Snapshot;
+using diagnostic_aggregator::SnapshotReader;
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+/// The aggregator exports its tree to this shared memory, see main()
+const std::string kSnapshotName = "/test_replay_" + std::to_string(getpid());
+
+const std::int64_t kSecond = 1000000000LL;
+
+void setTime(const rclcpp::Clock::SharedPtr & clock, std::int64_t stamp)
+{
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(clock->get_clock_handle(), stamp));
+}
+
+/// Level of the status whose name ends with suffix, -1 if there is none
+int findLevel(const Snapshot & snapshot, const std::string & suffix)
+{
+  for (std::size_t i = 0; i < snapshot.size(); ++i) {
+    std::string name(snapshot[i].getName());
+    if (name.size() >= suffix.size() &&
+      name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+    {
+      return snapshot[i].getLevel();
+    }
+  }
+  return -1;
+}
+}  // namespace
+
+TEST(Replay, SimulatedClock)
+{
+  auto clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(clock->get_clock_handle()));
+  const std::int64_t start = 1000 * kSecond;
+  setTime(clock, start);
+
+  Aggregator agg(clock);
+  agg.enablePhaseTimes(true);
+  SnapshotReader reader;
+  ASSERT_TRUE(reader.open(kSnapshotName));
+  Snapshot snapshot;
+
+  auto msg = std::make_shared<DiagnosticArray>();
+  msg->header.stamp = rclcpp::Time(start, RCL_ROS_TIME);
+  DiagnosticStatus status;
+  status.name = "/replayed/sensor";
+  status.level = DiagnosticStatus::WARN;
+  msg->status.push_back(status);
+  agg.diagCallback(msg);
+
+  setTime(clock, start + 1 * kSecond);
+  agg.publishData();
+  ASSERT_TRUE(reader.read(snapshot));
+  EXPECT_EQ(start + 1 * kSecond, snapshot.getStamp());
+  EXPECT_EQ(DiagnosticStatus::WARN, findLevel(snapshot, "replayed/sensor"));
+
+  // The other analyzer discards items after 5 s of the simulated clock,
+  // although hardly any wall time has passed
+  setTime(clock, start + 4 * kSecond);
+  agg.publishData();
+  ASSERT_TRUE(reader.read(snapshot));
+  EXPECT_EQ(DiagnosticStatus::WARN, findLevel(snapshot, "replayed/sensor"));
+
+  setTime(clock, start + 7 * kSecond);
+  agg.publishData();
+  ASSERT_TRUE(reader.read(snapshot));
+  EXPECT_EQ(start + 7 * kSecond, snapshot.getStamp());
+  EXPECT_EQ(-1, findLevel(snapshot, "replayed/sensor"));
+
+  PhaseTimes times = agg.getPhaseTimes();
+  EXPECT_EQ(1u, times.arrays);
+  EXPECT_EQ(1u, times.statuses);
+  EXPECT_EQ(3u, times.publications);
+  EXPECT_GT(times.match.count(), 0);
+  EXPECT_GT(times.report.count(), 0);
+  EXPECT_GT(times.publish.count(), 0);
+
+  // Restarting resets the times
+  agg.enablePhaseTimes(false);
+  agg.enablePhaseTimes(true);
+  EXPECT_EQ(0u, agg.getPhaseTimes().publications);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  std::string snapshot_param = "snapshot.name:=" + kSnapshotName;
+  std::vector<const char *> args(argv, argv + argc);
+  args.insert(args.end(), {"--ros-args", "-p", snapshot_param.c_str()});
+  rclcpp::init(static_cast<int>(args.size()), args.data());
+  int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
@@ -0,0 +1,182 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "diagnostic_aggregator/snapshot_reader.hpp"
+#include "diagnostic_aggregator/snapshot_writer.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+#include "diagnostic_msgs/msg/key_value.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+using diagnostic_aggregator::Snapshot;
+using diagnostic_aggregator::SnapshotReader;
+using diagnostic_aggregator::SnapshotWriter;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+std::string regionName(const std::string & test)
+{
+  return "/test_snapshot_" + test + "_" + std::to_string(getpid());
+}
+
+std::vector<std::shared_ptr<DiagnosticStatus>> makeTree(size_t count, unsigned char level)
+{
+  std::vector<std::shared_ptr<DiagnosticStatus>> tree;
+  for (size_t i = 0; i < count; ++i) {
+    auto status = std::make_shared<DiagnosticStatus>();
+    status->name = "/Robot/Item " + std::to_string(i);
+    status->level = level;
+    status->message = "Message " + std::to_string(level);
+    status->hardware_id = "hw_" + std::to_string(i % 4);
+    diagnostic_msgs::msg::KeyValue kv;
+    kv.key = "Level";
+    kv.value = std::to_string(level);
+    status->values.push_back(kv);
+    kv.key = "Index";
+    kv.value = std::to_string(i);
+    status->values.push_back(kv);
+    tree.push_back(status);
+  }
+  return tree;
+}
+
+rclcpp::Time at(double seconds)
+{
+  return rclcpp::Time(static_cast<int64_t>(seconds * 1e9), RCL_ROS_TIME);
+}
+}  // namespace
+
+TEST(Snapshot, roundTrip)
+{
+  std::string name = regionName("round_trip");
+  SnapshotWriter writer(name, 64 * 1024);
+  ASSERT_TRUE(writer.isOpen());
+
+  SnapshotReader reader;
+  ASSERT_TRUE(reader.open(name));
+  Snapshot snapshot;
+  // Nothing exported yet
+  EXPECT_FALSE(reader.read(snapshot, 3));
+
+  ASSERT_TRUE(writer.write(makeTree(10, DiagnosticStatus::WARN), at(12.5)));
+  ASSERT_TRUE(reader.read(snapshot));
+  ASSERT_EQ(10u, snapshot.size());
+  EXPECT_EQ(12500000000, snapshot.getStamp());
+  EXPECT_EQ("/Robot/Item 3", snapshot[3].getName());
+  EXPECT_EQ(DiagnosticStatus::WARN, snapshot[3].getLevel());
+  EXPECT_EQ("Message 1", snapshot[3].getMessage());
+  EXPECT_EQ("hw_3", snapshot[3].getHardwareId());
+  ASSERT_EQ(2u, snapshot[3].getValueCount());
+  EXPECT_EQ("Index", snapshot[3].getKey(1));
+  EXPECT_EQ("3", snapshot[3].getValue(1));
+
+  uint64_t sequence = reader.getSequence();
+  EXPECT_EQ(sequence, snapshot.getSequence());
+  ASSERT_TRUE(writer.write(makeTree(2, DiagnosticStatus::OK), at(13.5)));
+  EXPECT_NE(sequence, reader.getSequence());
+  ASSERT_TRUE(reader.read(snapshot));
+  EXPECT_EQ(2u, snapshot.size());
+}
+
+TEST(Snapshot, keepsLastTreeWhenFull)
+{
+  std::string name = regionName("full");
+  SnapshotWriter writer(name, 4096);
+  ASSERT_TRUE(writer.write(makeTree(5, DiagnosticStatus::OK), at(1.0)));
+  EXPECT_FALSE(writer.write(makeTree(500, DiagnosticStatus::ERROR), at(2.0)));
+
+  SnapshotReader reader;
+  ASSERT_TRUE(reader.open(name));
+  Snapshot snapshot;
+  ASSERT_TRUE(reader.read(snapshot));
+  EXPECT_EQ(5u, snapshot.size());
+  EXPECT_EQ(1000000000, snapshot.getStamp());
+}
+
+TEST(Snapshot, missingRegion)
+{
+  SnapshotReader reader;
+  EXPECT_FALSE(reader.open(regionName("missing")));
+  Snapshot snapshot;
+  EXPECT_FALSE(reader.read(snapshot));
+}
+
+TEST(Snapshot, readsAreConsistentWhileWriting)
+{
+  std::string name = regionName("concurrent");
+  SnapshotWriter writer(name, 256 * 1024);
+  auto ok_tree = makeTree(200, DiagnosticStatus::OK);
+  auto error_tree = makeTree(100, DiagnosticStatus::ERROR);
+  ASSERT_TRUE(writer.write(ok_tree, at(0.0)));
+
+  std::atomic<bool> running(true);
+  std::thread thread([&]() {
+      for (int i = 1; running; ++i) {
+        writer.write(i % 2 ? error_tree : ok_tree, at(i));
+      }
+    });
+
+  SnapshotReader reader;
+  ASSERT_TRUE(reader.open(name));
+  Snapshot snapshot;
+  int reads = 0;
+  for (int i = 0; i < 2000; ++i) {
+    if (!reader.read(snapshot)) {
+      continue;
+    }
+    ++reads;
+    // Every snapshot is one of the two trees, never a mix
+    unsigned char level = snapshot[0].getLevel();
+    ASSERT_EQ(level == DiagnosticStatus::OK ? 200u : 100u, snapshot.size());
+    for (size_t j = 0; j < snapshot.size(); ++j) {
+      ASSERT_EQ(level, snapshot[j].getLevel());
+      ASSERT_EQ(std::to_string(level), snapshot[j].getValue(0));
+    }
+  }
+  running = false;
+  thread.join();
+  EXPECT_GT(reads, 0);
+}
@@ -0,0 +1,153 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "diagnostic_aggregator/status_history.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+using diagnostic_aggregator::StatusHistory;
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+const int64_t kSecond = 1000000000LL;
+
+DiagnosticArray makeTree(
+  int64_t seconds, const std::vector<std::pair<std::string, unsigned char>> & levels)
+{
+  DiagnosticArray tree;
+  tree.header.stamp.sec = static_cast<int32_t>(seconds);
+  for (const auto & level : levels) {
+    DiagnosticStatus status;
+    status.name = level.first;
+    status.level = level.second;
+    tree.status.push_back(status);
+  }
+  return tree;
+}
+}  // namespace
+
+TEST(StatusHistory, storesOnlyTransitions)
+{
+  StatusHistory history;
+  history.record(makeTree(1, {{"/Robot/Lidar", DiagnosticStatus::OK}}));
+  history.record(makeTree(2, {{"/Robot/Lidar", DiagnosticStatus::OK}}));
+  history.record(makeTree(3, {{"/Robot/Lidar", DiagnosticStatus::ERROR}}));
+  history.record(makeTree(4, {{"/Robot/Lidar", DiagnosticStatus::ERROR}}));
+  history.record(makeTree(5, {{"/Robot/Lidar", DiagnosticStatus::OK}}));
+
+  auto transitions = history.query("/Robot", 0, 10 * kSecond);
+  ASSERT_EQ(3u, transitions.size());
+  EXPECT_EQ(1 * kSecond, transitions[0].stamp);
+  EXPECT_EQ(DiagnosticStatus::OK, transitions[0].level);
+  EXPECT_EQ(3 * kSecond, transitions[1].stamp);
+  EXPECT_EQ(DiagnosticStatus::ERROR, transitions[1].level);
+  EXPECT_EQ(5 * kSecond, transitions[2].stamp);
+  EXPECT_EQ(DiagnosticStatus::OK, transitions[2].level);
+}
+
+TEST(StatusHistory, selectsSubtree)
+{
+  StatusHistory history;
+  history.record(
+    makeTree(
+      1, {
+        {"/Robot/Sensors", DiagnosticStatus::OK},
+        {"/Robot/Sensors/Lidar", DiagnosticStatus::OK},
+        {"/Robot/Sensors Extra", DiagnosticStatus::OK},
+        {"/Robot/SensorsX", DiagnosticStatus::OK},
+        {"/Robot/Motors", DiagnosticStatus::OK}}));
+
+  auto transitions = history.query("/Robot/Sensors/", 0, 10 * kSecond);
+  ASSERT_EQ(2u, transitions.size());
+  EXPECT_EQ("/Robot/Sensors", transitions[0].name);
+  EXPECT_EQ("/Robot/Sensors/Lidar", transitions[1].name);
+
+  EXPECT_EQ(5u, history.query("", 0, 10 * kSecond).size());
+  EXPECT_TRUE(history.query("/Robot/Sensor", 0, 10 * kSecond).empty());
+}
+
+TEST(StatusHistory, selectsTimeWindow)
+{
+  StatusHistory history;
+  for (int64_t t = 0; t < 100; ++t) {
+    history.record(
+      makeTree(
+        t, {
+          {"/Robot/A", static_cast<unsigned char>(t % 2)},
+          {"/Robot/B", static_cast<unsigned char>(t < 50 ? 0 : 2)}}));
+  }
+
+  // Level of A at 10s, its changes until 12s and the level of B at 10s
+  auto transitions = history.query("/Robot", 10 * kSecond + 1, 12 * kSecond);
+  ASSERT_EQ(4u, transitions.size());
+  EXPECT_EQ("/Robot/B", transitions[0].name);
+  EXPECT_EQ(0, transitions[0].stamp);
+  EXPECT_EQ("/Robot/A", transitions[1].name);
+  EXPECT_EQ(10 * kSecond, transitions[1].stamp);
+  EXPECT_EQ(11 * kSecond, transitions[2].stamp);
+  EXPECT_EQ(12 * kSecond, transitions[3].stamp);
+
+  // When did B first go to ERROR?
+  transitions = history.query("/Robot/B", 20 * kSecond, 100 * kSecond);
+  ASSERT_EQ(2u, transitions.size());
+  EXPECT_EQ(DiagnosticStatus::ERROR, transitions[1].level);
+  EXPECT_EQ(50 * kSecond, transitions[1].stamp);
+}
+
+TEST(StatusHistory, dropsOldestTransitions)
+{
+  StatusHistory history(4);
+  for (int64_t t = 0; t < 10; ++t) {
+    history.record(makeTree(t, {{"/Robot/A", static_cast<unsigned char>(t % 2)}}));
+  }
+
+  auto transitions = history.query("/Robot/A", 0, 10 * kSecond);
+  ASSERT_EQ(4u, transitions.size());
+  EXPECT_EQ(6 * kSecond, transitions[0].stamp);
+  EXPECT_EQ(9 * kSecond, transitions[3].stamp);
+
+  transitions = history.query("/Robot/A", 7 * kSecond + 1, 8 * kSecond);
+  ASSERT_EQ(2u, transitions.size());
+  EXPECT_EQ(7 * kSecond, transitions[0].stamp);
+  EXPECT_EQ(8 * kSecond, transitions[1].stamp);
+}
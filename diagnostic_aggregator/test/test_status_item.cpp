@@ -0,0 +1,203 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "diagnostic_aggregator/flap_damper.hpp"
+#include "diagnostic_aggregator/status_item.hpp"
+#include "diagnostic_aggregator/window_statistics.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+#include "diagnostic_msgs/msg/key_value.hpp"
+
+using diagnostic_aggregator::FlapDamper;
+using diagnostic_aggregator::StatusItem;
+using diagnostic_aggregator::WindowStatistics;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+DiagnosticStatus makeStatus(const std::vector<std::pair<std::string, std::string>> & values)
+{
+  DiagnosticStatus status;
+  status.name = "Sensor";
+  for (const auto & value : values) {
+    diagnostic_msgs::msg::KeyValue kv;
+    kv.key = value.first;
+    kv.value = value.second;
+    status.values.push_back(kv);
+  }
+  return status;
+}
+
+rclcpp::Time at(double seconds)
+{
+  return rclcpp::Time(static_cast<int64_t>(seconds * 1e9), RCL_ROS_TIME);
+}
+}  // namespace
+
+TEST(StatusItem, parsesNumbers)
+{
+  DiagnosticStatus status = makeStatus(
+    {{"Temperature", "45.5"}, {"Padded", " 12 "}, {"Unit", "3 Hz"}, {"Name", "lidar"},
+      {"Empty", ""}});
+  StatusItem item(&status);
+
+  double value = 0.0;
+  EXPECT_TRUE(item.getNumber("Temperature", value));
+  EXPECT_DOUBLE_EQ(45.5, value);
+  EXPECT_TRUE(item.getNumber("Padded", value));
+  EXPECT_DOUBLE_EQ(12.0, value);
+  EXPECT_FALSE(item.getNumber("Unit", value));
+  EXPECT_FALSE(item.getNumber("Name", value));
+  EXPECT_FALSE(item.getNumber("Empty", value));
+  EXPECT_FALSE(item.getNumber("Missing", value));
+
+  DiagnosticStatus update = makeStatus({{"Temperature", "50"}});
+  ASSERT_TRUE(item.update(&update));
+  EXPECT_TRUE(item.getNumber("Temperature", value));
+  EXPECT_DOUBLE_EQ(50.0, value);
+  EXPECT_FALSE(item.getNumber("Padded", value));
+}
+
+TEST(StatusItem, continuesStatistics)
+{
+  std::shared_ptr<StatusItem> previous;
+  for (int i = 1; i <= 4; ++i) {
+    DiagnosticStatus status = makeStatus(
+      {{"Temperature", std::to_string(10 * i)}, {"Name", "lidar"}, {"Count", "1"}});
+    auto item = std::make_shared<StatusItem>(&status);
+    item->trackStatistics(60.0, {"Temperature", "Name"}, previous.get());
+    // Tracking twice must not add the values twice
+    item->trackStatistics(60.0, {"Temperature", "Name"}, previous.get());
+    previous = item;
+  }
+
+  const WindowStatistics * statistics = previous->getStatistics("Temperature");
+  ASSERT_NE(nullptr, statistics);
+  EXPECT_EQ(4u, statistics->count());
+  EXPECT_DOUBLE_EQ(10.0, statistics->min());
+  EXPECT_DOUBLE_EQ(40.0, statistics->max());
+  EXPECT_DOUBLE_EQ(25.0, statistics->mean());
+
+  EXPECT_EQ(nullptr, previous->getStatistics("Name"));
+  EXPECT_EQ(nullptr, previous->getStatistics("Count"));
+}
+
+TEST(StatusItem, dampsFlaps)
+{
+  const unsigned char levels[] = {
+    DiagnosticStatus::OK, DiagnosticStatus::WARN, DiagnosticStatus::OK, DiagnosticStatus::ERROR};
+  const unsigned char expected[] = {
+    DiagnosticStatus::OK, DiagnosticStatus::WARN, DiagnosticStatus::WARN, DiagnosticStatus::ERROR};
+  std::shared_ptr<StatusItem> previous;
+  for (int i = 0; i < 4; ++i) {
+    DiagnosticStatus status = makeStatus({});
+    status.level = levels[i];
+    status.message = "Message " + std::to_string(i);
+    auto item = std::make_shared<StatusItem>(&status);
+    item->dampFlaps(60.0, 60.0, 0, previous.get());
+    // Damping twice must not count the flap twice
+    item->dampFlaps(60.0, 60.0, 0, previous.get());
+    EXPECT_EQ(expected[i], item->getLevel());
+    if (i == 2) {
+      // The held level keeps its message
+      EXPECT_EQ("Message 1", item->getMessage());
+    }
+    previous = item;
+  }
+
+  ASSERT_NE(nullptr, previous->getFlapDamper());
+  EXPECT_EQ(3u, previous->getFlapDamper()->getFlapCount());
+  EXPECT_EQ(3u, previous->getFlapDamper()->getTotalFlaps());
+}
+
+TEST(FlapDamper, holdsWhileFlapping)
+{
+  FlapDamper damper(1.0, 10.0, 4);
+  EXPECT_EQ(DiagnosticStatus::OK, damper.update(at(0.0), DiagnosticStatus::OK));
+
+  // A lower level is reported once it lasted the dwell time
+  EXPECT_EQ(DiagnosticStatus::WARN, damper.update(at(1.0), DiagnosticStatus::WARN));
+  EXPECT_EQ(DiagnosticStatus::WARN, damper.update(at(1.5), DiagnosticStatus::OK));
+  EXPECT_EQ(DiagnosticStatus::OK, damper.update(at(2.5), DiagnosticStatus::OK));
+  EXPECT_FALSE(damper.isFlapping());
+
+  // The fourth flap within 10 s holds the highest level
+  EXPECT_EQ(DiagnosticStatus::WARN, damper.update(at(3.0), DiagnosticStatus::WARN));
+  EXPECT_EQ(DiagnosticStatus::WARN, damper.update(at(5.0), DiagnosticStatus::OK));
+  EXPECT_TRUE(damper.isFlapping());
+  EXPECT_EQ(DiagnosticStatus::WARN, damper.update(at(8.0), DiagnosticStatus::OK));
+  EXPECT_EQ(4u, damper.getFlapCount());
+
+  // Until a window without flaps
+  EXPECT_EQ(DiagnosticStatus::WARN, damper.update(at(14.0), DiagnosticStatus::OK));
+  EXPECT_TRUE(damper.isFlapping());
+  EXPECT_EQ(DiagnosticStatus::OK, damper.update(at(15.5), DiagnosticStatus::OK));
+  EXPECT_FALSE(damper.isFlapping());
+  EXPECT_EQ(0u, damper.getFlapCount());
+  EXPECT_EQ(4u, damper.getTotalFlaps());
+}
+
+TEST(WindowStatistics, slidesWindow)
+{
+  WindowStatistics statistics(10.0);
+  EXPECT_EQ(0u, statistics.count());
+  EXPECT_DOUBLE_EQ(0.0, statistics.percentile(0.5));
+
+  const double values[] = {5.0, 1.0, 9.0, 3.0, 7.0};
+  for (int i = 0; i < 5; ++i) {
+    statistics.add(at(i * 4.0), values[i]);
+  }
+
+  // Window (6s, 16s] holds 9, 3, 7
+  EXPECT_EQ(3u, statistics.count());
+  EXPECT_DOUBLE_EQ(3.0, statistics.min());
+  EXPECT_DOUBLE_EQ(9.0, statistics.max());
+  EXPECT_DOUBLE_EQ(19.0 / 3.0, statistics.mean());
+  EXPECT_DOUBLE_EQ(7.0, statistics.percentile(0.5));
+  EXPECT_DOUBLE_EQ(9.0, statistics.percentile(0.95));
+  EXPECT_DOUBLE_EQ(3.0, statistics.percentile(0.0));
+
+  statistics.add(at(40.0), 2.0);
+  EXPECT_EQ(1u, statistics.count());
+  EXPECT_DOUBLE_EQ(2.0, statistics.min());
+  EXPECT_DOUBLE_EQ(2.0, statistics.max());
+  EXPECT_DOUBLE_EQ(2.0, statistics.mean());
+}
@@ -0,0 +1,100 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "diagnostic_aggregator/subtree_publisher.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+using diagnostic_aggregator::SubtreeIndex;
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+DiagnosticArray makeTree(const std::vector<std::string> & names)
+{
+  DiagnosticArray tree;
+  for (const auto & name : names) {
+    DiagnosticStatus status;
+    status.name = name;
+    tree.status.push_back(status);
+  }
+  return tree;
+}
+
+std::vector<std::string> cut(const SubtreeIndex & index, const std::string & path)
+{
+  std::vector<DiagnosticStatus> statuses;
+  index.cut(path, statuses);
+  std::vector<std::string> names;
+  for (const auto & status : statuses) {
+    names.push_back(status.name);
+  }
+  return names;
+}
+}  // namespace
+
+TEST(SubtreeIndex, cutsSubtrees)
+{
+  DiagnosticArray tree = makeTree(
+    {"/Robot", "/Robot/Sensors/Lidar", "/Robot/Motors", "/Robot/Sensors", "/Robot/SensorsX",
+      "/Robot/Sensors Extra", "/Robot/Sensors/Camera", "/Other"});
+  SubtreeIndex index;
+  index.build(tree);
+
+  EXPECT_EQ(
+    std::vector<std::string>({"/Robot/Sensors", "/Robot/Sensors/Camera", "/Robot/Sensors/Lidar"}),
+    cut(index, "/Robot/Sensors"));
+  EXPECT_EQ(cut(index, "/Robot/Sensors"), cut(index, "/Robot/Sensors/"));
+  EXPECT_EQ(std::vector<std::string>({"/Robot/Motors"}), cut(index, "/Robot/Motors"));
+  EXPECT_EQ(7u, cut(index, "/Robot").size());
+  EXPECT_TRUE(cut(index, "/Robot/Sensor").empty());
+  EXPECT_TRUE(cut(index, "/Missing").empty());
+}
+
+TEST(SubtreeIndex, emptyBeforeBuild)
+{
+  SubtreeIndex index;
+  EXPECT_TRUE(cut(index, "/Robot").empty());
+
+  DiagnosticArray tree;
+  index.build(tree);
+  EXPECT_TRUE(cut(index, "/Robot").empty());
+}
@@ -0,0 +1,231 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "diagnostic_aggregator/status_item.hpp"
+#include "diagnostic_aggregator/threshold_analyzer.hpp"
+#include "diagnostic_aggregator/threshold_rule.hpp"
+
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+#include "diagnostic_msgs/msg/key_value.hpp"
+
+#include "rcl/time.h"
+
+#include "rclcpp/rclcpp.hpp"
+
+using diagnostic_aggregator::StatusItem;
+using diagnostic_aggregator::ThresholdAnalyzer;
+using diagnostic_aggregator::ThresholdRule;
+using diagnostic_msgs::msg::DiagnosticStatus;
+
+namespace
+{
+StatusItem makeItem(
+  unsigned char level, const std::string & message,
+  const std::vector<std::pair<std::string, std::string>> & values)
+{
+  DiagnosticStatus status;
+  status.name = "motor: Left";
+  status.level = level;
+  status.message = message;
+  status.hardware_id = "motor_1";
+  for (const auto & value : values) {
+    diagnostic_msgs::msg::KeyValue kv;
+    kv.key = value.first;
+    kv.value = value.second;
+    status.values.push_back(kv);
+  }
+  return StatusItem(&status);
+}
+
+bool test(const std::string & source, const StatusItem & item, double age = 0.0)
+{
+  ThresholdRule rule;
+  std::string error;
+  EXPECT_TRUE(rule.compile(source, error)) << error;
+  return rule.test(item, age);
+}
+}  // namespace
+
+TEST(ThresholdRule, parsesRule)
+{
+  ThresholdRule rule;
+  std::string error;
+  ASSERT_TRUE(rule.compile("ERROR if Temperature > 80 for 5", error)) << error;
+  EXPECT_EQ(diagnostic_aggregator::Level_Error, rule.getLevel());
+  EXPECT_DOUBLE_EQ(5.0, rule.getDuration());
+  EXPECT_FALSE(rule.usesAge());
+  EXPECT_EQ("Temperature > 80 for 5", rule.getDescription());
+
+  ASSERT_TRUE(rule.compile("WARN if age > 2.5", error)) << error;
+  EXPECT_EQ(diagnostic_aggregator::Level_Warn, rule.getLevel());
+  EXPECT_DOUBLE_EQ(0.0, rule.getDuration());
+  EXPECT_TRUE(rule.usesAge());
+}
+
+TEST(ThresholdRule, rejectsInvalidRules)
+{
+  const char * invalid[] = {
+    "",
+    "Temperature > 80",
+    "BAD if Temperature > 80",
+    "ERROR Temperature > 80",
+    "ERROR if",
+    "ERROR if Temperature >",
+    "ERROR if (Temperature > 80",
+    "ERROR if Temperature > 80 for",
+    "ERROR if Temperature > 80 extra",
+    "ERROR if message > 1",
+    "ERROR if message",
+    "ERROR if 'a' == 'b'",
+    "ERROR if `Unterminated > 1",
+    "ERROR if Temperature # 1"};
+  for (const char * source : invalid) {
+    ThresholdRule rule;
+    std::string error;
+    EXPECT_FALSE(rule.compile(source, error)) << source;
+    EXPECT_FALSE(error.empty()) << source;
+  }
+}
+
+TEST(ThresholdRule, evaluatesConditions)
+{
+  StatusItem item = makeItem(
+    DiagnosticStatus::WARN, "Degraded",
+    {{"Temperature", "85.5"}, {"Actual frequency", "9"}, {"Target frequency", "10"},
+      {"Mode", "auto"}, {"Name", "left"}});
+
+  EXPECT_TRUE(test("ERROR if Temperature > 80", item));
+  EXPECT_FALSE(test("ERROR if Temperature > 90", item));
+  EXPECT_TRUE(test("ERROR if Temperature - 5 * 2 < 80 && Temperature >= 85.5", item));
+  EXPECT_TRUE(test("ERROR if (1 + 2) * 3 == 9", item));
+  EXPECT_TRUE(test("ERROR if -Temperature < 0", item));
+  EXPECT_TRUE(test("WARN if `Actual frequency` < 0.95 * `Target frequency`", item));
+  EXPECT_TRUE(test("ERROR if level == WARN", item));
+  EXPECT_TRUE(test("ERROR if level >= WARN and not level == ERROR", item));
+  EXPECT_TRUE(test("ERROR if message == 'Degraded'", item));
+  EXPECT_TRUE(test("ERROR if \"motor_1\" == hardware_id", item));
+  EXPECT_TRUE(test("ERROR if name != 'other'", item));
+  EXPECT_TRUE(test("ERROR if Mode == \"auto\" || Temperature > 100", item));
+  EXPECT_FALSE(test("ERROR if Mode != 'auto'", item));
+  EXPECT_TRUE(test("ERROR if `Name` == 'left'", item));
+  EXPECT_TRUE(test("ERROR if age > 2", item, 3.0));
+  EXPECT_FALSE(test("ERROR if age > 2", item, 1.0));
+}
+
+TEST(ThresholdRule, missingValuesAreNotNumbers)
+{
+  StatusItem item = makeItem(DiagnosticStatus::OK, "OK", {{"Mode", "auto"}});
+
+  EXPECT_FALSE(test("ERROR if Missing > 80", item));
+  EXPECT_FALSE(test("ERROR if Missing <= 80", item));
+  EXPECT_FALSE(test("ERROR if Mode > 0", item));
+  EXPECT_FALSE(test("ERROR if Missing", item));
+  EXPECT_TRUE(test("ERROR if !Missing", item));
+  EXPECT_FALSE(test("ERROR if Missing == 'x'", item));
+  EXPECT_TRUE(test("ERROR if Missing != 'x'", item));
+}
+
+TEST(ThresholdAnalyzer, forgetsDiscardedItems)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "test_threshold_analyzer", rclcpp::NodeOptions().allow_undeclared_parameters(true).
+    automatically_declare_parameters_from_overrides(true).parameter_overrides(
+      {{"motors.path", "Motors"}, {"motors.startswith", std::vector<std::string>{"motor"}},
+        {"motors.timeout", 2.0}, {"motors.discard_stale", true},
+        {"motors.rules", std::vector<std::string>{"ERROR if Temperature > 80 for 5"}}}));
+  auto clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(clock->get_clock_handle()));
+  auto set_time = [&clock](double seconds) {
+      ASSERT_EQ(
+        RCL_RET_OK, rcl_set_ros_time_override(
+          clock->get_clock_handle(), static_cast<std::int64_t>(seconds * 1e9)));
+    };
+  // Level of the motor in a report, -1 if it isn't reported
+  auto level = [](const std::vector<std::shared_ptr<DiagnosticStatus>> & report) {
+      for (const auto & status : report) {
+        if (status->name == "/Motors/motor") {
+          return static_cast<int>(status->level);
+        }
+      }
+      return -1;
+    };
+
+  ThresholdAnalyzer analyzer;
+  ASSERT_TRUE(analyzer.init("", "motors", node));
+  analyzer.setClock(clock);
+
+  DiagnosticStatus status;
+  status.name = "motor";
+  status.level = DiagnosticStatus::OK;
+  diagnostic_msgs::msg::KeyValue kv;
+  kv.key = "Temperature";
+  kv.value = "90";
+  status.values.push_back(kv);
+  ASSERT_TRUE(analyzer.match(status.name));
+
+  set_time(1000.0);
+  analyzer.analyze(std::make_shared<StatusItem>(&status, clock));
+  EXPECT_EQ(DiagnosticStatus::OK, level(analyzer.report()));
+
+  // Discarded once stale
+  set_time(1003.0);
+  EXPECT_EQ(-1, level(analyzer.report()));
+
+  // When it comes back, the duration of the rule starts again
+  set_time(1010.0);
+  analyzer.analyze(std::make_shared<StatusItem>(&status, clock));
+  EXPECT_EQ(DiagnosticStatus::OK, level(analyzer.report()));
+  set_time(1011.0);
+  analyzer.analyze(std::make_shared<StatusItem>(&status, clock));
+  set_time(1015.0);
+  analyzer.analyze(std::make_shared<StatusItem>(&status, clock));
+  EXPECT_EQ(DiagnosticStatus::ERROR, level(analyzer.report()));
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  rclcpp::init(argc, argv);
+  int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
@@ -40,12 +40,24 @@
 #define DIAGNOSTIC_UPDATER__DIAGNOSTIC_STATUS_WRAPPER_HPP_
 
 #include <stdarg.h>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+#include <chrono>
 #include <cstdio>
+#include <cstring>
 #include <sstream>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "diagnostic_msgs/msg/diagnostic_status.hpp"
+#include "diagnostic_msgs/msg/key_value.hpp"
 
 #include "rclcpp/logger.hpp"
 #include "rclcpp/logging.hpp"
@@ -53,6 +65,25 @@
 namespace diagnostic_updater
 {
 
+namespace detail
+{
+struct NoStreamOperator {};
+
+/// Only chosen for enums without a << stream operator of their own: the
+/// operator of an enum is preferred to this template, and this exact match
+/// to the promotion of an unscoped enum to int.
+template<class T, typename std::enable_if<std::is_enum<T>::value, int>::type = 0>
+NoStreamOperator operator<<(std::ostream &, const T &);
+
+template<class T, bool = std::is_enum<T>::value>
+struct HasStreamOperator : std::integral_constant<bool, !std::is_same<
+      decltype(std::declval<std::ostream &>() << std::declval<const T &>()),
+      NoStreamOperator>::value> {};
+
+template<class T>
+struct HasStreamOperator<T, false>: std::true_type {};
+}  // namespace detail
+
 /**
  *
  * \brief Wrapper for the diagnostic_msgs::msg::DiagnosticStatus message that
@@ -68,9 +99,7 @@ namespace diagnostic_updater
 class DiagnosticStatusWrapper : public diagnostic_msgs::msg::DiagnosticStatus
 {
 public:
-  DiagnosticStatusWrapper()
-  : debug_logger_(rclcpp::get_logger("diagnostics_wrapper_logger"))
-  {}
+  DiagnosticStatusWrapper() = default;
 
   /**
    * \brief Copy constructor
@@ -88,7 +117,7 @@ public:
    * \param lvl Numerical level to assign to this Status (OK, Warn, Err).
    * \param s Descriptive status message.
    */
-  void summary(unsigned char lvl, const std::string s)
+  void summary(unsigned char lvl, const std::string & s)
   {
     level = lvl;
     message = s;
@@ -114,7 +143,7 @@ public:
    * \param s Descriptive status message for the merged-in summary.
    */
 
-  void mergeSummary(unsigned char lvl, const std::string s)
+  void mergeSummary(unsigned char lvl, const std::string & s)
   {
     if ((lvl > 0) && (level > 0)) {
       if (!message.empty()) {
@@ -156,17 +185,10 @@ public:
   void mergeSummaryf(unsigned char lvl, const char * format, ...)
   {
     va_list va;
-    const int kBufferSize = 1000;
-    char buff[kBufferSize];  //  @todo This could be done more elegantly.
     va_start(va, format);
-    if (vsnprintf(buff, sizeof(buff), format, va) >= kBufferSize) {
-      RCLCPP_DEBUG(
-        debug_logger_,
-        "Really long string in DiagnosticStatusWrapper::mergeSummaryf, it was truncated.");
-    }
-    std::string value = std::string(buff);
-    mergeSummary(lvl, value);
+    formatTo(formatted_, format, va);
     va_end(va);
+    mergeSummary(lvl, formatted_);
   }
 
   /**
@@ -183,17 +205,12 @@ public:
   void summaryf(unsigned char lvl, const char * format, ...)
   {
     va_list va;
-    const int kBufferSize = 1000;
-    char buff[kBufferSize];
     va_start(va, format);
-    if (vsnprintf(buff, sizeof(buff), format, va) >= kBufferSize) {
-      RCLCPP_DEBUG(
-        debug_logger_,
-        "Really long string in DiagnosticStatusWrapper::summaryf, it was truncated.");
-    }
-    std::string value = std::string(buff);
-    summary(lvl, value);
+    formatTo(formatted_, format, va);
     va_end(va);
+    // The arguments may point into message, so it is only assigned afterwards
+    message = formatted_;
+    level = lvl;
   }
 
   /**
@@ -217,39 +234,381 @@ public:
    *
    * This method adds a key-value pair. Any type that has a << stream
    * operator can be passed as the second argument.  Formatting is done
-   * using a std::stringstream.
+   * using a std::stringstream, except for numbers, C strings and enums
+   * without a << operator of their own, which are formatted directly as a
+   * stream would, enums as their value.
    *
    * \param key Key to be added.  \param value Value to be added.
    */
   template<class T>
   void add(const std::string & key, const T & val)
   {
-    std::stringstream ss;
-    ss << val;
-    std::string sval = ss.str();
-    add(key, sval);
+    addValue(key, val, IsNumber<T>(), std::is_convertible<const T &, const char *>());
+  }
+
+  /**
+   * \brief Add a key-value pair with a duration, in seconds.
+   */
+  template<class Rep, class Period>
+  void add(const std::string & key, const std::chrono::duration<Rep, Period> & val)
+  {
+    add(key, std::chrono::duration<double>(val).count());
   }
 
   /**
    * \brief Add a key-value pair using a format string.
    *
    * This method adds a key-value pair. A format string is used to set the
-   * value. The current implementation limits the value to 1000 characters
-   * in length.
+   * value, which is formatted in place and isn't truncated.
    */
 
   void addf(const std::string & key, const char * format, ...);
 
+  /**
+   * \brief A value added with stage(), kept typed until it is formatted.
+   */
+  struct StagedValue
+  {
+    enum class Type {Signed, Unsigned, Real, Text};
+
+    std::string key;
+    Type type = Type::Signed;
+    long long signed_value = 0;  // NOLINT
+    unsigned long long unsigned_value = 0;  // NOLINT
+    double real_value = 0.0;
+    std::string text;
+
+    bool operator==(const StagedValue & other) const
+    {
+      return type == other.type && signed_value == other.signed_value &&
+             unsigned_value == other.unsigned_value && real_value == other.real_value &&
+             key == other.key && text == other.text;
+    }
+
+    bool operator!=(const StagedValue & other) const {return !(*this == other);}
+  };
+
+  /**
+   * \brief Stage a key-value pair, formatted only when it is published.
+   *
+   * Numbers, enums without a << operator, durations and strings can be staged. They are kept
+   * typed, and formatted by formatStaged() after the values added with
+   * add(). The Updater only formats them for the statuses it publishes, so
+   * with publish on change, unchanged values are never formatted.
+   *
+   * The staged values aren't part of a copy as a DiagnosticStatus. A wrapper
+   * completing the future of an asynchronous task, or otherwise copied as
+   * a message, must be copied with toMessage() instead.
+   *
+   * \param key Key to be added.  \param value Value to be added.
+   */
+  template<class T>
+  void stage(const std::string & key, const T & val)
+  {
+    static_assert(
+      IsNumber<T>::value,
+      "Only numbers, enums without a << operator, durations and strings can be staged");
+    setStaged(nextStaged(key), static_cast<typename Formatted<T>::type>(val));
+  }
+
+  template<class Rep, class Period>
+  void stage(const std::string & key, const std::chrono::duration<Rep, Period> & val)
+  {
+    stage(key, std::chrono::duration<double>(val).count());
+  }
+
+  void stage(const std::string & key, const std::string & text)
+  {
+    StagedValue & staged = nextStaged(key);
+    staged.type = StagedValue::Type::Text;
+    staged.text = text;
+  }
+
+  void stage(const std::string & key, const char * text)
+  {
+    StagedValue & staged = nextStaged(key);
+    staged.type = StagedValue::Type::Text;
+    staged.text = text;
+  }
+
+  void stage(const std::string & key, bool b)
+  {
+    stage(key, b ? "True" : "False");
+  }
+
+  /**
+   * \brief Whether the staged values differ from the ones staged before the
+   * last clear().
+   */
+  bool stagedChanged() const
+  {
+    if (staged_size_ != previous_size_) {
+      return true;
+    }
+    for (size_t i = 0; i < staged_size_; ++i) {
+      if (staged_[i] != previous_[i]) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * \brief Returns the value staged with the key before the last clear(),
+   * or nullptr.
+   */
+  const StagedValue * getPrevious(const std::string & key) const
+  {
+    for (size_t i = 0; i < previous_size_; ++i) {
+      if (previous_[i].key == key) {
+        return &previous_[i];
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * \brief Copies the status as a message, with its staged values formatted.
+   *
+   * A plain copy as a DiagnosticStatus doesn't have the staged values.
+   */
+  diagnostic_msgs::msg::DiagnosticStatus toMessage() const
+  {
+    diagnostic_msgs::msg::DiagnosticStatus message = *this;
+    formatStaged(message.values);
+    return message;
+  }
+
+  /**
+   * \brief Formats the staged values, appending them to the given values.
+   */
+  void formatStaged(std::vector<diagnostic_msgs::msg::KeyValue> & out) const
+  {
+    for (size_t i = 0; i < staged_size_; ++i) {
+      const StagedValue & staged = staged_[i];
+      out.emplace_back();
+      out.back().key = staged.key;
+      char buffer[kNumberSize];
+      switch (staged.type) {
+        case StagedValue::Type::Signed:
+          out.back().value.assign(buffer, formatNumber(buffer, staged.signed_value));
+          break;
+        case StagedValue::Type::Unsigned:
+          out.back().value.assign(buffer, formatNumber(buffer, staged.unsigned_value));
+          break;
+        case StagedValue::Type::Real:
+          out.back().value.assign(buffer, formatNumber(buffer, staged.real_value));
+          break;
+        case StagedValue::Type::Text:
+          out.back().value = staged.text;
+          break;
+      }
+    }
+  }
+
   /**
    * \brief Clear the key-value pairs.
    *
-   * The values vector containing the key-value pairs is cleared.
+   * The values vector containing the key-value pairs is cleared. The staged
+   * values are kept for stagedChanged() and getPrevious(), and the next
+   * ones are staged over them, reusing their strings.
    */
 
-  void clear() {values.clear();}
+  void clear()
+  {
+    values.clear();
+    previous_.swap(staged_);
+    previous_size_ = staged_size_;
+    staged_size_ = 0;
+  }
 
 private:
-  rclcpp::Logger debug_logger_;
+  /// Characters, not characters codes, are streamed as text, as are enums
+  /// with a << operator.
+  template<class T>
+  struct IsNumber : std::integral_constant<bool, !detail::HasStreamOperator<T>::value ||
+      (std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+      !std::is_same<T, char>::value && !std::is_same<T, signed char>::value &&
+      !std::is_same<T, unsigned char>::value && !std::is_same<T, wchar_t>::value &&
+      !std::is_same<T, char16_t>::value && !std::is_same<T, char32_t>::value)> {};
+
+  /// The type a number is formatted as, enums as their underlying type.
+  template<class T, bool = std::is_enum<T>::value>
+  struct Formatted
+  {
+    using type = typename Formatted<typename std::underlying_type<T>::type>::type;
+  };
+
+  template<class T>
+  struct Formatted<T, false>
+  {
+    using type = typename std::conditional<std::is_floating_point<T>::value,
+        typename std::conditional<std::is_same<T, long double>::value, long double, double>::type,
+        typename std::conditional<std::is_signed<T>::value, long long,  // NOLINT
+        unsigned long long>::type>::type;  // NOLINT
+  };
+
+  /// Large enough for any number formatted by formatNumber().
+  static constexpr size_t kNumberSize = 32;
+
+  template<class T>
+  void addValue(const std::string & key, const T & val, std::true_type, std::false_type)
+  {
+    char buffer[kNumberSize];
+    size_t size = formatNumber(buffer, static_cast<typename Formatted<T>::type>(val));
+    addValue(key, buffer, size);
+  }
+
+  template<class T>
+  void addValue(const std::string & key, const T & val, std::false_type, std::true_type)
+  {
+    const char * s = val;
+    addValue(key, s, std::strlen(s));
+  }
+
+  template<class T>
+  void addValue(const std::string & key, const T & val, std::false_type, std::false_type)
+  {
+    std::stringstream ss;
+    ss << val;
+    std::string sval = ss.str();
+    addValue(key, sval.c_str(), sval.size());
+  }
+
+  void addValue(const std::string & key, const char * val, size_t size)
+  {
+    if (values.size() == values.capacity()) {
+      // key and val may point into values, which is about to move
+      std::string key_copy(key);
+      std::string val_copy(val, size);
+      values.emplace_back();
+      values.back().key = std::move(key_copy);
+      values.back().value = std::move(val_copy);
+      return;
+    }
+    values.emplace_back();
+    values.back().key = key;
+    values.back().value.assign(val, size);
+  }
+
+  /*
+   * Numbers are formatted as a std::stringstream with the default flags
+   * would, that is like printf's %g with a precision of 6 for floating
+   * point numbers, with std::to_chars where the standard library has it.
+   */
+#ifdef __cpp_lib_to_chars
+  static size_t formatNumber(char * buffer, long long val)  // NOLINT
+  {
+    return std::to_chars(buffer, buffer + kNumberSize, val).ptr - buffer;
+  }
+
+  static size_t formatNumber(char * buffer, unsigned long long val)  // NOLINT
+  {
+    return std::to_chars(buffer, buffer + kNumberSize, val).ptr - buffer;
+  }
+
+  static size_t formatNumber(char * buffer, double val)
+  {
+    return std::to_chars(buffer, buffer + kNumberSize, val, std::chars_format::general, 6).ptr -
+           buffer;
+  }
+
+  static size_t formatNumber(char * buffer, long double val)
+  {
+    return std::to_chars(buffer, buffer + kNumberSize, val, std::chars_format::general, 6).ptr -
+           buffer;
+  }
+#else
+  static size_t formatNumber(char * buffer, long long val)  // NOLINT
+  {
+    return snprintf(buffer, kNumberSize, "%lld", val);
+  }
+
+  static size_t formatNumber(char * buffer, unsigned long long val)  // NOLINT
+  {
+    return snprintf(buffer, kNumberSize, "%llu", val);
+  }
+
+  static size_t formatNumber(char * buffer, double val)
+  {
+    return snprintf(buffer, kNumberSize, "%g", val);
+  }
+
+  static size_t formatNumber(char * buffer, long double val)
+  {
+    return snprintf(buffer, kNumberSize, "%Lg", val);
+  }
+#endif
+
+  /**
+   * Formats into s, reusing its capacity, and growing it if the result
+   * doesn't fit.
+   */
+  static void formatTo(std::string & s, const char * format, va_list va)
+  {
+    va_list retry;
+    va_copy(retry, va);
+    s.resize(s.capacity());
+    int size = vsnprintf(&s[0], s.size() + 1, format, va);
+    if (size < 0) {
+      s.clear();
+    } else if (static_cast<size_t>(size) > s.size()) {
+      s.resize(size);
+      vsnprintf(&s[0], s.size() + 1, format, retry);
+    } else {
+      s.resize(size);
+    }
+    va_end(retry);
+  }
+
+  StagedValue & nextStaged(const std::string & key)
+  {
+    if (staged_size_ == staged_.size()) {
+      staged_.emplace_back();
+    }
+    StagedValue & staged = staged_[staged_size_++];
+    staged.key = key;
+    staged.signed_value = 0;
+    staged.unsigned_value = 0;
+    staged.real_value = 0.0;
+    staged.text.clear();
+    return staged;
+  }
+
+  static void setStaged(StagedValue & staged, long long val)  // NOLINT
+  {
+    staged.type = StagedValue::Type::Signed;
+    staged.signed_value = val;
+  }
+
+  static void setStaged(StagedValue & staged, unsigned long long val)  // NOLINT
+  {
+    staged.type = StagedValue::Type::Unsigned;
+    staged.unsigned_value = val;
+  }
+
+  static void setStaged(StagedValue & staged, double val)
+  {
+    staged.type = StagedValue::Type::Real;
+    staged.real_value = val;
+  }
+
+  static void setStaged(StagedValue & staged, long double val)
+  {
+    setStaged(staged, static_cast<double>(val));
+  }
+
+  /// Reused by the formatting methods, whose arguments may point into
+  /// message or values.
+  std::string formatted_;
+
+  /// The staged values, and the ones before the last clear(). The vectors
+  /// are only grown, their first staged_size_ and previous_size_ values are
+  /// in use.
+  std::vector<StagedValue> staged_;
+  std::vector<StagedValue> previous_;
+  size_t staged_size_ = 0;
+  size_t previous_size_ = 0;
 };
 
 template<>
@@ -257,10 +616,7 @@ inline void DiagnosticStatusWrapper::add<std::string>(
   const std::string & key,
   const std::string & s)
 {
-  diagnostic_msgs::msg::KeyValue ds;
-  ds.key = key;
-  ds.value = s;
-  values.push_back(ds);
+  addValue(key, s.c_str(), s.size());
 }
 
 //  /\brief For bool, diagnostic value is "True" or "False"
@@ -269,11 +625,7 @@ inline void DiagnosticStatusWrapper::add<bool>(
   const std::string & key,
   const bool & b)
 {
-  diagnostic_msgs::msg::KeyValue ds;
-  ds.key = key;
-  ds.value = b ? "True" : "False";
-
-  values.push_back(ds);
+  add(key, b ? "True" : "False");
 }
 
 // Need to place addf after DiagnosticStatusWrapper::add<std::string> or
@@ -283,17 +635,10 @@ DiagnosticStatusWrapper::addf(
   const std::string & key, const char * format, ...)  // In practice format will always be a char *
 {
   va_list va;
-  const int kBufferSize = 1000;
-  char buff[kBufferSize];  // @todo This could be done more elegantly.
   va_start(va, format);
-  if (vsnprintf(buff, sizeof(buff), format, va) >= kBufferSize) {
-    RCLCPP_DEBUG(
-      debug_logger_,
-      "Really long string in DiagnosticStatusWrapper::addf, it was truncated.");
-  }
-  std::string value = std::string(buff);
-  add(key, value);
+  formatTo(formatted_, format, va);
   va_end(va);
+  addValue(key, formatted_.c_str(), formatted_.size());
 }
 }  // namespace diagnostic_updater
 #endif  // DIAGNOSTIC_UPDATER__DIAGNOSTIC_STATUS_WRAPPER_HPP_
@@ -35,8 +35,13 @@
 #ifndef DIAGNOSTIC_UPDATER__DIAGNOSTIC_UPDATER_HPP_
 #define DIAGNOSTIC_UPDATER__DIAGNOSTIC_UPDATER_HPP_
 
+#include <chrono>
+#include <cstdint>
 #include <functional>  // for bind()
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -63,6 +68,14 @@ namespace diagnostic_updater
 typedef std::function<void (DiagnosticStatusWrapper &)> TaskFunction;
 typedef std::function<void (diagnostic_msgs::msg::DiagnosticStatus &)>
   UnwrappedTaskFunction;
+/**
+ * A task that starts its work and returns the future status, completed by
+ * its own I/O. The name of the status is set by the DiagnosticTaskVector.
+ * A std::future rather than a coroutine, which would need C++20, while this
+ * header is still built as C++14 by dependents like self_test.
+ */
+typedef std::function<std::future<diagnostic_msgs::msg::DiagnosticStatus>()>
+  AsyncTaskFunction;
 
 /**
  * \brief DiagnosticTask is an abstract base class for collecting diagnostic
@@ -217,20 +230,55 @@ protected:
   class DiagnosticTaskInternal
   {
 public:
-    DiagnosticTaskInternal(const std::string name, TaskFunction f)
-    : name_(name), fn_(f) {}
+    DiagnosticTaskInternal(const std::string name, TaskFunction f, double period = 0.0)
+    : name_(name), fn_(f), period_(period) {}
 
+    DiagnosticTaskInternal(const std::string name, AsyncTaskFunction f, double period = 0.0)
+    : name_(name), async_fn_(f), period_(period) {}
+
+    /**
+     * \brief Runs the task, and waits for the status of an asynchronous one.
+     */
     void run(diagnostic_updater::DiagnosticStatusWrapper & stat) const
     {
       stat.name = name_;
-      fn_(stat);
+      if (async_fn_) {
+        diagnostic_msgs::msg::DiagnosticStatus & status = stat;
+        status = async_fn_().get();
+        stat.name = name_;
+      } else {
+        fn_(stat);
+      }
     }
 
+    /**
+     * \brief Starts an asynchronous task, see isAsync().
+     */
+    std::future<diagnostic_msgs::msg::DiagnosticStatus> start() const {return async_fn_();}
+
+    bool isAsync() const {return static_cast<bool>(async_fn_);}
+
     const std::string & getName() const {return name_;}
 
+    /**
+     * \brief Seconds between runs of the task, 0 for the default period.
+     */
+    double getPeriod() const {return period_;}
+
+    /**
+     * \brief Identifies the task among the tasks added to the vector, even
+     * if they have the same name.
+     */
+    uint64_t getId() const {return id_;}
+
 private:
+    friend class DiagnosticTaskVector;
+
     std::string name_;
     TaskFunction fn_;
+    AsyncTaskFunction async_fn_;
+    double period_;
+    uint64_t id_ = 0;
   };
 
   std::mutex lock_;
@@ -253,10 +301,35 @@ public:
    * This function need not remain valid after the last time the tasks are
    * called, and in particular it need not be valid at the time the
    * DiagnosticTaskVector is destructed.
+   *
+   * \param period Seconds between runs of the task, used by the Updater. The
+   * default of 0 runs it at the period of the Updater.
+   */
+  void add(const std::string & name, TaskFunction f, double period = 0.0)
+  {
+    DiagnosticTaskInternal int_task(name, f, period);
+    addInternal(int_task);
+  }
+
+  /**
+   * \brief Add an asynchronous task embodied by a name and function to the
+   * DiagnosticTaskVector
+   *
+   * The Updater starts the task when it is due, and publishes its status once
+   * the future is ready, without waiting for it. The function and the work it
+   * started need not remain valid after the last time the tasks are called.
+   * A DiagnosticStatusWrapper completing the future must be copied with
+   * toMessage(), as its staged values are lost when it is sliced.
+   *
+   * \param name Name to autofill in the status of the task.
+   *
+   * \param f Function starting the task and returning its future status.
+   *
+   * \param period Seconds between runs of the task, see above.
    */
-  void add(const std::string & name, TaskFunction f)
+  void addAsync(const std::string & name, AsyncTaskFunction f, double period = 0.0)
   {
-    DiagnosticTaskInternal int_task(name, f);
+    DiagnosticTaskInternal int_task(name, f, period);
     addInternal(int_task);
   }
 
@@ -266,11 +339,13 @@ public:
    * \param task The DiagnosticTask to be added. It must remain live at
    * least until the last time its diagnostic method is called. It need not be
    * valid at the time the DiagnosticTaskVector is destructed.
+   *
+   * \param period Seconds between runs of the task, see above.
    */
-  void add(DiagnosticTask & task)
+  void add(DiagnosticTask & task, double period = 0.0)
   {
     TaskFunction f = std::bind(&DiagnosticTask::run, &task, std::placeholders::_1);
-    add(task.getName(), f);
+    add(task.getName(), f, period);
   }
 
   /**
@@ -285,13 +360,15 @@ public:
    * This method need not remain valid after the last time the tasks are
    * called, and in particular it need not be valid at the time the
    * DiagnosticTaskVector is destructed.
+   *
+   * \param period Seconds between runs of the task, see above.
    */
   template<class T>
   void add(
     const std::string name, T * c,
-    void (T::* f)(diagnostic_updater::DiagnosticStatusWrapper &))
+    void (T::* f)(diagnostic_updater::DiagnosticStatusWrapper &), double period = 0.0)
   {
-    DiagnosticTaskInternal int_task(name, std::bind(f, c, std::placeholders::_1));
+    DiagnosticTaskInternal int_task(name, std::bind(f, c, std::placeholders::_1), period);
     addInternal(int_task);
   }
 
@@ -329,6 +406,7 @@ private:
    */
   virtual void addedTaskCallback(DiagnosticTaskInternal &) {}
   std::vector<DiagnosticTaskInternal> tasks_;
+  uint64_t next_task_id_ = 0;
 
 protected:
   /**
@@ -337,6 +415,7 @@ protected:
   void addInternal(DiagnosticTaskInternal & task)
   {
     std::unique_lock<std::mutex> lock(lock_);
+    task.id_ = next_task_id_++;
     tasks_.push_back(task);
     addedTaskCallback(task);
   }
@@ -352,6 +431,27 @@ protected:
  * and publish the resulting diagnostics. The publication rate is
  * determined by the "~/diagnostic_updater.period" ros2 parameter.
  * The force_update function can always be triggered async to the period interval.
+ *
+ * By default, the tasks run one after another in the update. With the
+ * "~/diagnostic_updater.threads" ros2 parameter, or setThreadCount(), they
+ * run concurrently on a pool of threads instead, and the update waits for
+ * each task until its deadline (see setDeadline()). A task that misses its
+ * deadline is reported as timed out with its last result, and isn't started
+ * again before it finished, so a slow task can't hold up the others.
+ *
+ * Tasks can be added with a period of their own. The updater then ticks at
+ * the shortest period, and each tick publishes the tasks that were due. The
+ * last results of the other tasks are published once per period of the
+ * updater, so that they don't go stale.
+ *
+ * Asynchronous tasks (see addAsync()) are started when they are due, and
+ * their status is collected by the updates once their future is ready. A
+ * task that is still not finished at the next update it is due is reported
+ * with its last result as not finished, and isn't started again before.
+ *
+ * With publish on change (see setPublishOnChange()), the updates leave out
+ * the statuses that are the same as when they were last published, and
+ * publish all of them every few periods so that they don't go stale.
  */
 class Updater : public DiagnosticTaskVector
 {
@@ -387,6 +487,8 @@ public:
     std::shared_ptr<rclcpp::node_interfaces::NodeTopicsInterface> topics_interface,
     double period = 1.0);
 
+  ~Updater();
+
   /**
    * \brief Returns the interval between updates.
    */
@@ -411,10 +513,13 @@ public:
 
   /**
    * \brief Forces to send out an update for all known DiagnosticStatus.
+   *
+   * All tasks run, whether they are due or not. With publish on change, it
+   * is a full refresh, the unchanged statuses are published too.
    */
   void force_update()
   {
-    update();
+    update(true);
   }
 
   /**
@@ -433,14 +538,80 @@ public:
 
   void setHardwareID(const std::string & hwid) {hwid_ = hwid;}
 
+  /**
+   * \brief Runs the tasks on the given number of threads, in the update if 0.
+   */
+  void setThreadCount(size_t threads);
+
+  /**
+   * \brief Sets the time in seconds the update waits for each task.
+   *
+   * Only used with threads, see setThreadCount(). The default is the
+   * "~/diagnostic_updater.deadline" ros2 parameter, 0.1 s.
+   */
+  void setDeadline(double deadline);
+
+  /**
+   * \brief Sets the deadline of the named task, overriding the default one.
+   */
+  void setDeadline(const std::string & name, double deadline);
+
+  /**
+   * \brief Publishes only the statuses whose level, message or values
+   * changed, and all of them every full_refresh periods.
+   *
+   * The full refreshes also publish a "Publish on change" status with the
+   * number of statuses left out. The default is the
+   * "~/diagnostic_updater.publish_on_change" and
+   * "~/diagnostic_updater.full_refresh" ros2 parameters, off and 4 periods.
+   * Keep full_refresh periods shorter than the timeout of the aggregator.
+   */
+  void setPublishOnChange(bool on_change, size_t full_refresh = 4);
+
+  /**
+   * \brief Returns the number of statuses left out by publish on change.
+   */
+  uint64_t getSuppressedCount();
+
 private:
+  class TaskPool;
+  struct TaskRun;
+
   void reset_timer();
 
   /**
-   * \brief Causes the diagnostics to update if the inter-update interval
-   * has been exceeded.
+   * Starts the task on the pool, unless it is still running.
+   */
+  void startTask(const DiagnosticTaskInternal & task, const std::shared_ptr<TaskRun> & run);
+
+  /**
+   * \brief Runs the due tasks, or all of them if force, and publishes their
+   * results.
+   */
+  void update(bool force);
+
+  /// What an update does with publish on change
+  enum class OnChange {Off, Suppress, Refresh};
+
+  /**
+   * Returns whether this update leaves out the unchanged statuses, or does
+   * a full refresh as one is due at this period, or as it is forced.
+   */
+  OnChange startOnChange(bool period, bool force);
+
+  /**
+   * Whether the status can be left out, as it and its staged values didn't
+   * change since it was last published. Otherwise, it is remembered as
+   * published.
+   */
+  bool isUnchanged(
+    const diagnostic_msgs::msg::DiagnosticStatus & status, bool staged_changed,
+    OnChange on_change);
+
+  /**
+   * Adds the status with the numbers of statuses left out.
    */
-  void update();
+  void addOnChangeCounts(std::vector<diagnostic_msgs::msg::DiagnosticStatus> & status_vec);
 
   /**
    * Recheck the diagnostic_period on the parameter server. (Cached)
@@ -459,6 +630,11 @@ private:
    */
   void publish(diagnostic_msgs::msg::DiagnosticStatus & stat);
 
+  /**
+   * Publishes a single diagnostic status, with its staged values.
+   */
+  void publish(DiagnosticStatusWrapper & stat);
+
   /**
    * Publishes a vector of diagnostic statuses.
    */
@@ -474,6 +650,10 @@ private:
   rclcpp::node_interfaces::NodeTimersInterface::SharedPtr timers_interface_;
   rclcpp::Clock::SharedPtr clock_;
   rclcpp::Duration period_;
+  /// Period of the timer, the shortest of period_ and the task periods.
+  std::chrono::nanoseconds tick_;
+  /// Time the last results of all tasks are published next, in nanoseconds.
+  int64_t next_refresh_;
   rclcpp::TimerBase::SharedPtr update_timer_;
   rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr publisher_;
   rclcpp::Logger logger_;
@@ -481,6 +661,28 @@ private:
   std::string hwid_;
   std::string node_name_;
   bool warn_nohwid_done_;
+
+  /// The threads running the tasks, and the schedule and last result of each
+  /// task by its id, tasks may share a name. Guarded by lock_.
+  std::unique_ptr<TaskPool> pool_;
+  std::map<uint64_t, std::shared_ptr<TaskRun>> runs_;
+  /// The runs of the tasks in the order of getTasks(), and the message
+  /// published by the updates. Reused to keep the updates from allocating.
+  /// Guarded by lock_.
+  std::vector<std::shared_ptr<TaskRun>> task_runs_;
+  diagnostic_msgs::msg::DiagnosticArray msg_;
+  std::chrono::nanoseconds deadline_;
+  std::map<std::string, std::chrono::nanoseconds> task_deadlines_;
+
+  /// Publish on change, and the last published status by name. Guarded by
+  /// published_mutex_.
+  std::mutex published_mutex_;
+  bool on_change_;
+  size_t full_refresh_;
+  size_t periods_since_refresh_;
+  std::map<std::string, diagnostic_msgs::msg::DiagnosticStatus> published_;
+  uint64_t suppressed_;
+  uint64_t suppressed_total_;
 };
 }   // namespace diagnostic_updater
 
@@ -0,0 +1,195 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DIAGNOSTIC_UPDATER__DURATION_HISTOGRAM_HPP_
+#define DIAGNOSTIC_UPDATER__DURATION_HISTOGRAM_HPP_
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace diagnostic_updater
+{
+/**
+ * \brief Histogram of durations in nanoseconds, such as the gaps between
+ * events or their latencies.
+ *
+ * The durations are counted in log-scaled buckets, sixteen per power of two,
+ * so that any duration is known within 1/16 of its value, up to about 37
+ * minutes. Recording a duration takes a constant time and doesn't lock or
+ * allocate, so it can be done from the threads the events happen in. The
+ * statistics are taken by a single reader, which resets the histogram.
+ */
+class DurationHistogram
+{
+public:
+  /// Summary of the durations recorded since the statistics were last
+  /// taken, in seconds.
+  struct Statistics
+  {
+    uint64_t count = 0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+  };
+
+  DurationHistogram()
+  {
+    for (auto & bucket : buckets_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    max_.store(0, std::memory_order_relaxed);
+  }
+
+  /**
+   * \brief Counts a duration of the given nanoseconds.
+   */
+  void record(uint64_t duration)
+  {
+    buckets_[bucketOf(duration)].fetch_add(1, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (duration > max &&
+      !max_.compare_exchange_weak(max, duration, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  /**
+   * \brief Returns the statistics of the durations recorded since the last
+   * call, and resets the histogram.
+   */
+  Statistics takeStatistics()
+  {
+    std::array<uint32_t, kBuckets> counts;
+    Statistics statistics;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      counts[i] = buckets_[i].exchange(0, std::memory_order_relaxed);
+      statistics.count += counts[i];
+    }
+    uint64_t max = max_.exchange(0, std::memory_order_relaxed);
+    if (statistics.count == 0) {
+      return statistics;
+    }
+
+    uint64_t p50_rank = (statistics.count + 1) / 2;
+    uint64_t p90_rank = statistics.count - statistics.count / 10;
+    uint64_t p99_rank = statistics.count - statistics.count / 100;
+    uint64_t seen = 0;
+    double sum = 0.0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      if (counts[i] == 0) {
+        continue;
+      }
+      double value = valueOf(i, max);
+      if (seen < p50_rank && seen + counts[i] >= p50_rank) {
+        statistics.p50 = value;
+      }
+      if (seen < p90_rank && seen + counts[i] >= p90_rank) {
+        statistics.p90 = value;
+      }
+      if (seen < p99_rank && seen + counts[i] >= p99_rank) {
+        statistics.p99 = value;
+      }
+      seen += counts[i];
+      sum += value * counts[i];
+    }
+    statistics.mean = sum / statistics.count;
+    double squares = 0.0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      double deviation = valueOf(i, max) - statistics.mean;
+      squares += deviation * deviation * counts[i];
+    }
+    statistics.stddev = std::sqrt(squares / statistics.count);
+    statistics.max = max * 1e-9;
+    return statistics;
+  }
+
+  /// Durations below this many nanoseconds have a bucket each
+  static constexpr uint64_t kSubBuckets = 16;
+  static constexpr int kSubBucketBits = 4;
+  /// Durations of 2^kMaxExponent nanoseconds and more share the last bucket
+  static constexpr int kMaxExponent = 41;
+  static constexpr size_t kBuckets = kSubBuckets + (kMaxExponent - kSubBucketBits) * kSubBuckets;
+
+  /**
+   * \brief Returns the bucket counting a duration.
+   */
+  static size_t bucketOf(uint64_t duration)
+  {
+    if (duration < kSubBuckets) {
+      return static_cast<size_t>(duration);
+    }
+    int exponent = 0;
+    uint64_t rest = duration;
+    for (int shift : {32, 16, 8, 4, 2, 1}) {
+      if (rest >> shift) {
+        rest >>= shift;
+        exponent += shift;
+      }
+    }
+    if (exponent >= kMaxExponent) {
+      return kBuckets - 1;
+    }
+    return static_cast<size_t>(
+      kSubBuckets + (exponent - kSubBucketBits) * kSubBuckets +
+      ((duration >> (exponent - kSubBucketBits)) & (kSubBuckets - 1)));
+  }
+
+private:
+  /// The middle of the durations counted in a bucket in seconds, at most max
+  /// nanoseconds.
+  static double valueOf(size_t bucket, uint64_t max)
+  {
+    double value;
+    if (bucket < kSubBuckets) {
+      value = static_cast<double>(bucket);
+    } else {
+      size_t exponent = (bucket - kSubBuckets) / kSubBuckets;
+      uint64_t lowest = (kSubBuckets + (bucket - kSubBuckets) % kSubBuckets) << exponent;
+      value = lowest + ((uint64_t(1) << exponent) - 1) / 2.0;
+    }
+    return (value < max ? value : max) * 1e-9;
+  }
+
+  std::array<std::atomic<uint32_t>, kBuckets> buckets_;
+  std::atomic<uint64_t> max_;
+};
+}  // namespace diagnostic_updater
+
+#endif  // DIAGNOSTIC_UPDATER__DURATION_HISTOGRAM_HPP_
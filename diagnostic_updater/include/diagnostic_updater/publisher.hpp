@@ -157,6 +157,7 @@ public:
     const rclcpp::Clock::SharedPtr & clock = std::make_shared<rclcpp::Clock>())
   : HeaderlessTopicDiagnostic(name, diag, freq, clock),
     stamp_(stamp, clock),
+    clock_(clock),
     error_logger_(rclcpp::get_logger("TopicDiagnostic_error_logger"))
   {
     addTask(&stamp_);
@@ -189,8 +190,33 @@ public:
     HeaderlessTopicDiagnostic::tick();
   }
 
+  /**
+   * \brief Collects statistics for a message sent at a known time.
+   *
+   * \param stamp Timestamp to use for interval computation by the
+   * TimeStampStatus class.
+   *
+   * \param now The current time of the clock of the TopicDiagnostic, so
+   * that it isn't read again.
+   */
+  virtual void tick(const rclcpp::Time & stamp, const rclcpp::Time & now)
+  {
+    stamp_.tick(stamp, now);
+    HeaderlessTopicDiagnostic::tick();
+  }
+
+protected:
+  /**
+   * \brief Returns the clock of the TopicDiagnostic.
+   */
+  const rclcpp::Clock::SharedPtr & getClock() const
+  {
+    return clock_;
+  }
+
 private:
   TimeStampStatus stamp_;
+  const rclcpp::Clock::SharedPtr clock_;
   rclcpp::Logger error_logger_;
 };
 
@@ -244,7 +270,19 @@ public:
    */
   virtual void publish(typename PublisherT::MessageUniquePtr message)
   {
-    tick(message->header.stamp);
+    publish(std::move(message), getClock()->now());
+  }
+
+  /**
+   * \brief Collects statistics and publishes a message sent at a known
+   * time.
+   *
+   * \param now The current time of the clock of the DiagnosedPublisher,
+   * for callers that already read it, for instance to fill the header.
+   */
+  virtual void publish(typename PublisherT::MessageUniquePtr message, const rclcpp::Time & now)
+  {
+    tick(message->header.stamp, now);
     publisher_->publish(std::move(message));
   }
 
@@ -256,7 +294,19 @@ public:
    */
   virtual void publish(const MessageT & message)
   {
-    tick(message.header.stamp);
+    publish(message, getClock()->now());
+  }
+
+  /**
+   * \brief Collects statistics and publishes a message sent at a known
+   * time.
+   *
+   * \param now The current time of the clock of the DiagnosedPublisher,
+   * for callers that already read it, for instance to fill the header.
+   */
+  virtual void publish(const MessageT & message, const rclcpp::Time & now)
+  {
+    tick(message.header.stamp, now);
     publisher_->publish(message);
   }
 
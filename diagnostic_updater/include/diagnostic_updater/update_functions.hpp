@@ -38,11 +38,16 @@
 #define DIAGNOSTIC_UPDATER__UPDATE_FUNCTIONS_HPP_
 
 #include <math.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "diagnostic_updater/diagnostic_updater.hpp"
+#include "diagnostic_updater/duration_histogram.hpp"
 
 namespace diagnostic_updater
 {
@@ -60,7 +65,8 @@ struct FrequencyStatusParam
     double * min_freq, double * max_freq,
     double tolerance = 0.1, int window_size = 5)
   : min_freq_(min_freq), max_freq_(max_freq), tolerance_(tolerance),
-    window_size_(window_size) {}
+    window_size_(window_size), gap_statistics_(false), max_gap_warn_(0.0),
+    max_gap_error_(0.0) {}
 
   /**
    * \brief Minimum acceptable frequency.
@@ -94,6 +100,23 @@ struct FrequencyStatusParam
    * \brief Number of events to consider in the statistics.
    */
   int window_size_;
+
+  /**
+   * \brief Whether to report the gaps between events.
+   *
+   * The p50, p99, maximum and standard deviation of the gaps since the
+   * previous update are reported, measured on the steady clock.
+   */
+  bool gap_statistics_;
+
+  /**
+   * \brief Longest acceptable gap in seconds, 0 for none.
+   *
+   * A longer gap since the previous update is reported as a warning, or as
+   * an error if it is longer than max_gap_error_.
+   */
+  double max_gap_warn_;
+  double max_gap_error_;
 };
 
 /**
@@ -105,6 +128,12 @@ struct FrequencyStatusParam
  * outside acceptable bounds, and report an error if there have been no events
  * in the latest
  * window.
+ *
+ * tick() only increments an atomic counter, so that it can be called from
+ * the publishing threads of high-rate topics without contending with run(),
+ * which keeps the window history. With gap statistics, it also records the
+ * gap since the previous tick in a DurationHistogram, which is constant-time
+ * as well.
  */
 
 class FrequencyStatus : public DiagnosticTask
@@ -112,13 +141,16 @@ class FrequencyStatus : public DiagnosticTask
 private:
   const FrequencyStatusParam params_;
 
-  int count_;
+  std::atomic<uint64_t> count_;
   std::vector<rclcpp::Time> times_;
-  std::vector<int> seq_nums_;
+  std::vector<uint64_t> seq_nums_;
   int hist_indx_;
   std::mutex lock_;
-  rclcpp::Logger debug_logger_;
   const rclcpp::Clock::SharedPtr clock_ptr_;
+  /// Steady clock time of the last tick in nanoseconds, and the gaps
+  /// between the ticks. Only with gap statistics.
+  std::atomic<int64_t> last_tick_;
+  std::unique_ptr<DurationHistogram> gaps_;
 
 public:
   /**
@@ -131,9 +163,12 @@ public:
     const rclcpp::Clock::SharedPtr & clock = std::make_shared<rclcpp::Clock>())
   : DiagnosticTask(name), params_(params), times_(params_.window_size_),
     seq_nums_(params_.window_size_),
-    debug_logger_(rclcpp::get_logger("FrequencyStatus_debug_logger")),
-    clock_ptr_(clock)
+    clock_ptr_(clock),
+    last_tick_(0)
   {
+    if (params_.gap_statistics_) {
+      gaps_ = std::make_unique<DurationHistogram>();
+    }
     clear();
   }
 
@@ -156,14 +191,19 @@ public:
   {
     std::unique_lock<std::mutex> lock(lock_);
     rclcpp::Time curtime = clock_ptr_->now();
-    count_ = 0;
+    count_.store(0, std::memory_order_relaxed);
 
     for (int i = 0; i < params_.window_size_; i++) {
       times_[i] = curtime;
-      seq_nums_[i] = count_;
+      seq_nums_[i] = 0;
     }
 
     hist_indx_ = 0;
+
+    if (gaps_) {
+      last_tick_.store(0, std::memory_order_relaxed);
+      gaps_->takeStatistics();
+    }
   }
 
   /**
@@ -171,9 +211,15 @@ public:
    */
   void tick()
   {
-    std::unique_lock<std::mutex> lock(lock_);
-    RCLCPP_DEBUG(debug_logger_, "TICK %i", count_);
-    count_++;
+    count_.fetch_add(1, std::memory_order_relaxed);
+    if (gaps_) {
+      int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+      int64_t last = last_tick_.exchange(now, std::memory_order_relaxed);
+      if (last != 0 && now > last) {
+        gaps_->record(static_cast<uint64_t>(now - last));
+      }
+    }
   }
 
   virtual void run(diagnostic_updater::DiagnosticStatusWrapper & stat)
@@ -181,8 +227,8 @@ public:
     std::unique_lock<std::mutex> lock(lock_);
     rclcpp::Time curtime = clock_ptr_->now();
 
-    int curseq = count_;
-    int events = curseq - seq_nums_[hist_indx_];
+    uint64_t curseq = count_.load(std::memory_order_relaxed);
+    uint64_t events = curseq - seq_nums_[hist_indx_];
     double window = curtime.seconds() - times_[hist_indx_].seconds();
     double freq = events / window;
     seq_nums_[hist_indx_] = curseq;
@@ -199,8 +245,8 @@ public:
       stat.summary(0, "Desired frequency met");
     }
 
-    stat.addf("Events in window", "%d", events);
-    stat.addf("Events since startup", "%d", count_);
+    stat.add("Events in window", events);
+    stat.add("Events since startup", curseq);
     stat.addf("Duration of window (s)", "%f", window);
     stat.addf("Actual frequency (Hz)", "%f", freq);
     if (*params_.min_freq_ == *params_.max_freq_) {
@@ -216,6 +262,21 @@ public:
         "Maximum acceptable frequency (Hz)", "%f",
         *params_.max_freq_ * (1 + params_.tolerance_));
     }
+
+    if (gaps_) {
+      DurationHistogram::Statistics gaps = gaps_->takeStatistics();
+      if (gaps.count > 0) {
+        if (params_.max_gap_error_ > 0 && gaps.max > params_.max_gap_error_) {
+          stat.mergeSummary(2, "Gap too long.");
+        } else if (params_.max_gap_warn_ > 0 && gaps.max > params_.max_gap_warn_) {
+          stat.mergeSummary(1, "Gap too long.");
+        }
+        stat.addf("Gap p50 (s)", "%f", gaps.p50);
+        stat.addf("Gap p99 (s)", "%f", gaps.p99);
+        stat.addf("Gap max (s)", "%f", gaps.max);
+        stat.addf("Gap standard deviation (s)", "%f", gaps.stddev);
+      }
+    }
   }
 };
 
@@ -233,7 +294,9 @@ struct TimeStampStatusParam
   TimeStampStatusParam(
     const double min_acceptable = -1,
     const double max_acceptable = 5)
-  : max_acceptable_(max_acceptable), min_acceptable_(min_acceptable) {}
+  : max_acceptable_(max_acceptable), min_acceptable_(min_acceptable),
+    latency_statistics_(false), max_latency_p50_(0.0), max_latency_p90_(0.0),
+    max_latency_p99_(0.0) {}
 
   /**
    * \brief Maximum acceptable difference between two timestamps.
@@ -246,6 +309,24 @@ struct TimeStampStatusParam
    */
 
   double min_acceptable_;
+
+  /**
+   * \brief Whether to report the distribution of the timestamp delays.
+   *
+   * The p50, p90, p99 and maximum of the delays since the previous update
+   * are reported. Timestamps in the future count as no delay.
+   */
+  bool latency_statistics_;
+
+  /**
+   * \brief Highest acceptable delay percentiles in seconds, 0 for none.
+   *
+   * A percentile above its bound since the previous update is reported as a
+   * warning.
+   */
+  double max_latency_p50_;
+  double max_latency_p90_;
+  double max_latency_p99_;
 };
 
 /**
@@ -265,6 +346,10 @@ static TimeStampStatusParam DefaultTimeStampStatusParam =
  * will only be reported during a single diagnostic report unless it
  * persists. Tallies of errors are also maintained to keep track of errors
  * in a more persistent way.
+ *
+ * tick() keeps the extreme delays in atomics, and with latency statistics
+ * records the delay in a DurationHistogram, so that it doesn't lock. Callers
+ * that already know the current time can pass it to save reading the clock.
  */
 
 class TimeStampStatus : public DiagnosticTask
@@ -275,12 +360,17 @@ private:
     early_count_ = 0;
     late_count_ = 0;
     zero_count_ = 0;
-    zero_seen_ = false;
-    max_delta_ = 0;
-    min_delta_ = 0;
-    deltas_valid_ = false;
+    zero_seen_.store(false, std::memory_order_relaxed);
+    max_delta_.store(kNoDelta, std::memory_order_relaxed);
+    min_delta_.store(kNoDelta, std::memory_order_relaxed);
+    if (params_.latency_statistics_) {
+      latencies_ = std::make_unique<DurationHistogram>();
+    }
   }
 
+  /// Delay in nanoseconds standing for no delay seen since the last update
+  static constexpr int64_t kNoDelta = INT64_MIN;
+
 public:
   /**
    * \brief Constructs the TimeStampStatus with the given parameters.
@@ -326,22 +416,27 @@ public:
 
   void tick(double stamp)
   {
-    std::unique_lock<std::mutex> lock(lock_);
-
     if (stamp == 0) {
-      zero_seen_ = true;
+      zero_seen_.store(true, std::memory_order_relaxed);
     } else {
-      const double delta = clock_ptr_->now().seconds() - stamp;
-
-      if (!deltas_valid_ || delta > max_delta_) {
-        max_delta_ = delta;
-      }
+      tick(stamp, clock_ptr_->now().seconds());
+    }
+  }
 
-      if (!deltas_valid_ || delta < min_delta_) {
-        min_delta_ = delta;
-      }
+  /**
+   * \brief Signals an event received at a known time, in seconds.
+   *
+   * \param stamp The timestamp of the event that will be used in computing
+   * intervals.
+   * \param now The current time of the clock of the TimeStampStatus.
+   */
 
-      deltas_valid_ = true;
+  void tick(double stamp, double now)
+  {
+    if (stamp == 0) {
+      zero_seen_.store(true, std::memory_order_relaxed);
+    } else {
+      record(std::llround((now - stamp) * 1e9));
     }
   }
 
@@ -353,32 +448,55 @@ public:
    */
   void tick(const rclcpp::Time t) {tick(t.seconds());}
 
+  /**
+   * \brief Signals an event received at a known time.
+   *
+   * \param stamp The timestamp of the event that will be used in computing
+   * intervals.
+   * \param now The current time of the clock of the TimeStampStatus.
+   */
+  void tick(const rclcpp::Time & stamp, const rclcpp::Time & now)
+  {
+    if (stamp.nanoseconds() == 0) {
+      zero_seen_.store(true, std::memory_order_relaxed);
+    } else {
+      record(now.nanoseconds() - stamp.nanoseconds());
+    }
+  }
+
   virtual void run(diagnostic_updater::DiagnosticStatusWrapper & stat)
   {
     std::unique_lock<std::mutex> lock(lock_);
 
+    const int64_t min_delta = min_delta_.exchange(kNoDelta, std::memory_order_relaxed);
+    const int64_t max_delta = max_delta_.exchange(kNoDelta, std::memory_order_relaxed);
+    const bool zero_seen = zero_seen_.exchange(false, std::memory_order_relaxed);
+    const bool deltas_valid = min_delta != kNoDelta && max_delta != kNoDelta;
+    const double min_seconds = deltas_valid ? min_delta * 1e-9 : 0.0;
+    const double max_seconds = deltas_valid ? max_delta * 1e-9 : 0.0;
+
     stat.summary(0, "Timestamps are reasonable.");
-    if (!deltas_valid_) {
+    if (!deltas_valid) {
       stat.summary(1, "No data since last update.");
     } else {
-      if (min_delta_ < params_.min_acceptable_) {
+      if (min_seconds < params_.min_acceptable_) {
         stat.summary(2, "Timestamps too far in future seen.");
         early_count_++;
       }
 
-      if (max_delta_ > params_.max_acceptable_) {
+      if (max_seconds > params_.max_acceptable_) {
         stat.summary(2, "Timestamps too far in past seen.");
         late_count_++;
       }
 
-      if (zero_seen_) {
+      if (zero_seen) {
         stat.summary(2, "Zero timestamp seen.");
         zero_count_++;
       }
     }
 
-    stat.addf("Earliest timestamp delay:", "%f", min_delta_);
-    stat.addf("Latest timestamp delay:", "%f", max_delta_);
+    stat.addf("Earliest timestamp delay:", "%f", min_seconds);
+    stat.addf("Latest timestamp delay:", "%f", max_seconds);
     stat.addf(
       "Earliest acceptable timestamp delay:", "%f",
       params_.min_acceptable_);
@@ -389,21 +507,56 @@ public:
     stat.add("Early diagnostic update count:", early_count_);
     stat.add("Zero seen diagnostic update count:", zero_count_);
 
-    deltas_valid_ = false;
-    min_delta_ = 0;
-    max_delta_ = 0;
-    zero_seen_ = false;
+    if (latencies_) {
+      DurationHistogram::Statistics latencies = latencies_->takeStatistics();
+      if (latencies.count > 0) {
+        if (params_.max_latency_p50_ > 0 && latencies.p50 > params_.max_latency_p50_) {
+          stat.mergeSummary(1, "Latency p50 too high.");
+        }
+        if (params_.max_latency_p90_ > 0 && latencies.p90 > params_.max_latency_p90_) {
+          stat.mergeSummary(1, "Latency p90 too high.");
+        }
+        if (params_.max_latency_p99_ > 0 && latencies.p99 > params_.max_latency_p99_) {
+          stat.mergeSummary(1, "Latency p99 too high.");
+        }
+        stat.addf("Latency p50 (s)", "%f", latencies.p50);
+        stat.addf("Latency p90 (s)", "%f", latencies.p90);
+        stat.addf("Latency p99 (s)", "%f", latencies.p99);
+        stat.addf("Latency max (s)", "%f", latencies.max);
+      }
+    }
   }
 
 private:
+  /// Counts a delay of the given nanoseconds.
+  void record(int64_t delta)
+  {
+    int64_t min = min_delta_.load(std::memory_order_relaxed);
+    while ((min == kNoDelta || delta < min) &&
+      !min_delta_.compare_exchange_weak(min, delta, std::memory_order_relaxed))
+    {
+    }
+    int64_t max = max_delta_.load(std::memory_order_relaxed);
+    while ((max == kNoDelta || delta > max) &&
+      !max_delta_.compare_exchange_weak(max, delta, std::memory_order_relaxed))
+    {
+    }
+    if (latencies_) {
+      latencies_->record(delta > 0 ? static_cast<uint64_t>(delta) : 0);
+    }
+  }
+
   TimeStampStatusParam params_;
   int early_count_;
   int late_count_;
   int zero_count_;
-  bool zero_seen_;
-  double max_delta_;
-  double min_delta_;
-  bool deltas_valid_;
+  /// Extreme delays in nanoseconds since the last update, and whether a zero
+  /// timestamp was seen. Reset by run().
+  std::atomic<bool> zero_seen_;
+  std::atomic<int64_t> max_delta_;
+  std::atomic<int64_t> min_delta_;
+  /// Delays since the last update. Only with latency statistics.
+  std::unique_ptr<DurationHistogram> latencies_;
   const rclcpp::Clock::SharedPtr clock_ptr_;
   std::mutex lock_;
 };
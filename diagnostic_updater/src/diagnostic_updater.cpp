@@ -34,10 +34,154 @@
 
 #include <diagnostic_updater/diagnostic_updater.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include "rclcpp/rclcpp.hpp"
 
 namespace diagnostic_updater
 {
+namespace
+{
+/**
+ * Sets the defaults of a task status before it runs.
+ */
+void initStatus(
+  diagnostic_msgs::msg::DiagnosticStatus & status, const std::string & name,
+  const std::string & hwid)
+{
+  status.name = name;
+  status.level = 2;
+  status.message = "No message was set";
+  status.hardware_id = hwid;
+}
+
+/**
+ * Returns the status of a finished asynchronous task.
+ */
+diagnostic_msgs::msg::DiagnosticStatus takeStatus(
+  std::future<diagnostic_msgs::msg::DiagnosticStatus> & pending, const std::string & name,
+  const std::string & hwid)
+{
+  diagnostic_msgs::msg::DiagnosticStatus status;
+  try {
+    status = pending.get();
+  } catch (const std::exception & e) {
+    initStatus(status, name, hwid);
+    status.message = std::string("Failed: ") + e.what();
+  }
+  status.name = name;
+  if (status.hardware_id.empty()) {
+    status.hardware_id = hwid;
+  }
+  return status;
+}
+}  // namespace
+
+/**
+ * Threads running the tasks of an Updater. Pending jobs are dropped when it
+ * is destroyed, running ones are waited for.
+ */
+class Updater::TaskPool
+{
+public:
+  explicit TaskPool(size_t threads)
+  : stopped_(false)
+  {
+    for (size_t i = 0; i < threads; ++i) {
+      threads_.emplace_back(&TaskPool::work, this);
+    }
+  }
+
+  ~TaskPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    posted_.notify_all();
+    for (auto & thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void post(std::function<void()> job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(std::move(job));
+    }
+    posted_.notify_one();
+  }
+
+private:
+  void work()
+  {
+    for (;; ) {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        posted_.wait(lock, [this] {return stopped_ || !jobs_.empty();});
+        if (stopped_) {
+          return;
+        }
+        job = std::move(jobs_.front());
+        jobs_.pop_front();
+      }
+      job();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable posted_;
+  std::deque<std::function<void()>> jobs_;
+  std::vector<std::thread> threads_;
+  bool stopped_;
+};
+
+/**
+ * State of a task, shared with the job running it on the pool.
+ *
+ * The status objects live as long as the task, so that their strings and
+ * values keep their capacity from one update to the next.
+ */
+struct Updater::TaskRun
+{
+  explicit TaskRun(std::string name)
+  : prefixed_name(std::move(name)) {}
+
+  std::mutex mutex;
+  std::condition_variable finished;
+  bool running = false;
+  bool has_result = false;
+  diagnostic_msgs::msg::DiagnosticStatus result;
+  /// Time the task is due next, in nanoseconds of the updater clock
+  int64_t due = 0;
+  /// Status of an asynchronous task that was started and not collected yet
+  std::future<diagnostic_msgs::msg::DiagnosticStatus> pending;
+  /// Status the task runs on, only used by the update or the job running it
+  DiagnosticStatusWrapper status;
+  /// Name of the task as published, prefixed with the node name
+  const std::string prefixed_name;
+  /// Whether the task is due, and still not finished since an earlier
+  /// update. Set by the current update, guarded by lock_.
+  bool is_due = false;
+  bool unfinished = false;
+  /// Whether the staged values of the result are left in status, to be
+  /// formatted when it is published, and whether they changed at the last
+  /// run. Only for the tasks run by the update.
+  bool staged = false;
+  bool staged_changed = false;
+};
+
 Updater::Updater(
   std::shared_ptr<rclcpp::node_interfaces::NodeBaseInterface> base_interface,
   std::shared_ptr<rclcpp::node_interfaces::NodeClockInterface> clock_interface,
@@ -50,11 +194,19 @@ Updater::Updater(
   timers_interface_(timers_interface),
   clock_(clock_interface->get_clock()),
   period_(rclcpp::Duration::from_seconds(period)),
+  tick_(period_.nanoseconds()),
+  next_refresh_(0),
   publisher_(rclcpp::create_publisher<diagnostic_msgs::msg::DiagnosticArray>(
       topics_interface, "/diagnostics", 1)),
   logger_(logging_interface->get_logger()),
   node_name_(base_interface->get_name()),
-  warn_nohwid_done_(false)
+  warn_nohwid_done_(false),
+  deadline_(std::chrono::milliseconds(100)),
+  on_change_(false),
+  full_refresh_(4),
+  periods_since_refresh_(0),
+  suppressed_(0),
+  suppressed_total_(0)
 {
   constexpr const char * period_param_name = "diagnostic_updater.period";
   rclcpp::ParameterValue period_param;
@@ -79,6 +231,94 @@ Updater::Updater(
   }
   node_name_ = use_fqn_param.get<bool>() ? base_interface->get_fully_qualified_name() :
     base_interface->get_name();
+
+  constexpr const char * deadline_param_name = "diagnostic_updater.deadline";
+  rclcpp::ParameterValue deadline_param;
+  if (parameters_interface->has_parameter(deadline_param_name)) {
+    deadline_param = parameters_interface->get_parameter(deadline_param_name).get_parameter_value();
+  } else {
+    deadline_param =
+      parameters_interface->declare_parameter(deadline_param_name, rclcpp::ParameterValue(0.1));
+  }
+  setDeadline(deadline_param.get<double>());
+
+  constexpr const char * threads_param_name = "diagnostic_updater.threads";
+  rclcpp::ParameterValue threads_param;
+  if (parameters_interface->has_parameter(threads_param_name)) {
+    threads_param = parameters_interface->get_parameter(threads_param_name).get_parameter_value();
+  } else {
+    threads_param =
+      parameters_interface->declare_parameter(threads_param_name, rclcpp::ParameterValue(0));
+  }
+  setThreadCount(static_cast<size_t>(std::max<int64_t>(threads_param.get<int64_t>(), 0)));
+
+  constexpr const char * on_change_param_name = "diagnostic_updater.publish_on_change";
+  rclcpp::ParameterValue on_change_param;
+  if (parameters_interface->has_parameter(on_change_param_name)) {
+    on_change_param =
+      parameters_interface->get_parameter(on_change_param_name).get_parameter_value();
+  } else {
+    on_change_param =
+      parameters_interface->declare_parameter(on_change_param_name, rclcpp::ParameterValue(false));
+  }
+
+  constexpr const char * full_refresh_param_name = "diagnostic_updater.full_refresh";
+  rclcpp::ParameterValue full_refresh_param;
+  if (parameters_interface->has_parameter(full_refresh_param_name)) {
+    full_refresh_param =
+      parameters_interface->get_parameter(full_refresh_param_name).get_parameter_value();
+  } else {
+    full_refresh_param =
+      parameters_interface->declare_parameter(full_refresh_param_name, rclcpp::ParameterValue(4));
+  }
+  setPublishOnChange(
+    on_change_param.get<bool>(),
+    static_cast<size_t>(std::max<int64_t>(full_refresh_param.get<int64_t>(), 1)));
+}
+
+Updater::~Updater()
+{
+  // Wait for the running tasks before their state goes away
+  pool_.reset();
+}
+
+void Updater::setThreadCount(size_t threads)
+{
+  std::unique_lock<std::mutex> lock(lock_);
+  pool_.reset();
+  // Runs whose jobs were dropped with the pool would never finish
+  runs_.clear();
+  if (threads > 0) {
+    pool_ = std::make_unique<TaskPool>(threads);
+  }
+}
+
+void Updater::setDeadline(double deadline)
+{
+  std::unique_lock<std::mutex> lock(lock_);
+  deadline_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::duration<double>(deadline));
+}
+
+void Updater::setDeadline(const std::string & name, double deadline)
+{
+  std::unique_lock<std::mutex> lock(lock_);
+  task_deadlines_[name] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::duration<double>(deadline));
+}
+
+void Updater::setPublishOnChange(bool on_change, size_t full_refresh)
+{
+  std::lock_guard<std::mutex> lock(published_mutex_);
+  on_change_ = on_change;
+  full_refresh_ = std::max<size_t>(full_refresh, 1);
+  periods_since_refresh_ = 0;
+}
+
+uint64_t Updater::getSuppressedCount()
+{
+  std::lock_guard<std::mutex> lock(published_mutex_);
+  return suppressed_total_;
 }
 
 void Updater::broadcast(unsigned char lvl, const std::string msg)
@@ -115,33 +355,142 @@ void Updater::setHardwareIDf(const char * format, ...)
 
 void Updater::reset_timer()
 {
+  // Tick at the shortest period of the tasks
+  rclcpp::Duration tick = period_;
+  for (const auto & task : getTasks()) {
+    if (task.getPeriod() > 0.0 && rclcpp::Duration::from_seconds(task.getPeriod()) < tick) {
+      tick = rclcpp::Duration::from_seconds(task.getPeriod());
+    }
+  }
+  tick_ = std::chrono::nanoseconds(tick.nanoseconds());
   update_timer_ = rclcpp::create_timer(
-    base_interface_, timers_interface_, clock_, period_, std::bind(&Updater::update, this));
+    base_interface_, timers_interface_, clock_, tick, [this]() {update(false);});
 }
 
-void Updater::update()
+void Updater::update(bool force)
 {
   if (rclcpp::ok(base_interface_->get_context())) {
     bool warn_nohwid = hwid_.empty();
 
-    std::vector<diagnostic_msgs::msg::DiagnosticStatus> status_vec;
-
     std::unique_lock<std::mutex> lock(
       lock_);  // Make sure no adds happen while we are processing here.
     const std::vector<DiagnosticTaskInternal> & tasks = getTasks();
-    for (std::vector<DiagnosticTaskInternal>::const_iterator iter = tasks.begin();
-      iter != tasks.end(); iter++)
-    {
-      diagnostic_updater::DiagnosticStatusWrapper status;
 
-      status.name = iter->getName();
-      status.level = 2;
-      status.message = "No message was set";
-      status.hardware_id = hwid_;
+    auto start = std::chrono::steady_clock::now();
+    int64_t now = clock_->now().nanoseconds();
+    // Half a tick early is still on time, the timer jitters
+    int64_t on_time = now + tick_.count() / 2;
+    bool refresh = force || on_time >= next_refresh_;
+    if (refresh) {
+      next_refresh_ = now + period_.nanoseconds();
+    }
+
+    if (runs_.size() > tasks.size()) {
+      // Forget the removed tasks
+      for (auto it = runs_.begin(); it != runs_.end(); ) {
+        bool removed = std::none_of(
+          tasks.begin(), tasks.end(), [&it](const DiagnosticTaskInternal & task) {
+            return task.getId() == it->first;
+          });
+        if (removed) {
+          it = runs_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
 
-      iter->run(status);
+    // Nothing below allocates once all tasks ran, unless their results grow,
+    // or they run on the pool
+    task_runs_.clear();
+    for (const auto & task : tasks) {
+      std::shared_ptr<TaskRun> & run = runs_[task.getId()];
+      if (!run) {
+        run = std::make_shared<TaskRun>(node_name_ + ": " + task.getName());
+      }
+      task_runs_.push_back(run);
+      run->is_due = force || on_time >= run->due;
 
-      status_vec.push_back(status);
+      if (task.isAsync() && run->pending.valid() &&
+        run->pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+      {
+        run->result = takeStatus(run->pending, task.getName(), hwid_);
+        run->has_result = true;
+      }
+      // Started by an earlier update, and still not finished
+      run->unfinished = run->is_due && run->pending.valid();
+
+      if (!run->is_due) {
+        continue;
+      }
+
+      run->due = now + (task.getPeriod() > 0.0 ?
+        rclcpp::Duration::from_seconds(task.getPeriod()) : period_).nanoseconds();
+      if (task.isAsync()) {
+        if (!run->pending.valid()) {
+          run->pending = task.start();
+        }
+      } else if (pool_) {
+        startTask(task, run);
+      } else {
+        run->status.clear();
+        initStatus(run->status, task.getName(), hwid_);
+        task.run(run->status);
+        run->result = run->status;
+        run->has_result = true;
+        run->staged = true;
+        run->staged_changed = run->status.stagedChanged();
+      }
+    }
+
+    // The due tasks, and the last results of the others once per period.
+    // They are copied over the statuses of the previous update, reusing
+    // their strings. With publish on change, the unchanged ones are left
+    // out before their staged values are formatted.
+    OnChange on_change = startOnChange(refresh && !force, force);
+    size_t count = 0;
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      TaskRun & run = *task_runs_[i];
+      std::unique_lock<std::mutex> run_lock(run.mutex);
+      bool timed_out = false;
+      if (!run.is_due) {
+        if (!refresh || !run.has_result) {
+          continue;
+        }
+      } else if (tasks[i].isAsync()) {
+        timed_out = run.unfinished;
+        if (!timed_out && !run.has_result) {
+          // Just started, its first status comes with a later update
+          continue;
+        }
+      } else if (pool_) {
+        auto deadline = task_deadlines_.find(tasks[i].getName());
+        auto until = start + (deadline != task_deadlines_.end() ? deadline->second : deadline_);
+        timed_out = !run.finished.wait_until(run_lock, until, [&run] {return !run.running;});
+      }
+
+      if (count == msg_.status.size()) {
+        msg_.status.emplace_back();
+      }
+      diagnostic_msgs::msg::DiagnosticStatus & status = msg_.status[count];
+      if (run.has_result) {
+        status = run.result;
+      } else {
+        initStatus(status, tasks[i].getName(), hwid_);
+      }
+      if (status.name == tasks[i].getName()) {
+        status.name = run.prefixed_name;
+      } else {
+        // Renamed by the task itself
+        status.name.insert(0, ": ");
+        status.name.insert(0, node_name_);
+      }
+      if (timed_out) {
+        std::string reason = tasks[i].isAsync() ? "Not finished" : "Timed out";
+        status.level = std::max<unsigned char>(
+          status.level, diagnostic_msgs::msg::DiagnosticStatus::WARN);
+        status.message = run.has_result ? reason + ", last result: " + status.message : reason;
+      }
 
       if (status.level) {
         warn_nohwid = false;
@@ -149,9 +498,23 @@ void Updater::update()
 
       if (verbose_ && status.level) {
         RCLCPP_WARN(
-          logger_, "Non-zero diagnostic status. Name: '%s', status %i: '%s'", status.name.c_str(),
-          status.level, status.message.c_str());
+          logger_, "Non-zero diagnostic status. Name: '%s', status %i: '%s'",
+          tasks[i].getName().c_str(), status.level, status.message.c_str());
+      }
+
+      if (on_change != OnChange::Off &&
+        isUnchanged(status, run.is_due && run.staged && run.staged_changed, on_change))
+      {
+        continue;
+      }
+      if (run.staged) {
+        run.status.formatStaged(status.values);
       }
+      ++count;
+    }
+    msg_.status.resize(count);
+    if (on_change == OnChange::Refresh) {
+      addOnChangeCounts(msg_.status);
     }
 
     if (warn_nohwid && !warn_nohwid_done_) {
@@ -164,8 +527,74 @@ void Updater::update()
       warn_nohwid_done_ = true;
     }
 
-    publish(status_vec);
+    if (!msg_.status.empty()) {
+      msg_.header.stamp = clock_->now();
+      publisher_->publish(msg_);
+    }
+  }
+}
+
+Updater::OnChange Updater::startOnChange(bool period, bool force)
+{
+  std::lock_guard<std::mutex> lock(published_mutex_);
+  if (!on_change_) {
+    return OnChange::Off;
+  }
+  if (force || (period && ++periods_since_refresh_ >= full_refresh_)) {
+    periods_since_refresh_ = 0;
+    return OnChange::Refresh;
+  }
+  return OnChange::Suppress;
+}
+
+bool Updater::isUnchanged(
+  const diagnostic_msgs::msg::DiagnosticStatus & status, bool staged_changed, OnChange on_change)
+{
+  std::lock_guard<std::mutex> lock(published_mutex_);
+  diagnostic_msgs::msg::DiagnosticStatus & last = published_[status.name];
+  if (on_change == OnChange::Suppress && !staged_changed && last == status) {
+    ++suppressed_;
+    ++suppressed_total_;
+    return true;
+  }
+  last = status;
+  return false;
+}
+
+void Updater::addOnChangeCounts(std::vector<diagnostic_msgs::msg::DiagnosticStatus> & status_vec)
+{
+  std::lock_guard<std::mutex> lock(published_mutex_);
+  diagnostic_updater::DiagnosticStatusWrapper counts;
+  counts.name = node_name_ + ": Publish on change";
+  counts.hardware_id = hwid_;
+  counts.summary(diagnostic_msgs::msg::DiagnosticStatus::OK, "Unchanged statuses suppressed");
+  counts.add("Suppressed", suppressed_);
+  counts.add("Suppressed (total)", suppressed_total_);
+  status_vec.push_back(counts);
+  suppressed_ = 0;
+}
+
+void Updater::startTask(const DiagnosticTaskInternal & task, const std::shared_ptr<TaskRun> & run)
+{
+  std::lock_guard<std::mutex> run_lock(run->mutex);
+  if (run->running) {
+    // Still busy since an earlier update
+    return;
   }
+  run->running = true;
+  pool_->post(
+    [run, task, hwid = hwid_]() {
+      run->status.clear();
+      initStatus(run->status, task.getName(), hwid);
+      task.run(run->status);
+      // The next run may stage over them before the result is published
+      run->status.formatStaged(run->status.values);
+      std::lock_guard<std::mutex> run_lock(run->mutex);
+      run->result = run->status;
+      run->has_result = true;
+      run->running = false;
+      run->finished.notify_all();
+    });
 }
 
 void Updater::publish(diagnostic_msgs::msg::DiagnosticStatus & stat)
@@ -175,6 +604,13 @@ void Updater::publish(diagnostic_msgs::msg::DiagnosticStatus & stat)
   publish(status_vec);
 }
 
+void Updater::publish(DiagnosticStatusWrapper & stat)
+{
+  std::vector<diagnostic_msgs::msg::DiagnosticStatus> status_vec;
+  status_vec.push_back(stat.toMessage());
+  publish(status_vec);
+}
+
 void Updater::publish(std::vector<diagnostic_msgs::msg::DiagnosticStatus> & status_vec)
 {
   for (std::vector<diagnostic_msgs::msg::DiagnosticStatus>::iterator iter = status_vec.begin();
@@ -182,6 +618,14 @@ void Updater::publish(std::vector<diagnostic_msgs::msg::DiagnosticStatus> & stat
   {
     iter->name = node_name_ + std::string(": ") + iter->name;
   }
+  {
+    std::lock_guard<std::mutex> lock(published_mutex_);
+    if (on_change_) {
+      for (const auto & status : status_vec) {
+        published_[status.name] = status;
+      }
+    }
+  }
   diagnostic_msgs::msg::DiagnosticArray msg;
   msg.status = status_vec;
   msg.header.stamp = clock_->now();
@@ -194,5 +638,12 @@ void Updater::addedTaskCallback(DiagnosticTaskInternal & task)
   stat.name = task.getName();
   stat.summary(0, "Node starting up");
   publish(stat);
+
+  if (task.getPeriod() > 0.0 &&
+    std::chrono::nanoseconds(rclcpp::Duration::from_seconds(task.getPeriod()).nanoseconds()) <
+    tick_)
+  {
+    reset_timer();
+  }
 }
 }  // namespace diagnostic_updater
@@ -36,6 +36,9 @@
 #include <diagnostic_updater/publisher.hpp>
 #include <std_msgs/msg/bool.hpp>
 
+#include <future>
+#include <thread>
+
 #include "rclcpp/rclcpp.hpp"
 
 using namespace std::chrono_literals;
@@ -128,6 +131,24 @@ void check_upper_bound(diagnostic_updater::DiagnosticStatusWrapper & stat)
   stat.add("Top-Side Margin", 10 - time_to_launch);
 }
 
+std::future<diagnostic_msgs::msg::DiagnosticStatus> read_device()
+{
+  // An asynchronous task returns a future instead of filling in the status
+  // itself. The Updater collects the result when it is ready and reports
+  // the task as not finished while it is not, so a slow device never holds
+  // up the other tasks. A real driver would usually complete a
+  // std::promise from its I/O callback; here the read is simulated.
+  return std::async(
+    std::launch::async, []() {
+      std::this_thread::sleep_for(1500ms);
+      diagnostic_updater::DiagnosticStatusWrapper stat;
+      stat.summary(diagnostic_msgs::msg::DiagnosticStatus::OK, "Device read OK");
+      stat.stage("Device temperature", 42.0);
+      // Casting the wrapper to a DiagnosticStatus would drop the staged value
+      return stat.toMessage();
+    });
+}
+
 int main(int argc, char ** argv)
 {
   rclcpp::init(argc, argv);
@@ -190,6 +211,10 @@ int main(int argc, char ** argv)
   // merging is done). The lists of key-value pairs will be concatenated.
   updater.add(bounds);
 
+  // Asynchronous tasks are added with addAsync. Their status carries the
+  // name of the task, whatever name the future fills in.
+  updater.addAsync("Device read", read_device);
+
   // You can broadcast a message in all the DiagnosticStatus if your node
   // is in a special state.
   updater.broadcast(0, "Doing important initialization stuff.");
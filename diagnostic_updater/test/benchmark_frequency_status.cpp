@@ -0,0 +1,109 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/*
+ * Measures the cost of FrequencyStatus::tick() from one or several
+ * publishing threads, against a tick taking a mutex as it used to.
+ * Not run as a test, run it manually: benchmark_frequency_status [TICKS]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "diagnostic_updater/update_functions.hpp"
+
+namespace
+{
+/// The former tick(), counting under a mutex shared with run()
+class LockedCounter
+{
+public:
+  void tick()
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    count_++;
+  }
+
+private:
+  std::mutex lock_;
+  int count_ = 0;
+};
+
+template<class F>
+double nanosecondsPerTick(int threads, int ticks, F && tick)
+{
+  std::vector<std::thread> workers;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < threads; ++i) {
+    workers.emplace_back(
+      [&tick, ticks]() {
+        for (int j = 0; j < ticks; ++j) {
+          tick();
+        }
+      });
+  }
+  for (auto & worker : workers) {
+    worker.join();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  // Per tick of a thread, the threads tick concurrently
+  return std::chrono::duration<double, std::nano>(elapsed).count() / ticks;
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  int ticks = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  double min_freq = 1000.0;
+  double max_freq = 1000.0;
+
+  for (int threads : {1, 2, 4}) {
+    diagnostic_updater::FrequencyStatus status(
+      diagnostic_updater::FrequencyStatusParam(&min_freq, &max_freq));
+    LockedCounter locked;
+    double atomic_tick = nanosecondsPerTick(threads, ticks, [&status]() {status.tick();});
+    double locked_tick = nanosecondsPerTick(threads, ticks, [&locked]() {locked.tick();});
+
+    diagnostic_updater::DiagnosticStatusWrapper stat;
+    status.run(stat);
+    std::printf("%d threads, %s events\n", threads, stat.values[1].value.c_str());
+    std::printf("  mutex:   %8.2f ns/tick\n", locked_tick);
+    std::printf("  atomic:  %8.2f ns/tick\n", atomic_tick);
+  }
+  return 0;
+}
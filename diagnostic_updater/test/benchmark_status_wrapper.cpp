@@ -0,0 +1,139 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/*
+ * Compares adding numeric key-values to a DiagnosticStatusWrapper with the
+ * former implementations, formatting through a std::stringstream and
+ * through vsnprintf into a stack buffer copied into a new string.
+ * Not run as a test, run it manually: benchmark_status_wrapper [ITERATIONS]
+ */
+
+#include <stdarg.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+#include "diagnostic_updater/diagnostic_status_wrapper.hpp"
+
+#include "diagnostic_msgs/msg/key_value.hpp"
+
+using diagnostic_updater::DiagnosticStatusWrapper;
+
+namespace
+{
+/// Key-values added per iteration, like a node with a few devices
+constexpr int kValues = 100;
+
+template<class T>
+void streamedAdd(DiagnosticStatusWrapper & stat, const std::string & key, const T & val)
+{
+  std::stringstream ss;
+  ss << val;
+  diagnostic_msgs::msg::KeyValue kv;
+  kv.key = key;
+  kv.value = ss.str();
+  stat.values.push_back(kv);
+}
+
+void bufferedAddf(DiagnosticStatusWrapper & stat, const std::string & key, const char * format, ...)
+{
+  va_list va;
+  char buff[1000];
+  va_start(va, format);
+  vsnprintf(buff, sizeof(buff), format, va);
+  va_end(va);
+  diagnostic_msgs::msg::KeyValue kv;
+  kv.key = key;
+  kv.value = std::string(buff);
+  stat.values.push_back(kv);
+}
+
+template<class F>
+double nanosecondsPerValue(int iterations, F && f)
+{
+  DiagnosticStatusWrapper stat;
+  size_t size = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    stat.clear();
+    for (int j = 0; j < kValues; ++j) {
+      f(stat, i * kValues + j);
+    }
+    size += stat.values.back().value.size();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  if (size == 0) {
+    std::printf("Nothing was formatted\n");
+  }
+  return std::chrono::duration<double, std::nano>(elapsed).count() / iterations / kValues;
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 10000;
+  const std::string key = "Value";
+
+  std::printf("int\n");
+  std::printf(
+    "  stringstream: %8.2f ns/value\n", nanosecondsPerValue(
+      iterations, [&](DiagnosticStatusWrapper & stat, int i) {streamedAdd(stat, key, i);}));
+  std::printf(
+    "  add:          %8.2f ns/value\n", nanosecondsPerValue(
+      iterations, [&](DiagnosticStatusWrapper & stat, int i) {stat.add(key, i);}));
+
+  std::printf("double\n");
+  std::printf(
+    "  stringstream: %8.2f ns/value\n", nanosecondsPerValue(
+      iterations, [&](DiagnosticStatusWrapper & stat, int i) {streamedAdd(stat, key, i * 0.37);}));
+  std::printf(
+    "  add:          %8.2f ns/value\n", nanosecondsPerValue(
+      iterations, [&](DiagnosticStatusWrapper & stat, int i) {stat.add(key, i * 0.37);}));
+
+  std::printf("addf(\"%%.2f V\")\n");
+  std::printf(
+    "  buffer:       %8.2f ns/value\n", nanosecondsPerValue(
+      iterations, [&](DiagnosticStatusWrapper & stat, int i) {
+        bufferedAddf(stat, key, "%.2f V", i * 0.37);
+      }));
+  std::printf(
+    "  addf:         %8.2f ns/value\n", nanosecondsPerValue(
+      iterations, [&](DiagnosticStatusWrapper & stat, int i) {
+        stat.addf(key, "%.2f V", i * 0.37);
+      }));
+  return 0;
+}
@@ -0,0 +1,118 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, ROS diagnostics contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/*
+ * Counts the allocations of the updates of an Updater once all its tasks
+ * ran, which should only be the ones of the middleware publishing the
+ * message. The tasks only fill in short strings, so that they don't
+ * allocate themselves.
+ * Not run as a test, run it manually: benchmark_updater [ITERATIONS]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "diagnostic_updater/diagnostic_updater.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace
+{
+std::atomic<size_t> allocations(0);
+}  // namespace
+
+void * operator new(std::size_t size)
+{
+  ++allocations;
+  if (void * p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void * p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void * p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+int main(int argc, char ** argv)
+{
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 10000;
+  rclcpp::init(1, argv);
+
+  for (int count : {10, 100}) {
+    auto node = std::make_shared<rclcpp::Node>(
+      "benchmark_updater_" + std::to_string(count),
+      rclcpp::NodeOptions().parameter_overrides({{"diagnostic_updater.period", 1000.0}}));
+    diagnostic_updater::Updater updater(node);
+    updater.setHardwareID("none");
+    for (int i = 0; i < count; ++i) {
+      updater.add(
+        "Task " + std::to_string(i), [](diagnostic_updater::DiagnosticStatusWrapper & stat) {
+          stat.summary(diagnostic_msgs::msg::DiagnosticStatus::OK, "OK");
+          stat.add("Load", std::string("0.5"));
+        });
+    }
+    // The first update sizes the statuses
+    updater.force_update();
+
+    size_t before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      updater.force_update();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    size_t allocated = allocations - before;
+
+    std::printf("%d tasks\n", count);
+    std::printf(
+      "  allocations: %8.2f per update\n", static_cast<double>(allocated) / iterations);
+    std::printf(
+      "  time:        %8.2f us/update\n",
+      std::chrono::duration<double, std::micro>(elapsed).count() / iterations);
+  }
+
+  rclcpp::shutdown();
+  return 0;
+}
@@ -34,6 +34,14 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
 #include "diagnostic_updater/diagnostic_status_wrapper.hpp"
 #include "diagnostic_msgs/msg/diagnostic_status.hpp"
 
@@ -185,3 +193,155 @@ TEST(DiagnosticStatusWrapper, testDiagnosticStatusAddBool) {
   EXPECT_EQ(dsw.message, "");
   EXPECT_EQ(dsw.values.size(), 0u);
 }
+
+TEST(DiagnosticStatusWrapper, testDiagnosticStatusAddNumbers) {
+  // Numbers should be formatted as a std::stringstream would.
+  enum class Mode : uint8_t {Idle = 0, Running = 3};
+  diagnostic_updater::DiagnosticStatusWrapper dsw;
+  dsw.add("int", -42);
+  dsw.add("uint64", std::numeric_limits<uint64_t>::max());
+  dsw.add("double", 3.14159265);
+  dsw.add("small", 1.5e-7);
+  dsw.add("float", 0.1f);
+  dsw.add("enum", Mode::Running);
+  dsw.add("duration", std::chrono::milliseconds(1500));
+  dsw.add("char", 'x');
+  dsw.add("c string", "text");
+  ASSERT_EQ(dsw.values.size(), 9u);
+
+  const std::vector<std::string> expected = {
+    "-42", "18446744073709551615", "3.14159", "1.5e-07", "0.1", "3", "1.5", "x", "text"};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(dsw.values[i].value, expected[i]) << dsw.values[i].key;
+  }
+  for (double value : {0.0, -2.5, 123456789.0, 1e300, 0.000123456}) {
+    std::stringstream ss;
+    ss << value;
+    dsw.add("streamed", value);
+    EXPECT_EQ(dsw.values.back().value, ss.str());
+  }
+}
+
+enum Name {nameA = 3, nameB};
+enum class ScopedName {nameC = 5};
+
+std::ostream & operator<<(std::ostream & os, Name name)
+{
+  return os << (name == nameA ? "nameA" : "nameB");
+}
+
+std::ostream & operator<<(std::ostream & os, const ScopedName &)
+{
+  return os << "nameC";
+}
+
+TEST(DiagnosticStatusWrapper, testDiagnosticStatusAddStreamedEnums) {
+  // Enums with a << operator should be formatted by it, not as their value.
+  enum Plain {plain = 7};
+  diagnostic_updater::DiagnosticStatusWrapper dsw;
+  dsw.add("unscoped", nameA);
+  dsw.add("scoped", ScopedName::nameC);
+  dsw.add("plain", plain);
+  ASSERT_EQ(dsw.values.size(), 3u);
+  EXPECT_EQ(dsw.values[0].value, "nameA");
+  EXPECT_EQ(dsw.values[1].value, "nameC");
+  EXPECT_EQ(dsw.values[2].value, "7");
+}
+
+TEST(DiagnosticStatusWrapper, testDiagnosticStatusLongFormats) {
+  // Formatted values and messages should not be truncated.
+  diagnostic_updater::DiagnosticStatusWrapper dsw;
+  std::string long_text(5000, 'a');
+  dsw.addf("key", "%s!", long_text.c_str());
+  EXPECT_EQ(dsw.values[0].value, long_text + "!");
+
+  dsw.summaryf(diagnostic_msgs::msg::DiagnosticStatus::WARN, "%s", long_text.c_str());
+  EXPECT_EQ(dsw.message, long_text);
+  dsw.summaryf(diagnostic_msgs::msg::DiagnosticStatus::OK, "short %d", 1);
+  EXPECT_EQ(dsw.message, "short 1");
+
+  dsw.mergeSummaryf(diagnostic_msgs::msg::DiagnosticStatus::ERROR, "%s", long_text.c_str());
+  EXPECT_EQ(dsw.level, diagnostic_msgs::msg::DiagnosticStatus::ERROR);
+  EXPECT_EQ(dsw.message, long_text);
+}
+
+TEST(DiagnosticStatusWrapper, testDiagnosticStatusStage) {
+  // Staged values should only be formatted on demand, and compared with the
+  // ones staged before the last clear.
+  diagnostic_updater::DiagnosticStatusWrapper dsw;
+  dsw.add("added", 1);
+  dsw.stage("int", -42);
+  dsw.stage("double", 3.14159265);
+  dsw.stage("duration", std::chrono::milliseconds(1500));
+  dsw.stage("text", "value");
+  dsw.stage("bool", false);
+  EXPECT_EQ(dsw.values.size(), 1u);
+  EXPECT_TRUE(dsw.stagedChanged());
+
+  dsw.formatStaged(dsw.values);
+  ASSERT_EQ(dsw.values.size(), 6u);
+  const std::vector<std::string> expected = {"1", "-42", "3.14159", "1.5", "value", "False"};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(dsw.values[i].value, expected[i]) << dsw.values[i].key;
+  }
+
+  dsw.clear();
+  EXPECT_EQ(dsw.values.size(), 0u);
+  dsw.stage("int", -42);
+  dsw.stage("double", 3.14159265);
+  dsw.stage("duration", std::chrono::milliseconds(1500));
+  dsw.stage("text", "value");
+  dsw.stage("bool", false);
+  EXPECT_FALSE(dsw.stagedChanged());
+
+  dsw.clear();
+  dsw.stage("int", -41);
+  EXPECT_TRUE(dsw.stagedChanged());
+  ASSERT_NE(dsw.getPrevious("int"), nullptr);
+  EXPECT_EQ(dsw.getPrevious("int")->signed_value, -42);
+  EXPECT_EQ(dsw.getPrevious("missing"), nullptr);
+}
+
+TEST(DiagnosticStatusWrapper, testDiagnosticStatusToMessage) {
+  // A copy as a message should only have the staged values through toMessage().
+  diagnostic_updater::DiagnosticStatusWrapper dsw;
+  dsw.summary(diagnostic_msgs::msg::DiagnosticStatus::WARN, "Staged");
+  dsw.add("added", 1);
+  dsw.stage("staged", 2.5);
+
+  diagnostic_msgs::msg::DiagnosticStatus sliced = dsw;
+  EXPECT_EQ(sliced.values.size(), 1u);
+
+  diagnostic_msgs::msg::DiagnosticStatus message = dsw.toMessage();
+  EXPECT_EQ(message.level, diagnostic_msgs::msg::DiagnosticStatus::WARN);
+  EXPECT_EQ(message.message, "Staged");
+  ASSERT_EQ(message.values.size(), 2u);
+  EXPECT_EQ(message.values[1].key, "staged");
+  EXPECT_EQ(message.values[1].value, "2.5");
+  // The wrapper itself is unchanged
+  EXPECT_EQ(dsw.values.size(), 1u);
+}
+
+TEST(DiagnosticStatusWrapper, testDiagnosticStatusAliasedArguments) {
+  // Arguments pointing into the wrapper's own message and values should be
+  // read before they are overwritten or moved.
+  diagnostic_updater::DiagnosticStatusWrapper dsw;
+  dsw.add("first", "value");
+  for (size_t i = 1; i < dsw.values.capacity(); ++i) {
+    dsw.add("filler", i);
+  }
+  dsw.addf("copy", "%s", dsw.values[0].value.c_str());
+  EXPECT_EQ(dsw.values.back().value, dsw.values[0].value);
+
+  while (dsw.values.size() < dsw.values.capacity()) {
+    dsw.add("filler", 0);
+  }
+  dsw.add(dsw.values[0].key, 1);
+  EXPECT_EQ(dsw.values.back().key, "first");
+  EXPECT_EQ(dsw.values.back().value, "1");
+
+  dsw.summary(diagnostic_msgs::msg::DiagnosticStatus::WARN, "Warning");
+  dsw.summaryf(diagnostic_msgs::msg::DiagnosticStatus::ERROR, "%s!", dsw.message.c_str());
+  EXPECT_EQ(dsw.level, diagnostic_msgs::msg::DiagnosticStatus::ERROR);
+  EXPECT_EQ(dsw.message, "Warning!");
+}
@@ -34,9 +34,16 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <future>
+#include <map>
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include "diagnostic_updater/diagnostic_status_wrapper.hpp"
 #include "diagnostic_updater/diagnostic_updater.hpp"
@@ -170,6 +177,454 @@ TEST(DiagnosticUpdater, testCustomContext) {
   context->shutdown("End test");
 }
 
+TEST(DiagnosticUpdater, testParallelTasks) {
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr, rclcpp::InitOptions());
+
+  auto node = std::make_shared<rclcpp::Node>(
+    "ParallelTasksNode", rclcpp::NodeOptions().context(context).parameter_overrides(
+      {{"diagnostic_updater.period", 100.0}, {"diagnostic_updater.threads", 2},
+        {"diagnostic_updater.deadline", 0.2}}));
+  std::vector<diagnostic_msgs::msg::DiagnosticStatus> received;
+  auto subscription = node->create_subscription<diagnostic_msgs::msg::DiagnosticArray>(
+    "/diagnostics", 10, [&received](const diagnostic_msgs::msg::DiagnosticArray::SharedPtr msg) {
+      received = msg->status;
+    });
+  rclcpp::ExecutorOptions executor_options;
+  executor_options.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(executor_options);
+  executor.add_node(node);
+  auto receive = [&]() {
+      received.clear();
+      auto end = std::chrono::steady_clock::now() + 2s;
+      while (received.size() != 2 && std::chrono::steady_clock::now() < end) {
+        executor.spin_some(100ms);
+      }
+    };
+
+  diagnostic_updater::Updater updater(node);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::atomic<int> slow_calls(0);
+  std::atomic<bool> slow_returned(false);
+  updater.add(
+    "slow",
+    [&slow_calls, &slow_returned, released](diagnostic_updater::DiagnosticStatusWrapper & s) {
+      if (slow_calls++ == 0) {
+        // Blocked past the deadline until the test releases it
+        released.wait();
+      }
+      s.summary(0, "Slow");
+      slow_returned = true;
+    });
+  updater.add(
+    "fast", [](diagnostic_updater::DiagnosticStatusWrapper & s) {
+      s.summary(0, "Fast");
+    });
+
+  // The slow task doesn't hold up the fast one, the update returns while it is blocked
+  updater.force_update();
+  receive();
+  EXPECT_FALSE(slow_returned);
+  release.set_value();
+  ASSERT_EQ(2u, received.size());
+  EXPECT_EQ(2, received[0].level);
+  EXPECT_EQ("Timed out", received[0].message);
+  EXPECT_EQ(0, received[1].level);
+  EXPECT_EQ("Fast", received[1].message);
+  EXPECT_EQ(1, slow_calls);
+
+  // The next update waits for the released task, or runs it again if it
+  // already finished
+  updater.force_update();
+  receive();
+  ASSERT_EQ(2u, received.size());
+  EXPECT_EQ(0, received[0].level);
+  EXPECT_EQ("Slow", received[0].message);
+
+  // It is no longer running after that update, so it is started again
+  int calls = slow_calls;
+  updater.force_update();
+  receive();
+  ASSERT_EQ(2u, received.size());
+  EXPECT_EQ("Slow", received[0].message);
+  EXPECT_EQ(calls + 1, slow_calls);
+
+  context->shutdown("End test");
+}
+
+TEST(DiagnosticUpdater, testTaskPeriods) {
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr, rclcpp::InitOptions());
+
+  auto node = std::make_shared<rclcpp::Node>(
+    "TaskPeriodsNode", rclcpp::NodeOptions().context(context).parameter_overrides(
+      {{"diagnostic_updater.period", 100.0}}));
+  rclcpp::ExecutorOptions executor_options;
+  executor_options.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(executor_options);
+  executor.add_node(node);
+
+  diagnostic_updater::Updater updater(node);
+  int heartbeat_calls = 0;
+  int probe_calls = 0;
+  updater.add(
+    "heartbeat", [&heartbeat_calls](diagnostic_updater::DiagnosticStatusWrapper & s) {
+      ++heartbeat_calls;
+      s.summary(0, "Alive");
+    }, 0.05);
+  updater.add(
+    "probe", [&probe_calls](diagnostic_updater::DiagnosticStatusWrapper & s) {
+      ++probe_calls;
+      s.summary(0, "Probed");
+    });
+
+  // The updater ticks at the period of the heartbeat, the probe runs once
+  auto end = std::chrono::steady_clock::now() + 500ms;
+  while (std::chrono::steady_clock::now() < end) {
+    executor.spin_some(50ms);
+  }
+  EXPECT_GE(heartbeat_calls, 4);
+  EXPECT_EQ(1, probe_calls);
+
+  updater.force_update();
+  EXPECT_EQ(2, probe_calls);
+
+  context->shutdown("End test");
+}
+
+TEST(DiagnosticUpdater, testTasksWithTheSameName) {
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr, rclcpp::InitOptions());
+
+  auto node = std::make_shared<rclcpp::Node>(
+    "SameNameNode", rclcpp::NodeOptions().context(context).parameter_overrides(
+      {{"diagnostic_updater.period", 0.05}}));
+  std::vector<diagnostic_msgs::msg::DiagnosticStatus> received;
+  auto subscription = node->create_subscription<diagnostic_msgs::msg::DiagnosticArray>(
+    "/diagnostics", 10, [&received](const diagnostic_msgs::msg::DiagnosticArray::SharedPtr msg) {
+      received = msg->status;
+    });
+  rclcpp::ExecutorOptions executor_options;
+  executor_options.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(executor_options);
+  executor.add_node(node);
+
+  // Like two FrequencyStatus tasks with the default name
+  diagnostic_updater::Updater updater(node);
+  int first_calls = 0;
+  int second_calls = 0;
+  updater.add(
+    "Frequency Status", [&first_calls](diagnostic_updater::DiagnosticStatusWrapper & s) {
+      ++first_calls;
+      s.summary(0, "First");
+    });
+  updater.add(
+    "Frequency Status", [&second_calls](diagnostic_updater::DiagnosticStatusWrapper & s) {
+      ++second_calls;
+      s.summary(0, "Second");
+    });
+
+  // Both run at every timer update
+  auto end = std::chrono::steady_clock::now() + 500ms;
+  while (std::chrono::steady_clock::now() < end) {
+    executor.spin_some(50ms);
+  }
+  EXPECT_GE(first_calls, 4);
+  EXPECT_EQ(first_calls, second_calls);
+  ASSERT_EQ(2u, received.size());
+  EXPECT_EQ("First", received[0].message);
+  EXPECT_EQ("Second", received[1].message);
+
+  // Removing the first one keeps the state of the second one
+  ASSERT_TRUE(updater.removeByName("Frequency Status"));
+  int calls = second_calls;
+  updater.force_update();
+  EXPECT_EQ(calls + 1, second_calls);
+
+  context->shutdown("End test");
+}
+
+TEST(DiagnosticUpdater, testTaskSetsItsName) {
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr, rclcpp::InitOptions());
+
+  auto node = std::make_shared<rclcpp::Node>(
+    "TaskNameNode", rclcpp::NodeOptions().context(context).parameter_overrides(
+      {{"diagnostic_updater.period", 100.0}}));
+  std::vector<diagnostic_msgs::msg::DiagnosticStatus> received;
+  auto subscription = node->create_subscription<diagnostic_msgs::msg::DiagnosticArray>(
+    "/diagnostics", 10, [&received](const diagnostic_msgs::msg::DiagnosticArray::SharedPtr msg) {
+      received = msg->status;
+    });
+  rclcpp::ExecutorOptions executor_options;
+  executor_options.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(executor_options);
+  executor.add_node(node);
+
+  diagnostic_updater::Updater updater(node);
+  updater.add(
+    "task", [](diagnostic_updater::DiagnosticStatusWrapper & s) {
+      s.name = "Renamed";
+      s.summary(0, "OK");
+    });
+  updater.add(
+    "other", [](diagnostic_updater::DiagnosticStatusWrapper & s) {
+      s.summary(0, "OK");
+    });
+
+  // The name set by the task is prefixed like the task names
+  for (int i = 0; i < 2; ++i) {
+    received.clear();
+    updater.force_update();
+    auto end = std::chrono::steady_clock::now() + 2s;
+    while (received.size() != 2 && std::chrono::steady_clock::now() < end) {
+      executor.spin_some(100ms);
+    }
+    ASSERT_EQ(2u, received.size());
+    EXPECT_EQ("TaskNameNode: Renamed", received[0].name);
+    EXPECT_EQ("TaskNameNode: other", received[1].name);
+  }
+
+  context->shutdown("End test");
+}
+
+TEST(DiagnosticUpdater, testAsyncTasks) {
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr, rclcpp::InitOptions());
+
+  auto node = std::make_shared<rclcpp::Node>(
+    "AsyncTasksNode", rclcpp::NodeOptions().context(context).parameter_overrides(
+      {{"diagnostic_updater.period", 100.0}}));
+  std::vector<diagnostic_msgs::msg::DiagnosticStatus> received;
+  auto subscription = node->create_subscription<diagnostic_msgs::msg::DiagnosticArray>(
+    "/diagnostics", 10, [&received](const diagnostic_msgs::msg::DiagnosticArray::SharedPtr msg) {
+      received = msg->status;
+    });
+  rclcpp::ExecutorOptions executor_options;
+  executor_options.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(executor_options);
+  executor.add_node(node);
+  auto receive = [&](size_t count) {
+      received.clear();
+      auto end = std::chrono::steady_clock::now() + 2s;
+      while (received.size() != count && std::chrono::steady_clock::now() < end) {
+        executor.spin_some(100ms);
+      }
+    };
+
+  diagnostic_updater::Updater updater(node);
+  std::promise<diagnostic_msgs::msg::DiagnosticStatus> reading;
+  int starts = 0;
+  updater.addAsync(
+    "async", [&reading, &starts]() {
+      ++starts;
+      reading = std::promise<diagnostic_msgs::msg::DiagnosticStatus>();
+      return reading.get_future();
+    });
+  updater.add(
+    "fast", [](diagnostic_updater::DiagnosticStatusWrapper & s) {
+      s.summary(0, "Fast");
+    });
+
+  // A task that was just started has nothing to report yet
+  updater.force_update();
+  receive(1);
+  ASSERT_EQ(1u, received.size());
+  EXPECT_EQ("Fast", received[0].message);
+
+  // Nor is it waited for
+  updater.force_update();
+  receive(2);
+  ASSERT_EQ(2u, received.size());
+  EXPECT_EQ(2, received[0].level);
+  EXPECT_EQ("Not finished", received[0].message);
+  EXPECT_EQ(1, starts);
+
+  // Its result is collected by the next update, which starts it again
+  diagnostic_msgs::msg::DiagnosticStatus status;
+  status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+  status.message = "Done";
+  reading.set_value(status);
+  updater.force_update();
+  receive(2);
+  ASSERT_EQ(2u, received.size());
+  EXPECT_EQ(0, received[0].level);
+  EXPECT_EQ("Done", received[0].message);
+  EXPECT_EQ("async", received[0].name);
+  EXPECT_EQ(2, starts);
+
+  updater.force_update();
+  receive(2);
+  ASSERT_EQ(2u, received.size());
+  EXPECT_EQ(1, received[0].level);
+  EXPECT_EQ("Not finished, last result: Done", received[0].message);
+
+  // A failed task reports its exception
+  reading.set_exception(std::make_exception_ptr(std::runtime_error("No device")));
+  updater.force_update();
+  receive(2);
+  ASSERT_EQ(2u, received.size());
+  EXPECT_EQ(2, received[0].level);
+  EXPECT_EQ("Failed: No device", received[0].message);
+
+  // A wrapper completing the future keeps its staged values
+  diagnostic_updater::DiagnosticStatusWrapper wrapper;
+  wrapper.summary(diagnostic_msgs::msg::DiagnosticStatus::OK, "Staged");
+  wrapper.stage("Temperature", 42.5);
+  reading.set_value(wrapper.toMessage());
+  updater.force_update();
+  receive(2);
+  ASSERT_EQ(2u, received.size());
+  EXPECT_EQ("Staged", received[0].message);
+  ASSERT_EQ(1u, received[0].values.size());
+  EXPECT_EQ("Temperature", received[0].values[0].key);
+  EXPECT_EQ("42.5", received[0].values[0].value);
+
+  context->shutdown("End test");
+}
+
+TEST(DiagnosticUpdater, testPublishOnChange) {
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr, rclcpp::InitOptions());
+
+  auto node = std::make_shared<rclcpp::Node>(
+    "PublishOnChangeNode", rclcpp::NodeOptions().context(context).parameter_overrides(
+      {{"diagnostic_updater.period", 100.0}, {"diagnostic_updater.publish_on_change", true},
+        {"diagnostic_updater.full_refresh", 3}}));
+  std::vector<std::vector<diagnostic_msgs::msg::DiagnosticStatus>> received;
+  auto subscription = node->create_subscription<diagnostic_msgs::msg::DiagnosticArray>(
+    "/diagnostics", 100,
+    [&received](const diagnostic_msgs::msg::DiagnosticArray::SharedPtr msg) {
+      received.push_back(msg->status);
+    });
+  rclcpp::ExecutorOptions executor_options;
+  executor_options.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(executor_options);
+  executor.add_node(node);
+  auto receive = [&](std::chrono::nanoseconds duration) {
+      received.clear();
+      auto end = std::chrono::steady_clock::now() + duration;
+      while (std::chrono::steady_clock::now() < end) {
+        executor.spin_some(10ms);
+      }
+    };
+
+  diagnostic_updater::Updater updater(node);
+  int count = 0;
+  updater.add(
+    "steady", [](diagnostic_updater::DiagnosticStatusWrapper & s) {
+      s.summary(0, "Steady");
+    });
+  updater.add(
+    "counter", [&count](diagnostic_updater::DiagnosticStatusWrapper & s) {
+      s.summary(0, "Counting");
+      s.add("Count", ++count);
+    });
+
+  // A forced update is a full refresh
+  updater.force_update();
+  receive(200ms);
+  ASSERT_EQ(1u, received.size());
+  ASSERT_EQ(3u, received[0].size());
+  EXPECT_EQ("PublishOnChangeNode: Publish on change", received[0][2].name);
+  EXPECT_EQ(0u, updater.getSuppressedCount());
+
+  // The periodic updates leave out the unchanged status, every third period
+  // publishes everything, with the suppressed count
+  updater.setPeriod(0.1);
+  receive(1s);
+  size_t refreshes = 0;
+  for (const auto & statuses : received) {
+    if (statuses.size() == 3u) {
+      ++refreshes;
+      EXPECT_EQ("PublishOnChangeNode: steady", statuses[0].name);
+      EXPECT_EQ("PublishOnChangeNode: Publish on change", statuses[2].name);
+    } else {
+      ASSERT_EQ(1u, statuses.size());
+      EXPECT_EQ("PublishOnChangeNode: counter", statuses[0].name);
+    }
+  }
+  EXPECT_GE(refreshes, 2u);
+  EXPECT_GE(updater.getSuppressedCount(), 5u);
+
+  // Forced updates publish the unchanged status again
+  updater.setPeriod(100.0);
+  receive(200ms);
+  uint64_t suppressed = updater.getSuppressedCount();
+  updater.force_update();
+  receive(200ms);
+  ASSERT_EQ(1u, received.size());
+  ASSERT_EQ(3u, received[0].size());
+  EXPECT_EQ("PublishOnChangeNode: steady", received[0][0].name);
+  EXPECT_EQ(suppressed, updater.getSuppressedCount());
+
+  context->shutdown("End test");
+}
+
+TEST(DiagnosticUpdater, testStagedValues) {
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr, rclcpp::InitOptions());
+
+  auto node = std::make_shared<rclcpp::Node>(
+    "StagedValuesNode", rclcpp::NodeOptions().context(context).parameter_overrides(
+      {{"diagnostic_updater.period", 100.0}, {"diagnostic_updater.publish_on_change", true}}));
+  std::vector<std::vector<diagnostic_msgs::msg::DiagnosticStatus>> received;
+  auto subscription = node->create_subscription<diagnostic_msgs::msg::DiagnosticArray>(
+    "/diagnostics", 100,
+    [&received](const diagnostic_msgs::msg::DiagnosticArray::SharedPtr msg) {
+      received.push_back(msg->status);
+    });
+  rclcpp::ExecutorOptions executor_options;
+  executor_options.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(executor_options);
+  executor.add_node(node);
+  auto receive = [&]() {
+      received.clear();
+      auto end = std::chrono::steady_clock::now() + 200ms;
+      while (std::chrono::steady_clock::now() < end) {
+        executor.spin_some(10ms);
+      }
+    };
+
+  diagnostic_updater::Updater updater(node);
+  double voltage = 12.0;
+  bool was_changed = false;
+  updater.add(
+    "battery", [&](diagnostic_updater::DiagnosticStatusWrapper & s) {
+      s.summary(0, "OK");
+      s.add("Cells", 4);
+      s.stage("Voltage", voltage);
+      const auto * previous = s.getPrevious("Voltage");
+      was_changed = previous && previous->real_value != voltage;
+    });
+
+  // Staged values are published after the added ones
+  updater.force_update();
+  receive();
+  ASSERT_EQ(1u, received.size());
+  ASSERT_EQ(2u, received[0][0].values.size());
+  EXPECT_EQ("Cells", received[0][0].values[0].key);
+  EXPECT_EQ("Voltage", received[0][0].values[1].key);
+  EXPECT_EQ("12", received[0][0].values[1].value);
+
+  // Unchanged staged values leave the status out
+  updater.force_update();
+  receive();
+  EXPECT_EQ(0u, received.size());
+  EXPECT_FALSE(was_changed);
+  EXPECT_EQ(1u, updater.getSuppressedCount());
+
+  voltage = 11.5;
+  updater.force_update();
+  receive();
+  ASSERT_EQ(1u, received.size());
+  EXPECT_EQ("11.5", received[0][0].values[1].value);
+  EXPECT_TRUE(was_changed);
+
+  context->shutdown("End test");
+}
+
 TEST(DiagnosticUpdater, testDiagnosticStatusWrapperKeyValuePairs) {
   diagnostic_updater::DiagnosticStatusWrapper stat;
 
@@ -282,6 +737,99 @@ TEST(DiagnosticUpdater, testFrequencyStatus) {
     "Name should be \"Frequency Status\"";
 }
 
+TEST(DiagnosticUpdater, testFrequencyStatusConcurrentTicks) {
+  double minFreq = 10;
+  double maxFreq = 20;
+
+  diagnostic_updater::FrequencyStatus fs(
+    diagnostic_updater::FrequencyStatusParam(&minFreq, &maxFreq, 0.5, 2));
+
+  // Ticks from several publishing threads are all counted
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back(
+      [&fs]() {
+        for (int j = 0; j < 10000; ++j) {
+          fs.tick();
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  diagnostic_updater::DiagnosticStatusWrapper stat;
+  fs.run(stat);
+  ASSERT_LE(2u, stat.values.size());
+  EXPECT_EQ("Events in window", stat.values[0].key);
+  EXPECT_EQ("40000", stat.values[0].value);
+  EXPECT_EQ("Events since startup", stat.values[1].key);
+  EXPECT_EQ("40000", stat.values[1].value);
+}
+
+TEST(DiagnosticUpdater, testDurationHistogram) {
+  diagnostic_updater::DurationHistogram histogram;
+  for (int i = 0; i < 990; ++i) {
+    histogram.record(1000000);
+  }
+  for (int i = 0; i < 10; ++i) {
+    histogram.record(5000000);
+  }
+  histogram.record(20000000);
+
+  // Values are known within 1/16
+  auto statistics = histogram.takeStatistics();
+  EXPECT_EQ(1001u, statistics.count);
+  EXPECT_NEAR(0.001, statistics.p50, 0.001 / 16);
+  EXPECT_NEAR(0.001, statistics.p90, 0.001 / 16);
+  EXPECT_NEAR(0.005, statistics.p99, 0.005 / 16);
+  EXPECT_DOUBLE_EQ(0.02, statistics.max);
+  EXPECT_NEAR(0.00106, statistics.mean, 0.00106 / 16);
+  EXPECT_GT(statistics.stddev, 0.0);
+
+  // Taking the statistics resets the histogram
+  EXPECT_EQ(0u, histogram.takeStatistics().count);
+
+  // Every duration has a bucket
+  EXPECT_EQ(0u, diagnostic_updater::DurationHistogram::bucketOf(0));
+  EXPECT_EQ(
+    diagnostic_updater::DurationHistogram::kBuckets - 1,
+    diagnostic_updater::DurationHistogram::bucketOf(UINT64_MAX));
+}
+
+TEST(DiagnosticUpdater, testFrequencyStatusGaps) {
+  double minFreq = 10;
+  double maxFreq = 200;
+  diagnostic_updater::FrequencyStatusParam params(&minFreq, &maxFreq, 0.5, 2);
+  params.gap_statistics_ = true;
+  params.max_gap_warn_ = 0.05;
+  params.max_gap_error_ = 1.0;
+  diagnostic_updater::FrequencyStatus fs(params);
+
+  for (int i = 0; i < 5; ++i) {
+    fs.tick();
+    std::this_thread::sleep_for(10ms);
+  }
+  std::this_thread::sleep_for(60ms);
+  fs.tick();
+
+  diagnostic_updater::DiagnosticStatusWrapper stat;
+  fs.run(stat);
+  EXPECT_EQ(1, stat.level) << stat.message;
+  EXPECT_NE(std::string::npos, stat.message.find("Gap too long."));
+  std::map<std::string, double> gaps;
+  for (const auto & value : stat.values) {
+    if (value.key.compare(0, 4, "Gap ") == 0) {
+      gaps[value.key] = std::stod(value.value);
+    }
+  }
+  ASSERT_EQ(4u, gaps.size());
+  EXPECT_GE(gaps["Gap max (s)"], 0.07);
+  EXPECT_GE(gaps["Gap p99 (s)"], gaps["Gap p50 (s)"]);
+  EXPECT_GE(gaps["Gap p50 (s)"], 0.01 * 15 / 16);
+  EXPECT_GT(gaps["Gap standard deviation (s)"], 0.0);
+}
+
 TEST(DiagnosticUpdater, testTimeStampStatus) {
   diagnostic_updater::TimeStampStatus ts(
     diagnostic_updater::DefaultTimeStampStatusParam);
@@ -307,3 +855,45 @@ TEST(DiagnosticUpdater, testTimeStampStatus) {
   EXPECT_STREQ("Timestamp Status", ts.getName().c_str()) <<
     "Name should be \"Timestamp Status\"";
 }
+
+TEST(DiagnosticUpdater, testTimeStampStatusLatencies) {
+  diagnostic_updater::TimeStampStatusParam params;
+  params.latency_statistics_ = true;
+  params.max_latency_p50_ = 0.5;
+  params.max_latency_p99_ = 0.5;
+  diagnostic_updater::TimeStampStatus ts(params);
+
+  // Delays of 10ms to 1s, passing the current time
+  rclcpp::Time now = rclcpp::Clock().now();
+  for (int i = 1; i <= 100; ++i) {
+    ts.tick(now - rclcpp::Duration::from_nanoseconds(i * 10000000LL), now);
+  }
+  ts.tick(now.seconds() + 0.5, now.seconds());
+
+  diagnostic_updater::DiagnosticStatusWrapper stat;
+  ts.run(stat);
+  EXPECT_EQ(1, stat.level) << stat.message;
+  EXPECT_NE(std::string::npos, stat.message.find("Latency p99 too high."));
+  EXPECT_EQ(std::string::npos, stat.message.find("Latency p50 too high."));
+  std::map<std::string, double> latencies;
+  for (const auto & value : stat.values) {
+    if (value.key.compare(0, 8, "Latency ") == 0) {
+      latencies[value.key] = std::stod(value.value);
+    }
+  }
+  ASSERT_EQ(4u, latencies.size());
+  EXPECT_NEAR(0.5, latencies["Latency p50 (s)"], 0.5 / 16);
+  EXPECT_NEAR(0.9, latencies["Latency p90 (s)"], 0.9 / 16);
+  EXPECT_NEAR(0.99, latencies["Latency p99 (s)"], 0.99 / 16);
+  EXPECT_DOUBLE_EQ(1.0, latencies["Latency max (s)"]);
+
+  // The stamp in the future counts as the earliest delay
+  for (const auto & value : stat.values) {
+    if (value.key == "Earliest timestamp delay:") {
+      EXPECT_NEAR(-0.5, std::stod(value.value), 1e-6);
+    }
+  }
+
+  ts.run(stat);
+  EXPECT_EQ(1, stat.level) << "no data should return a warning";
+}
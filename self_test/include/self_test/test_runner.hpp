@@ -109,6 +109,7 @@ public:
             try {
               RCLCPP_INFO(logger_, "Starting test: %s", iter->getName().c_str());
               iter->run(status);
+              status.formatStaged(status.values);
             } catch (std::exception & e) {
               status.level = 2;
               status.message = std::string("Uncaught exception: ") + e.what();